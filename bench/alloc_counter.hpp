@@ -0,0 +1,33 @@
+#pragma once
+// Подсчёт выделений памяти в бенчмарке: заменяет глобальные operator new/delete,
+// поэтому подключается ровно в одну единицу трансляции исполняемого файла
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace bench {
+
+inline std::atomic<std::size_t> allocations{0};
+inline std::atomic<std::size_t> allocated_bytes{0};
+
+} // namespace bench
+
+void* operator new(std::size_t size) {
+    bench::allocations.fetch_add(1, std::memory_order_relaxed);
+    bench::allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+// new выше выделяет через malloc, пары совпадают. GCC после встраивания видит free рядом с вызовом
+// operator new и ложно сообщает о несовпадении (-Wmismatched-new-delete)
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
@@ -0,0 +1,330 @@
+// Обход AST: дерево указателей (виртуальный посетитель ASTVisitor и StaticVisitor с выбором класса
+// по виду узла) против плоской формы (FlatAST).
+// Использование: bench_ast [--size MB] [--rounds R] [--file путь]
+// Каждый обход считает узлы и идентификаторы и суммирует целые литералы; dynamic_cast и node_cast -
+// проверка класса каждого узла (IdExpr, BinaryExpr с наследниками) через RTTI и по виду узла.
+// Плоская форма, которую парсер пишет сам (Parser::parse_flat), должна совпасть с записью
+// дерева указателей (FlatAST(root)) по структуре, операторам, литералам, именам и типам.
+// Вывод - CSV, по строке на способ обхода и на разбор: лучшее время из R прогонов, нс на узел,
+// байты представления
+#include "corpus.hpp"
+#include "flat_ast.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "perf_stats.hpp"
+#include "source_buffer.hpp"
+#include "visitor.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Totals {
+    std::size_t nodes = 0;
+    std::size_t ids = 0;
+    long long sum = 0;
+
+    bool operator==(const Totals& other) const { return nodes == other.nodes && ids == other.ids && sum == other.sum; }
+};
+
+void add_literal(Totals& totals, const LiteralExpr::Value& value) {
+    if (auto number = std::get_if<int>(&value)) totals.sum += *number;
+}
+
+// Полный обход дерева указателей
+struct CountingVisitor : ASTVisitor {
+    Totals totals;
+
+    void walk(ASTNode* node) {
+        if (node) node->accept(*this);
+    }
+    template <typename List>
+    void walk_all(const List& nodes) {
+        for (auto node : nodes) walk(node);
+    }
+
+    void visit(LiteralExpr& expr) override { ++totals.nodes; add_literal(totals, expr.value()); }
+    void visit(IdExpr&) override { ++totals.nodes; ++totals.ids; }
+    void visit(BinaryExpr& expr) override { ++totals.nodes; walk(expr.left); walk(expr.right); }
+    void visit(UnaryExpr& expr) override { ++totals.nodes; walk(expr.operand); }
+    void visit(SizeofExpr& expr) override {
+        ++totals.nodes;
+        walk(expr.operand);
+        if (auto type = std::get_if<ExprPtr>(&expr.type)) walk(*type);
+    }
+    void visit(TernaryExpr& expr) override { ++totals.nodes; walk(expr.cond); walk(expr.true_expr); walk(expr.false_expr); }
+    void visit(CallExpr& expr) override { ++totals.nodes; walk(expr.callee); walk_all(expr.args); }
+    void visit(MemberAccessExpr& expr) override { ++totals.nodes; walk(expr.object); walk(expr.member); }
+    void visit(ArrayAccessExpr& expr) override { ++totals.nodes; walk(expr.array); walk(expr.index); }
+    void visit(LogicalExpr& expr) override { ++totals.nodes; walk(expr.left); walk(expr.right); }
+    void visit(PostfixExpr& expr) override { ++totals.nodes; walk(expr.operand); }
+    void visit(AssignExpr& expr) override { ++totals.nodes; walk(expr.left); walk(expr.right); }
+    void visit(ArrayInitExpr& expr) override { ++totals.nodes; walk_all(expr.elements); }
+    void visit(CastExpr& expr) override { ++totals.nodes; walk(expr.operand); }
+
+    void visit(ExprStmt& stmt) override { ++totals.nodes; walk(stmt.expr); }
+    void visit(BlockStmt& stmt) override { ++totals.nodes; walk_all(stmt.statements); }
+    void visit(IfStmt& stmt) override { ++totals.nodes; walk(stmt.condition); walk(stmt.then_branch); walk(stmt.else_branch); }
+    void visit(WhileStmt& stmt) override { ++totals.nodes; walk(stmt.condition); walk(stmt.body); }
+    void visit(ForStmt& stmt) override {
+        ++totals.nodes;
+        walk(stmt.init);
+        walk(stmt.condition);
+        walk(stmt.increment);
+        walk(stmt.body);
+    }
+    void visit(ReturnStmt& stmt) override { ++totals.nodes; walk(stmt.expr); }
+    void visit(BreakStmt&) override { ++totals.nodes; }
+    void visit(ContinueStmt&) override { ++totals.nodes; }
+    void visit(PrintStmt& stmt) override { ++totals.nodes; walk_all(stmt.expr); }
+    void visit(ReadStmt& stmt) override { ++totals.nodes; walk(stmt.expr); }
+    void visit(ExitStmt& stmt) override { ++totals.nodes; walk(stmt.expr); }
+
+    void visit(VarDecl& decl) override {
+        ++totals.nodes;
+        for (auto& variable : decl.variables) {
+            walk(variable.init);
+            walk(variable.size);
+        }
+    }
+    void visit(StructDecl& decl) override {
+        ++totals.nodes;
+        for (auto& field : decl.fields) visit(field);
+    }
+    void visit(FunctionDecl& decl) override { ++totals.nodes; walk(decl.get_body()); }
+    void visit(AssertDecl& decl) override { ++totals.nodes; walk(decl.expr); }
+    void visit(TypedefDecl&) override { ++totals.nodes; }
+
+    void visit(TranslationUnitNode& node) override { walk_all(node.decls); }
+};
+
+// Тот же обход без виртуальных вызовов: класс узла выбирается switch по виду, visit встраиваются
+struct StaticCountingVisitor : StaticVisitor<StaticCountingVisitor> {
+    Totals totals;
+
+    template <typename Node>
+    void visit(Node& node) { ++totals.nodes; walk_children(node); }
+    void visit(LiteralExpr& expr) { ++totals.nodes; add_literal(totals, expr.value()); }
+    void visit(IdExpr&) { ++totals.nodes; ++totals.ids; }
+    void visit(TranslationUnitNode& node) { walk_children(node); }
+};
+
+// Все узлы дерева указателей - для сравнения проверок класса
+struct NodeCollector : StaticVisitor<NodeCollector> {
+    std::vector<ASTNode*> nodes;
+
+    template <typename Node>
+    void visit(Node& node) {
+        nodes.push_back(&node);
+        walk_children(node);
+    }
+};
+
+// Идентификаторы и бинарные выражения с наследниками: RTTI против вида узла
+template <typename Cast>
+Totals count_casts(const std::vector<ASTNode*>& nodes, Cast cast) {
+    Totals totals;
+    for (auto node : nodes) {
+        if (cast.template to<IdExpr>(node)) ++totals.ids;
+        if (cast.template to<BinaryExpr>(node)) ++totals.sum;
+    }
+    totals.nodes = nodes.size();
+    return totals;
+}
+
+struct RttiCast {
+    template <typename T>
+    T* to(ASTNode* node) const { return dynamic_cast<T*>(node); }
+};
+
+struct KindCast {
+    template <typename T>
+    T* to(ASTNode* node) const { return node_cast<T>(node); }
+};
+
+// Узлы плоской формы, соответствующие узлам дерева указателей
+bool is_tree_node(NodeKind kind) {
+    return kind != NodeKind::None && kind != NodeKind::Variable && kind != NodeKind::ArrayVariable &&
+           kind != NodeKind::TranslationUnit;
+}
+
+void count_flat(const FlatAST& flat, std::uint32_t i, Totals& totals) {
+    NodeKind kind = flat.kind(i);
+    if (is_tree_node(kind)) ++totals.nodes;
+    if (kind == NodeKind::Id) ++totals.ids;
+    else if (kind == NodeKind::Literal) add_literal(totals, flat.literal(i));
+    for (std::uint32_t c = flat.first_child(i); c < flat.end(i); c = flat.next_sibling(c)) count_flat(flat, c, totals);
+}
+
+// FlatAST::accept: виды узлов и виртуальный вызов на узел, как у ASTVisitor
+struct FlatCountingVisitor : FlatVisitor {
+    Totals totals;
+
+    void visit(FlatNode node) override {
+        NodeKind kind = node.kind();
+        if (is_tree_node(kind)) ++totals.nodes;
+        if (kind == NodeKind::Id) ++totals.ids;
+        else if (kind == NodeKind::Literal) add_literal(totals, node.literal());
+        for (FlatNode child : node.children()) visit(child);
+    }
+};
+
+// Индексы в боковых таблицах зависят от порядка записи, поэтому сравниваются значения
+bool same_flat(const FlatAST& a, const FlatAST& b) {
+    if (a.size() != b.size()) return false;
+    auto type_name = [](const TypePtr& type) { return type ? type->get_name() : std::string(); };
+    for (std::uint32_t i = 0; i < a.size(); ++i) {
+        NodeKind kind = a.kind(i);
+        if (kind != b.kind(i) || a.end(i) != b.end(i)) return false;
+        switch (kind) {
+            case NodeKind::Literal:
+                if (a.literal(i) != b.literal(i)) return false;
+                break;
+            case NodeKind::Binary: case NodeKind::Logical: case NodeKind::Assign:
+            case NodeKind::Unary: case NodeKind::Postfix:
+                if (a.op(i) != b.op(i)) return false;
+                break;
+            case NodeKind::Id: case NodeKind::Variable: case NodeKind::ArrayVariable: case NodeKind::StructDecl:
+                if (a.data(i) != b.data(i)) return false;
+                break;
+            case NodeKind::Sizeof:
+                if ((a.data(i) == FlatAST::no_data) != (b.data(i) == FlatAST::no_data)) return false;
+                if (a.data(i) != FlatAST::no_data && type_name(a.type(i)) != type_name(b.type(i))) return false;
+                break;
+            case NodeKind::Cast:
+                if (type_name(a.type(i)) != type_name(b.type(i))) return false;
+                break;
+            case NodeKind::VarDecl:
+                if (type_name(a.var_type(i).type) != type_name(b.var_type(i).type) ||
+                    a.var_type(i).modifiers.get_str() != b.var_type(i).modifiers.get_str()) return false;
+                break;
+            case NodeKind::FunctionDecl:
+                if (a.function(i).name != b.function(i).name || a.function(i).params.size() != b.function(i).params.size())
+                    return false;
+                break;
+            case NodeKind::TypedefDecl:
+                if (a.typedef_info(i).alias != b.typedef_info(i).alias) return false;
+                break;
+            default: break;
+        }
+    }
+    return true;
+}
+
+// Проход по массивам подряд, без обхода структуры
+Totals count_flat_linear(const FlatAST& flat) {
+    Totals totals;
+    for (std::uint32_t i = 0; i < flat.size(); ++i) {
+        NodeKind kind = flat.kind(i);
+        if (is_tree_node(kind)) ++totals.nodes;
+        if (kind == NodeKind::Id) ++totals.ids;
+        else if (kind == NodeKind::Literal) add_literal(totals, flat.literal(i));
+    }
+    return totals;
+}
+
+double best_of(int rounds, const std::function<void()>& run) {
+    double best = 0;
+    for (int r = 0; r < rounds; ++r) {
+        Stopwatch timer;
+        run();
+        double ms = timer.elapsed_ms();
+        if (r == 0 || ms < best) best = ms;
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        std::size_t size_mb = 16;
+        int rounds = 5;
+        std::string path;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--size" && i + 1 < argc) size_mb = std::stoul(argv[++i]);
+            else if (arg == "--rounds" && i + 1 < argc) rounds = std::max(1, std::stoi(argv[++i]));
+            else if (arg == "--file" && i + 1 < argc) path = argv[++i];
+            else throw std::runtime_error("Unknown option: " + arg);
+        }
+
+        std::string text;
+        SourceBuffer file;
+        if (!path.empty()) file = SourceBuffer::open(path);
+        else text = bench::generate_program(size_mb << 20);
+        std::string_view source = path.empty() ? std::string_view(text) : file.view();
+        TokenBuffer tokens = Lexer(source).tokenize();
+
+        std::shared_ptr<TranslationUnitNode> root;
+        FlatAST flat;
+        double tree_parse_ms = best_of(rounds, [&] {
+            Parser parser(tokens);
+            parser.parse();
+            root = std::static_pointer_cast<TranslationUnitNode>(parser.getAST());
+        });
+        double flat_parse_ms = best_of(rounds, [&] { flat = Parser(tokens).parse_flat(); });
+        bool parsed_identical = same_flat(flat, FlatAST(*root));
+
+        Totals tree_totals;
+        Totals static_totals;
+        Totals recursive_totals;
+        Totals linear_totals;
+        Totals visitor_totals;
+        double tree_ms = best_of(rounds, [&] {
+            CountingVisitor visitor;
+            root->accept(visitor);
+            tree_totals = visitor.totals;
+        });
+        double static_ms = best_of(rounds, [&] {
+            StaticCountingVisitor visitor;
+            visitor.walk(root.get());
+            static_totals = visitor.totals;
+        });
+        double recursive_ms = best_of(rounds, [&] {
+            recursive_totals = Totals();
+            count_flat(flat, 0, recursive_totals);
+        });
+        double linear_ms = best_of(rounds, [&] { linear_totals = count_flat_linear(flat); });
+        double flat_visitor_ms = best_of(rounds, [&] {
+            FlatCountingVisitor visitor;
+            flat.accept(visitor);
+            visitor_totals = visitor.totals;
+        });
+        bool identical = tree_totals == static_totals && tree_totals == recursive_totals &&
+                         tree_totals == linear_totals && tree_totals == visitor_totals;
+
+        NodeCollector collector;
+        collector.walk(root.get());
+        Totals rtti_totals;
+        Totals kind_totals;
+        double rtti_ms = best_of(rounds, [&] { rtti_totals = count_casts(collector.nodes, RttiCast()); });
+        double kind_ms = best_of(rounds, [&] { kind_totals = count_casts(collector.nodes, KindCast()); });
+        bool casts_identical = rtti_totals == kind_totals;
+
+        std::size_t nodes = tree_totals.nodes;
+        auto row = [&](const char* name, double ms, std::size_t bytes, bool same) {
+            std::printf("%s,%zu,%.3f,%.2f,%zu,%s\n", name, nodes, ms, nodes ? ms * 1e6 / nodes : 0.0, bytes,
+                        same ? "yes" : "no");
+        };
+        std::printf("traversal,nodes,best_ms,ns_per_node,bytes,identical\n");
+        row("pointer_visitor", tree_ms, root->arena.bytes_used(), identical);
+        row("pointer_static_visitor", static_ms, root->arena.bytes_used(), identical);
+        row("flat_recursive", recursive_ms, flat.bytes(), identical);
+        row("flat_linear", linear_ms, flat.bytes(), identical);
+        row("flat_visitor", flat_visitor_ms, flat.bytes(), identical);
+        row("pointer_parse", tree_parse_ms, root->arena.bytes_used(), parsed_identical);
+        row("flat_parse", flat_parse_ms, flat.bytes(), parsed_identical);
+        row("dynamic_cast", rtti_ms, 0, casts_identical);
+        row("node_cast", kind_ms, 0, casts_identical);
+        return identical && casts_identical && parsed_identical ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+    }
+    return 1;
+}
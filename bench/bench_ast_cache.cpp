@@ -0,0 +1,137 @@
+// Кэш AST: загрузка готового дерева против лексирования и разбора, проверка формата.
+// Использование: bench_ast_cache [--size MB] [--rounds R] [--corruptions N] [--file путь]
+// Две строки: parsed - дерево после разбора (generate_program), analyzed - после семантического
+// анализа (generate_checked_program; его время входит в lex_parse_ms) с типами выражений и Cast.
+// Круговая проверка: decode(encode(AST)) кодируется в те же байты и совпадает по узлам и типам.
+// Повреждения: N файлов с одним изменённым байтом и N обрезанных должны отвергаться;
+// ещё N с изменённым байтом и пересчитанной контрольной суммой ("подделки") либо отвергаются
+// проверкой структуры, либо дают дерево, которое разворачивается без ошибок памяти.
+// Вывод - CSV
+#include "ast_cache.hpp"
+#include "corpus.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "perf_stats.hpp"
+#include "semantic_analyzer.hpp"
+#include "source_buffer.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+template <typename F>
+double best_ms(int rounds, F&& body) {
+    double best = 0;
+    for (int r = 0; r < rounds; ++r) {
+        Stopwatch timer;
+        body();
+        double ms = timer.elapsed_ms();
+        if (r == 0 || ms < best) best = ms;
+    }
+    return best;
+}
+
+bool same_nodes(const FlatAST& a, const FlatAST& b) {
+    if (a.size() != b.size()) return false;
+    for (std::uint32_t i = 0; i < a.size(); ++i) {
+        if (a.kind(i) != b.kind(i) || a.end(i) != b.end(i) || a.data(i) != b.data(i)) return false;
+        if (a.kind(i) == NodeKind::Literal && a.literal(i) != b.literal(i)) return false;
+        TypePtr x = a.expr_type(i);
+        TypePtr y = b.expr_type(i);
+        if ((x ? x->id() : 0) != (y ? y->id() : 0)) return false;
+    }
+    return a.analyzed() == b.analyzed();
+}
+
+bool rejected(const std::string& file, std::string_view source) {
+    try {
+        AstCache::decode(file, source).expand();
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+// Одна строка CSV: время, круговая проверка и повреждения файла для дерева source
+bool run(std::string_view source, bool analyze, int rounds, std::size_t corruptions) {
+    FlatAST flat;
+    double front_ms = best_ms(rounds, [&] {
+        TokenBuffer tokens = Lexer(source).tokenize();
+        flat = Parser(tokens).parse_flat();
+        if (analyze) {
+            auto root = flat.expand();
+            SemanticAnalyzer().analyze(root);
+            flat = FlatAST(*root);
+        }
+    });
+    std::string encoded;
+    double encode_ms = best_ms(rounds, [&] { encoded = AstCache::encode(flat, source); });
+    FlatAST loaded;
+    double load_ms = best_ms(rounds, [&] { loaded = AstCache::decode(encoded, source); });
+    bool identical = flat.analyzed() == analyze && same_nodes(flat, loaded) && AstCache::encode(loaded, source) == encoded;
+
+    // Равномерно по файлу, включая заголовок
+    std::size_t flips_rejected = 0;
+    std::size_t cuts_rejected = 0;
+    std::size_t forged_rejected = 0;
+    for (std::size_t k = 0; k < corruptions; ++k) {
+        std::size_t at = encoded.size() * k / corruptions;
+        std::string damaged = encoded;
+        damaged[at] = static_cast<char>(damaged[at] ^ (1 << k % 8));
+        flips_rejected += rejected(damaged, source);
+        cuts_rejected += rejected(encoded.substr(0, at), source);
+
+        std::size_t payload_at = AstCache::header_size + (encoded.size() - AstCache::header_size) * k / corruptions;
+        std::string forged = encoded;
+        forged[payload_at] = static_cast<char>(forged[payload_at] ^ (1 << k % 8));
+        std::uint64_t checksum = AstCache::hash(std::string_view(forged).substr(AstCache::header_size));
+        std::memcpy(&forged[AstCache::header_size - sizeof(checksum)], &checksum, sizeof(checksum));
+        forged_rejected += rejected(forged, source);
+    }
+    bool robust = flips_rejected == corruptions && cuts_rejected == corruptions;
+
+    std::printf("%s,%zu,%zu,%zu,%.3f,%.3f,%.3f,%.2f,%d,%zu,%zu,%zu,%zu\n", analyze ? "analyzed" : "parsed",
+                source.size(), flat.size(), encoded.size(), front_ms, encode_ms, load_ms, front_ms / load_ms,
+                identical ? 1 : 0, flips_rejected, cuts_rejected, forged_rejected, corruptions);
+    return identical && robust;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        std::size_t size_mb = 16;
+        int rounds = 3;
+        std::size_t corruptions = 200;
+        std::string path;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--size" && i + 1 < argc) size_mb = std::stoul(argv[++i]);
+            else if (arg == "--rounds" && i + 1 < argc) rounds = std::max(1, std::stoi(argv[++i]));
+            else if (arg == "--corruptions" && i + 1 < argc) corruptions = std::stoul(argv[++i]);
+            else if (arg == "--file" && i + 1 < argc) path = argv[++i];
+            else throw std::runtime_error("Unknown option: " + arg);
+        }
+
+        SourceBuffer file;
+        if (!path.empty()) file = SourceBuffer::open(path);
+        std::printf("tree,bytes,nodes,cache_bytes,lex_parse_ms,encode_ms,load_ms,speedup,identical,"
+                    "flips_rejected,cuts_rejected,forged_rejected,corruptions\n");
+        bool ok = true;
+        for (bool analyze : {false, true}) {
+            std::string text;
+            if (path.empty()) {
+                text = analyze ? bench::generate_checked_program(size_mb << 20) : bench::generate_program(size_mb << 20);
+            }
+            ok &= run(path.empty() ? std::string_view(text) : file.view(), analyze, rounds, corruptions);
+        }
+        return ok ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+    }
+    return 1;
+}
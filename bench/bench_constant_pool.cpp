@@ -0,0 +1,88 @@
+// Память литералов на программе из больших инициализаторов массивов.
+// Использование: bench_constant_pool [--size MB] [--distinct N] [--file путь]
+// --distinct N - значения таблиц берутся из N различных (0 - случайные)
+// Вывод - CSV: литералы, различные константы, байты на литерал в дереве указателей (узел и доля пула)
+// и в FlatAST - против прежнего хранения значения в каждом узле (std::variant и запись деструктора в арене,
+// элемент std::vector<Value> в FlatAST); время разбора
+#include "corpus.hpp"
+#include "flat_ast.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "perf_stats.hpp"
+#include "source_buffer.hpp"
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// Прежний узел литерала: значение внутри узла
+struct VariantLiteral {
+    virtual ~VariantLiteral() = default;
+    LiteralExpr::Value value;
+};
+
+// Запись деструктора арены (указатель на функцию, объект, следующая запись)
+constexpr std::size_t cleanup_bytes = 3 * sizeof(void*);
+
+// Строки, не поместившиеся в сам std::string, занимают ещё и кучу
+std::size_t heap_bytes(const LiteralExpr::Value& value) {
+    auto text = std::get_if<std::string>(&value);
+    return text && text->capacity() >= sizeof(std::string) ? text->capacity() + 1 : 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        std::size_t size_mb = 16;
+        unsigned distinct = 0;
+        std::string path;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--size" && i + 1 < argc) size_mb = std::stoul(argv[++i]);
+            else if (arg == "--distinct" && i + 1 < argc) distinct = std::stoul(argv[++i]);
+            else if (arg == "--file" && i + 1 < argc) path = argv[++i];
+            else throw std::runtime_error("Unknown option: " + arg);
+        }
+
+        std::string text;
+        SourceBuffer file;
+        if (!path.empty()) file = SourceBuffer::open(path);
+        else text = bench::generate_arrays(size_mb << 20, distinct);
+        std::string_view source = path.empty() ? std::string_view(text) : file.view();
+        TokenBuffer tokens = Lexer(source).tokenize();
+
+        Stopwatch timer;
+        Parser parser(tokens);
+        parser.parse();
+        auto root = std::static_pointer_cast<TranslationUnitNode>(parser.getAST());
+        double parse_ms = timer.elapsed_ms();
+
+        FlatAST flat(*root);
+        std::size_t literals = 0;
+        std::size_t variant_heap = 0;
+        for (std::uint32_t i = 0; i < flat.size(); ++i) {
+            if (flat.kind(i) != NodeKind::Literal) continue;
+            ++literals;
+            variant_heap += heap_bytes(flat.literal(i));
+        }
+        if (literals == 0) throw std::runtime_error("No literals in the source");
+
+        double per = 1.0 / literals;
+        double tree_bytes = (literals * sizeof(LiteralExpr) + root->constants->bytes()) * per;
+        double variant_tree_bytes = sizeof(VariantLiteral) + cleanup_bytes + variant_heap * per;
+        double flat_bytes = flat.constants().bytes() * per;
+        double variant_flat_bytes = sizeof(LiteralExpr::Value) + variant_heap * per;
+
+        std::printf("bytes,literals,constants,tree_bytes_per_literal,variant_tree_bytes_per_literal,"
+                    "flat_bytes_per_literal,variant_flat_bytes_per_literal,parse_ms\n");
+        std::printf("%zu,%zu,%zu,%.1f,%.1f,%.1f,%.1f,%.3f\n", source.size(), literals, root->constants->size(), tree_bytes,
+                    variant_tree_bytes, flat_bytes, variant_flat_bytes, parse_ms);
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+    }
+    return 1;
+}
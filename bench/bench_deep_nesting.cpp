@@ -0,0 +1,82 @@
+// Стресс-тест глубокой вложенности: скобки, префиксные операторы, правоассоциативные цепочки,
+// вложенные блоки, цепочки else if и вложенные вызовы.
+// Использование: bench_deep_nesting [--depths 100,500,501,1000000] [--max-depth N]
+// Разбор не глубже предела должен завершаться, глубже - чистой ошибкой std::runtime_error
+// без переполнения стека; время - линейное по числу токенов. Вывод - CSV
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "perf_stats.hpp"
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string repeat(const std::string& text, std::size_t count) {
+    std::string result;
+    result.reserve(text.size() * count);
+    for (std::size_t i = 0; i < count; ++i) result += text;
+    return result;
+}
+
+// Тело main с depth уровнями вложенности
+std::string nested(const std::string& shape, std::size_t depth) {
+    std::string body;
+    if (shape == "parens") body = "x = " + repeat("(", depth) + "1" + repeat(")", depth) + ";";
+    else if (shape == "unary") body = "x = " + repeat("- ", depth) + "1;";
+    else if (shape == "binary") body = "x = " + repeat("x + (", depth) + "1" + repeat(")", depth) + ";";
+    else if (shape == "assign") body = "x" + repeat(" = x", depth) + ";";
+    else if (shape == "blocks") body = repeat("{", depth) + repeat("}", depth);
+    else if (shape == "else_if") body = "if (x) x = 1;" + repeat(" else if (x) x = 1;", depth);
+    else if (shape == "calls") body = "x = " + repeat("f(", depth) + "1" + repeat(")", depth) + ";";
+    else throw std::runtime_error("Unknown shape: " + shape);
+    return "int f(int a) { return a; }\nint main() { int x = 0; " + body + " return 0; }\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        std::vector<std::size_t> depths{100, Parser::default_max_depth - 10, Parser::default_max_depth + 10, 1000000};
+        std::size_t max_depth = Parser::default_max_depth;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--depths" && i + 1 < argc) {
+                depths.clear();
+                std::stringstream list(argv[++i]);
+                for (std::string item; std::getline(list, item, ',');) depths.push_back(std::stoul(item));
+            } else if (arg == "--max-depth" && i + 1 < argc) {
+                max_depth = std::stoul(argv[++i]);
+            } else {
+                throw std::runtime_error("Unknown option: " + arg);
+            }
+        }
+
+        std::printf("shape,depth,tokens,result,ms,ns_per_token\n");
+        for (const char* shape : {"parens", "unary", "binary", "assign", "blocks", "else_if", "calls"}) {
+            for (std::size_t depth : depths) {
+                std::string source = nested(shape, depth);
+                TokenBuffer tokens = Lexer(source).tokenize();
+                const char* result = "ok";
+                Stopwatch timer;
+                try {
+                    Parser parser(tokens);
+                    parser.set_max_depth(max_depth);
+                    parser.parse();
+                } catch (const std::runtime_error&) {
+                    result = "limit";
+                }
+                double ms = timer.elapsed_ms();
+                std::printf("%s,%zu,%zu,%s,%.3f,%.1f\n", shape, depth, tokens.size(), result, ms,
+                            ms * 1e6 / tokens.size());
+            }
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+    }
+    return 1;
+}
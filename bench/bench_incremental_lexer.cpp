@@ -0,0 +1,148 @@
+// Инкрементальное лексирование против полного: случайные правки текста и сверка результатов.
+// Использование: bench_incremental_lexer [--size KB] [--edits N] [--max-edits K] [--seed S] [--file путь]
+// На каждом шаге к тексту применяется от 1 до K случайных правок (TextEdit) и поток токенов
+// строится дважды: IncrementalLexer от прежнего потока и Lexer с нуля. Должны совпасть виды,
+// позиции и текст токенов, id символов идентификаторов, а если текст не лексируется - сообщение
+// об ошибке. Правки вставляют и удаляют куски токенов: кавычки, escape, начала комментариев,
+// цифры и точки, переводы строк. Текст после ошибки остаётся прежним.
+// Вывод - CSV: число шагов, расхождений, ошибок лексирования, доля перенесённых токенов
+// и суммарное время обоих способов
+#include "corpus.hpp"
+#include "incremental_lexer.hpp"
+#include "lexer.hpp"
+#include "perf_stats.hpp"
+#include "source_buffer.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Результат лексирования: поток токенов или текст ошибки
+struct Outcome {
+    TokenBuffer tokens;
+    std::string error;
+};
+
+template <typename F>
+Outcome lex(F&& tokenize) {
+    Outcome outcome;
+    try {
+        outcome.tokens = tokenize();
+    } catch (const std::runtime_error& e) {
+        outcome.error = e.what();
+    }
+    return outcome;
+}
+
+bool same_tokens(const TokenBuffer& a, const TokenBuffer& b) {
+    if (!(a == b)) return false;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (a.type(i) == TokenType::ID && a.symbol(i) != b.symbol(i)) return false;
+    }
+    return true;
+}
+
+bool same(const Outcome& a, const Outcome& b) {
+    if (a.error != b.error) return false;
+    return !a.error.empty() || same_tokens(a.tokens, b.tokens);
+}
+
+// Отсортированные непересекающиеся правки внутри текста размера size. Удаляется больше, чем
+// вставляется, только пока текст длиннее target: размер держится около исходного
+std::vector<TextEdit> random_edits(std::mt19937& rng, std::size_t size, std::size_t target, std::size_t max_edits) {
+    static const char* const pieces[] = {
+        " ", "\n", "x", "value", "_1", "42", "0x1F", "3.", ".5", "e+", "1e9", "+", "-", "*", "/", "=", "==", "<=",
+        "&&", "||", ";", "(", ")", "{", "}", "\"", "\"text\"", "\\", "\\n", "\\\"", "'", "'a'", "//", "/*", "*/", "@"};
+    std::vector<std::size_t> points;
+    std::size_t count = 1 + rng() % max_edits;
+    for (std::size_t k = 0; k < 2 * count; ++k) points.push_back(size ? rng() % (size + 1) : 0);
+    std::sort(points.begin(), points.end());
+
+    std::vector<TextEdit> edits;
+    for (std::size_t k = 0; k < count; ++k) {
+        std::size_t offset = points[2 * k];
+        std::size_t length = std::min<std::size_t>(points[2 * k + 1] - offset, rng() % (size > target ? 8 : 3));
+        std::string text;
+        for (std::size_t n = rng() % 4; n > 0; --n) text += pieces[rng() % std::size(pieces)];
+        edits.push_back({offset, length, std::move(text)});
+    }
+    return edits;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        std::size_t size_kb = 16;
+        std::size_t steps = 20000;
+        std::size_t max_edits = 3;
+        unsigned seed = 1;
+        std::string path;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--size" && i + 1 < argc) size_kb = std::stoul(argv[++i]);
+            else if (arg == "--edits" && i + 1 < argc) steps = std::stoul(argv[++i]);
+            else if (arg == "--max-edits" && i + 1 < argc) max_edits = std::max<std::size_t>(1, std::stoul(argv[++i]));
+            else if (arg == "--seed" && i + 1 < argc) seed = std::stoul(argv[++i]);
+            else if (arg == "--file" && i + 1 < argc) path = argv[++i];
+            else throw std::runtime_error("Unknown option: " + arg);
+        }
+
+        std::string text = path.empty() ? bench::generate_source(size_kb << 10, seed)
+                                        : std::string(SourceBuffer::open(path).view());
+        TokenBuffer tokens = Lexer(text).tokenize();
+        const std::size_t target = text.size();
+
+        std::mt19937 rng(seed);
+        std::size_t mismatches = 0;
+        std::size_t lex_errors = 0;
+        std::size_t reused = 0;
+        std::size_t relexed = 0;
+        double incremental_ms = 0;
+        double full_ms = 0;
+        for (std::size_t step = 0; step < steps; ++step) {
+            std::vector<TextEdit> edits = random_edits(rng, text.size(), target, max_edits);
+            std::string edited = apply_edits(text, edits);
+
+            IncrementalLexer incremental(tokens, edited, edits);
+            Stopwatch timer;
+            Outcome updated = lex([&] { return incremental.tokenize(); });
+            incremental_ms += timer.elapsed_ms();
+            timer.reset();
+            Outcome expected = lex([&] { return Lexer(edited).tokenize(); });
+            full_ms += timer.elapsed_ms();
+
+            if (!same(updated, expected)) {
+                if (mismatches++ == 0) {
+                    std::cerr << "Mismatch at step " << step << ", first edit at offset " << edits.front().offset
+                              << (expected.error.empty() ? "" : ", expected error: " + expected.error) << '\n';
+                }
+                continue;
+            }
+            if (!expected.error.empty()) {
+                ++lex_errors;
+                continue;
+            }
+            reused += incremental.reused_tokens();
+            relexed += incremental.relexed_tokens();
+            text = std::move(edited);
+            tokens = std::move(updated.tokens);
+            // короткая строка при перемещении копируется, и токены ссылались бы на прежний буфер
+            if (tokens.source().data() != text.data()) tokens = Lexer(text).tokenize();
+        }
+
+        double reuse = reused + relexed ? 100.0 * reused / (reused + relexed) : 0;
+        std::printf("bytes,edits,mismatches,lex_errors,reused_pct,incremental_ms,full_ms\n");
+        std::printf("%zu,%zu,%zu,%zu,%.2f,%.3f,%.3f\n", text.size(), steps, mismatches, lex_errors, reuse,
+                    incremental_ms, full_ms);
+        return mismatches == 0 ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+    }
+    return 1;
+}
@@ -0,0 +1,94 @@
+// Пропускная способность Lexer::tokenize на синтетических корпусах разного состава.
+// Использование: bench_lexer [--sizes 1,16,256] [--mix mixed,identifiers,...] [--rounds R] [--file путь]
+// Размеры - в МБ (до 1024). Вывод - CSV, по строке на корпус: лучшее время из R прогонов,
+// МБ/с, токенов/с, выделений памяти на токен (за один прогон) и пиковая память процесса
+#include "alloc_counter.hpp"
+#include "corpus.hpp"
+#include "lexer.hpp"
+#include "perf_stats.hpp"
+#include "source_buffer.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<std::size_t> parse_sizes(const std::string& list) {
+    std::vector<std::size_t> sizes;
+    std::stringstream in(list);
+    for (std::string item; std::getline(in, item, ',');) sizes.push_back(std::stoul(item));
+    return sizes;
+}
+
+std::vector<bench::Mix> parse_mixes(const std::string& list) {
+    std::vector<bench::Mix> mixes;
+    std::stringstream in(list);
+    for (std::string item; std::getline(in, item, ',');) {
+        bench::Mix mix;
+        if (!bench::parse_mix(item, mix)) throw std::runtime_error("Unknown corpus mix: " + item);
+        mixes.push_back(mix);
+    }
+    return mixes;
+}
+
+void run(const std::string& name, const std::string& mix, std::string_view source, int rounds) {
+    double best = 0;
+    std::size_t tokens = 0;
+    std::size_t allocs = 0;
+    for (int r = 0; r < rounds; ++r) {
+        std::size_t before = bench::allocations.load(std::memory_order_relaxed);
+        Stopwatch timer;
+        TokenBuffer buffer = Lexer(source).tokenize();
+        double ms = timer.elapsed_ms();
+        allocs = bench::allocations.load(std::memory_order_relaxed) - before;
+        tokens = buffer.size();
+        if (r == 0 || ms < best) best = ms;
+    }
+    double seconds = best / 1000.0;
+    double mb = source.size() / (1024.0 * 1024.0);
+    std::printf("%s,%s,%zu,%zu,%d,%.3f,%.1f,%.0f,%.4f,%zu\n", name.c_str(), mix.c_str(), source.size(), tokens, rounds,
+                best, mb / seconds, tokens / seconds, tokens ? static_cast<double>(allocs) / tokens : 0.0,
+                peak_rss_bytes() / 1024);
+    std::fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        std::vector<std::size_t> sizes = {1, 16, 256};
+        std::vector<bench::Mix> mixes(std::begin(bench::all_mixes), std::end(bench::all_mixes));
+        int rounds = 5;
+        std::string path;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--sizes" && i + 1 < argc) sizes = parse_sizes(argv[++i]);
+            else if (arg == "--mix" && i + 1 < argc) mixes = parse_mixes(argv[++i]);
+            else if (arg == "--rounds" && i + 1 < argc) rounds = std::max(1, std::stoi(argv[++i]));
+            else if (arg == "--file" && i + 1 < argc) path = argv[++i];
+            else throw std::runtime_error("Unknown option: " + arg);
+        }
+
+        std::printf("corpus,mix,bytes,tokens,rounds,best_ms,mb_per_s,tokens_per_s,allocs_per_token,peak_rss_kb\n");
+        if (!path.empty()) {
+            SourceBuffer file = SourceBuffer::open(path);
+            run(path, "file", file.view(), rounds);
+            return 0;
+        }
+        for (std::size_t mb : sizes) {
+            for (bench::Mix mix : mixes) {
+                // корпус живёт только на время замера, чтобы большие размеры не копились в памяти
+                std::string text = bench::generate_corpus(mb << 20, mix);
+                run(std::to_string(mb) + "MB", bench::mix_name(mix), text, rounds);
+            }
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+    }
+    return 1;
+}
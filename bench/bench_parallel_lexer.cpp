@@ -0,0 +1,73 @@
+// Ускорение параллельного лексера (ParallelLexer) относительно Lexer::tokenize для 1..N потоков.
+// Использование: bench_parallel_lexer [--size MB] [--threads N] [--rounds R] [файл]
+// Без файла лексируется синтетический исходник. Вывод - CSV
+#include "corpus.hpp"
+#include "lexer.hpp"
+#include "parallel_lexer.hpp"
+#include "perf_stats.hpp"
+#include "source_buffer.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+namespace {
+
+template <typename F>
+double best_ms(int rounds, F&& body) {
+    double best = 0;
+    for (int r = 0; r < rounds; ++r) {
+        Stopwatch timer;
+        body();
+        double ms = timer.elapsed_ms();
+        if (r == 0 || ms < best) best = ms;
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::size_t size_mb = 64;
+    std::size_t max_threads = ThreadPool::default_threads();
+    int rounds = 3;
+    std::string path;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--size" && i + 1 < argc) size_mb = std::stoul(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc) max_threads = std::stoul(argv[++i]);
+        else if (arg == "--rounds" && i + 1 < argc) rounds = std::max(1, std::stoi(argv[++i]));
+        else path = arg;
+    }
+
+    SourceBuffer file;
+    std::string generated;
+    std::string_view source;
+    if (!path.empty()) {
+        file = SourceBuffer::open(path);
+        source = file.view();
+    } else {
+        generated = bench::generate_source(size_mb << 20);
+        source = generated;
+    }
+    double mb = source.size() / (1024.0 * 1024.0);
+
+    TokenBuffer reference;
+    double sequential_ms = best_ms(rounds, [&] { reference = Lexer(source).tokenize(); });
+    std::printf("threads,ms,mb_per_s,speedup,chunks,resynced,identical\n");
+    std::printf("seq,%.2f,%.1f,1.00,1,0,1\n", sequential_ms, mb / (sequential_ms / 1000.0));
+
+    for (std::size_t threads = 1; threads <= max_threads; ++threads) {
+        ThreadPool pool(threads);
+        ParallelLexer lexer(source, pool);
+        TokenBuffer tokens;
+        double ms = best_ms(rounds, [&] { tokens = lexer.tokenize(); });
+        std::printf("%zu,%.2f,%.1f,%.2f,%zu,%zu,%d\n", threads, ms, mb / (ms / 1000.0), sequential_ms / ms,
+                    lexer.chunks(), lexer.resynced(), tokens == reference ? 1 : 0);
+        if (tokens != reference) {
+            std::cerr << "token stream differs from sequential lexer" << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
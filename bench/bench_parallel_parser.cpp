@@ -0,0 +1,102 @@
+// Ускорение параллельного парсера (ParallelParser) относительно Parser::parse для 1..N потоков.
+// Использование: bench_parallel_parser [--size MB] [--threads N] [--rounds R] [файл]
+// Без файла разбирается сгенерированная программа. Деревья сравниваются через плоскую форму.
+// Вывод - CSV
+#include "corpus.hpp"
+#include "flat_ast.hpp"
+#include "lexer.hpp"
+#include "parallel_parser.hpp"
+#include "parser.hpp"
+#include "perf_stats.hpp"
+#include "source_buffer.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+namespace {
+
+template <typename F>
+double best_ms(int rounds, F&& body) {
+    double best = 0;
+    for (int r = 0; r < rounds; ++r) {
+        Stopwatch timer;
+        body();
+        double ms = timer.elapsed_ms();
+        if (r == 0 || ms < best) best = ms;
+    }
+    return best;
+}
+
+FlatAST flatten(const TranslationUnitNode& root) {
+    FlatAST flat;
+    for (auto decl : root.decls) flat.append(decl);
+    return flat;
+}
+
+bool same_tree(const FlatAST& a, const FlatAST& b) {
+    if (a.size() != b.size()) return false;
+    for (std::uint32_t i = 0; i < a.size(); ++i) {
+        if (a.kind(i) != b.kind(i) || a.end(i) != b.end(i) || a.data(i) != b.data(i)) return false;
+        if (a.kind(i) == NodeKind::Literal && a.literal(i) != b.literal(i)) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::size_t size_mb = 16;
+    std::size_t max_threads = ThreadPool::default_threads();
+    int rounds = 3;
+    std::string path;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--size" && i + 1 < argc) size_mb = std::stoul(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc) max_threads = std::stoul(argv[++i]);
+        else if (arg == "--rounds" && i + 1 < argc) rounds = std::max(1, std::stoi(argv[++i]));
+        else path = arg;
+    }
+
+    SourceBuffer file;
+    std::string generated;
+    std::string_view source;
+    if (!path.empty()) {
+        file = SourceBuffer::open(path);
+        source = file.view();
+    } else {
+        generated = bench::generate_program(size_mb << 20);
+        source = generated;
+    }
+    TokenBuffer tokens = Lexer(source).tokenize();
+
+    std::shared_ptr<TranslationUnitNode> reference;
+    double sequential_ms = best_ms(rounds, [&] {
+        reference.reset();
+        Parser parser(tokens);
+        parser.parse();
+        reference = std::static_pointer_cast<TranslationUnitNode>(parser.getAST());
+    });
+    FlatAST expected = flatten(*reference);
+    std::printf("threads,ms,speedup,declarations,groups,fallback,identical\n");
+    std::printf("seq,%.2f,1.00,%zu,1,0,1\n", sequential_ms, reference->decls.size());
+    reference.reset();
+
+    for (std::size_t threads = 1; threads <= max_threads; ++threads) {
+        ThreadPool pool(threads);
+        ParallelParser parser(tokens, pool);
+        std::shared_ptr<TranslationUnitNode> root;
+        double ms = best_ms(rounds, [&] {
+            root.reset();
+            root = parser.parse();
+        });
+        bool identical = same_tree(flatten(*root), expected);
+        std::printf("%zu,%.2f,%.2f,%zu,%zu,%d,%d\n", threads, ms, sequential_ms / ms, parser.declarations(),
+                    parser.groups(), parser.fell_back() ? 1 : 0, identical ? 1 : 0);
+        if (!identical) {
+            std::cerr << "AST differs from sequential parser" << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
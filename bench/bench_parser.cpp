@@ -0,0 +1,111 @@
+// Построение AST на большой сгенерированной программе.
+// Использование: bench_parser [--size MB] [--expr-depth N] [--lazy P] [--hash-cons] [--input вид] [--rounds R] [--file путь]
+// --expr-depth углубляет выражения программы: N > 0 даёт вход с преобладанием выражений
+// --input - сгенерированный вход: program (по умолчанию), arrays (таблицы-инициализаторы),
+// unrolled (развёрнутые циклы с повторяющимися индексными выражениями)
+// --hash-cons - одинаковые выражения без побочных эффектов становятся общими узлами (Parser::set_hash_consing)
+// --lazy P - ленивые тела функций; после разбора запрашиваются тела P% функций (равномерно по программе),
+// их разбор входит во время разбора
+// Вывод - CSV: режим тел функций, hash-consing (общих выражений и повторов, заменённых ссылкой), число узлов, выделения памяти кучи при разборе (штук и на узел), байты кучи,
+// байты арены (всего и на узел), лучшее время разбора и освобождения дерева из R прогонов, пиковая память
+#include "alloc_counter.hpp"
+#include "corpus.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "perf_stats.hpp"
+#include "source_buffer.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+int main(int argc, char* argv[]) {
+    try {
+        std::size_t size_mb = 16;
+        int expr_depth = 0;
+        int lazy_percent = -1;    // < 0 - тела разбираются сразу
+        int rounds = 5;
+        bool hash_cons = false;
+        std::string input = "program";
+        std::string path;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--size" && i + 1 < argc) size_mb = std::stoul(argv[++i]);
+            else if (arg == "--expr-depth" && i + 1 < argc) expr_depth = std::stoi(argv[++i]);
+            else if (arg == "--lazy" && i + 1 < argc) lazy_percent = std::clamp(std::stoi(argv[++i]), 0, 100);
+            else if (arg == "--hash-cons") hash_cons = true;
+            else if (arg == "--input" && i + 1 < argc) input = argv[++i];
+            else if (arg == "--rounds" && i + 1 < argc) rounds = std::max(1, std::stoi(argv[++i]));
+            else if (arg == "--file" && i + 1 < argc) path = argv[++i];
+            else throw std::runtime_error("Unknown option: " + arg);
+        }
+
+        std::string text;
+        SourceBuffer file;
+        if (!path.empty()) file = SourceBuffer::open(path);
+        else if (input == "program") text = bench::generate_program(size_mb << 20, 1, expr_depth);
+        else if (input == "arrays") text = bench::generate_arrays(size_mb << 20);
+        else if (input == "unrolled") text = bench::generate_unrolled(size_mb << 20);
+        else throw std::runtime_error("Unknown input: " + input);
+        std::string_view source = path.empty() ? std::string_view(text) : file.view();
+        TokenBuffer tokens = Lexer(source).tokenize();
+
+        double best_parse = 0;
+        double best_free = 0;
+        std::size_t allocs = 0;
+        std::size_t heap_bytes = 0;
+        std::size_t nodes = 0;
+        std::size_t arena_bytes = 0;
+        std::size_t shared = 0;
+        std::size_t reused = 0;
+        for (int r = 0; r < rounds; ++r) {
+            std::size_t allocs_before = bench::allocations.load(std::memory_order_relaxed);
+            std::size_t bytes_before = bench::allocated_bytes.load(std::memory_order_relaxed);
+            Stopwatch timer;
+            auto parser = std::make_unique<Parser>(tokens);
+            parser->set_lazy_bodies(lazy_percent >= 0);
+            parser->set_hash_consing(hash_cons);
+            parser->parse();
+            auto root = std::static_pointer_cast<TranslationUnitNode>(parser->getAST());
+            if (lazy_percent >= 0) {
+                std::size_t function = 0;
+                for (auto decl : root->decls) {
+                    auto func = node_cast<FunctionDecl>(decl);
+                    if (!func) continue;
+                    if ((function + 1) * lazy_percent / 100 != function * lazy_percent / 100) func->get_body();
+                    ++function;
+                }
+            }
+            double parse_ms = timer.elapsed_ms();
+            allocs = bench::allocations.load(std::memory_order_relaxed) - allocs_before;
+            heap_bytes = bench::allocated_bytes.load(std::memory_order_relaxed) - bytes_before;
+            nodes = root->arena.objects();
+            arena_bytes = root->arena.bytes_used();
+            if (auto table = parser->expr_table()) {
+                shared = table->size();
+                reused = table->hits();
+            }
+
+            timer.reset();
+            root.reset();
+            parser.reset();
+            double free_ms = timer.elapsed_ms();
+            if (r == 0 || parse_ms < best_parse) best_parse = parse_ms;
+            if (r == 0 || free_ms < best_free) best_free = free_ms;
+        }
+
+        std::string bodies = lazy_percent < 0 ? "eager" : "lazy " + std::to_string(lazy_percent) + "%";
+        std::printf("bodies,hash_cons,shared,reused,bytes,tokens,nodes,allocs,allocs_per_node,heap_bytes,arena_bytes,"
+                    "arena_bytes_per_node,parse_ms,free_ms,peak_rss_kb\n");
+        std::printf("%s,%s,%zu,%zu,%zu,%zu,%zu,%zu,%.3f,%zu,%zu,%.1f,%.3f,%.3f,%zu\n", bodies.c_str(), hash_cons ? "on" : "off",
+                    shared, reused, source.size(), tokens.size(), nodes, allocs,
+                    nodes ? static_cast<double>(allocs) / nodes : 0.0, heap_bytes, arena_bytes,
+                    nodes ? static_cast<double>(arena_bytes) / nodes : 0.0, best_parse, best_free,
+                    peak_rss_bytes() / 1024);
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+    }
+    return 1;
+}
@@ -0,0 +1,96 @@
+// Микробенчмарк распознавания ключевых слов и операторов:
+// прежние unordered_map-таблицы против таблиц, построенных при компиляции (token_tables.hpp)
+#include "token_tables.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// Прежняя реализация Lexer::extract_identifier / extract_operator
+const std::unordered_map<std::string, TokenType> old_keywords = [] {
+    std::unordered_map<std::string, TokenType> map;
+    for (const auto& kw : keyword_list) map.emplace(std::string(kw.text), kw.type);
+    return map;
+}();
+
+const std::unordered_map<std::string, TokenType> old_operators = [] {
+    std::unordered_map<std::string, TokenType> map;
+    for (const auto& op : operator_list) map.emplace(std::string(op.text), op.type);
+    return map;
+}();
+
+TokenType old_identifier(const std::string& input, std::size_t start, std::size_t length) {
+    std::string name = input.substr(start, length);
+    if (auto it = old_keywords.find(name); it != old_keywords.end()) return it->second;
+    return TokenType::ID;
+}
+
+std::size_t old_operator(const std::string& input, std::size_t index, TokenType& type) {
+    std::string op;
+    std::size_t start = index;
+    while (old_operators.find(op + input[index]) != old_operators.end()) op += input[index++];
+    if (!op.empty()) type = old_operators.at(op);
+    return index - start;
+}
+
+struct Span {
+    std::size_t offset;
+    std::size_t length;
+};
+
+template <typename F>
+double ns_per_item(std::size_t items, int rounds, F&& body) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) body();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (static_cast<double>(items) * rounds);
+}
+
+} // namespace
+
+int main() {
+    // Текст из идентификаторов (треть - ключевые слова) и операторов через пробел
+    std::mt19937 rng(42);
+    std::vector<std::string> names = {"value", "counter", "i", "index_of_element", "tmp", "result_buffer_42"};
+    for (const auto& kw : keyword_list) names.emplace_back(kw.text);
+
+    std::string input;
+    std::vector<Span> idents, ops;
+    for (int i = 0; i < 200000; ++i) {
+        const std::string& name = names[rng() % names.size()];
+        idents.push_back({input.size(), name.size()});
+        input += name;
+        input += ' ';
+        std::string_view op = operator_list[rng() % std::size(operator_list)].text;
+        ops.push_back({input.size(), op.size()});
+        input += op;
+        input += ' ';
+    }
+
+    unsigned sink = 0;
+    const int rounds = 20;
+    double old_id = ns_per_item(idents.size(), rounds, [&] {
+        for (const auto& s : idents) sink += static_cast<unsigned>(old_identifier(input, s.offset, s.length));
+    });
+    double new_id = ns_per_item(idents.size(), rounds, [&] {
+        for (const auto& s : idents) sink += static_cast<unsigned>(keyword_type(std::string_view(input).substr(s.offset, s.length)));
+    });
+    double old_op = ns_per_item(ops.size(), rounds, [&] {
+        TokenType type{};
+        for (const auto& s : ops) sink += static_cast<unsigned>(old_operator(input, s.offset, type));
+    });
+    double new_op = ns_per_item(ops.size(), rounds, [&] {
+        TokenType type{};
+        const char* end = input.data() + input.size();
+        for (const auto& s : ops) sink += static_cast<unsigned>(match_operator(input.data() + s.offset, end, type));
+    });
+
+    std::printf("recognizer,before_ns_per_token,after_ns_per_token\n");
+    std::printf("identifier,%.2f,%.2f\n", old_id, new_id);
+    std::printf("operator,%.2f,%.2f\n", old_op, new_op);
+    return sink == 0xFFFFFFFFu;
+}
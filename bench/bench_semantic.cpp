@@ -0,0 +1,233 @@
+// Семантический анализ и области видимости на программе без ошибок (generate_checked_program).
+// Использование: bench_semantic [--size MB] [--globals N] [--depth D] [--threads T] [--rounds R] [--file путь]
+// check_ms - полный SemanticAnalyzer, parallel_check_ms - он же с проверкой тел функций в пуле из T потоков
+// (по умолчанию - по числу ядер), bind_ms - привязка имён к ячейкам (Binder). После анализа
+// считаются выражения, получившие тип (typed), и вставленные узлы неявных преобразований (casts).
+// scope_ms и legacy_scope_ms - только работа с областями видимости в порядке анализатора (вход и выход,
+// объявления, поиск каждого идентификатора): стек Scope против прежних областей, где вход копировал
+// текущую таблицу, а поиск шёл по цепочке родителей.
+// Вывод - CSV: лучшее время из R прогонов
+#include "binder.hpp"
+#include "corpus.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "perf_stats.hpp"
+#include "scope.hpp"
+#include "semantic_analyzer.hpp"
+#include "source_buffer.hpp"
+#include "thread_pool.hpp"
+#include "visitor.hpp"
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// Прежняя область видимости: своя SymbolTable и указатель на родителя
+class LegacyScope {
+public:
+    explicit LegacyScope(std::shared_ptr<LegacyScope> parent = nullptr) : parent(std::move(parent)) {}
+
+    std::shared_ptr<LegacyScope> enterScope() {
+        return std::make_shared<LegacyScope>(std::make_shared<LegacyScope>(*this));
+    }
+    std::shared_ptr<LegacyScope> exitScope() { return parent; }
+
+    template <typename Info>
+    void declare(Symbol name, const Info& info) { table.declare(name, info); }
+
+    std::optional<SymbolInfo> exists_var(Symbol name) const {
+        if (auto info = table.lookup_var(name)) return info;
+        return parent ? parent->exists_var(name) : std::nullopt;
+    }
+
+private:
+    SymbolTable table;
+    std::shared_ptr<LegacyScope> parent;
+};
+
+// Операции анализатора над областями: Scope напрямую
+struct StackScopes {
+    Scope scope;
+
+    void enter() { scope.enterScope(); }
+    void exit() { scope.exitScope(); }
+    template <typename Info>
+    void declare(Symbol name, const Info& info) { scope.declare(name, info); }
+    bool found(Symbol name) const { return scope.exists_var(name) != nullptr; }
+};
+
+// ... и через прежние объекты областей, как их держал анализатор
+struct LegacyScopes {
+    std::shared_ptr<LegacyScope> current = std::make_shared<LegacyScope>();
+
+    void enter() { current = current->enterScope(); }
+    void exit() { current = current->exitScope(); }
+    template <typename Info>
+    void declare(Symbol name, const Info& info) { current->declare(name, info); }
+    bool found(Symbol name) const { return current->exists_var(name).has_value(); }
+};
+
+struct Counts {
+    std::size_t functions = 0;
+    std::size_t blocks = 0;
+    std::size_t lookups = 0;
+    std::size_t missing = 0;
+};
+
+// Порядок входов, объявлений и поисков как в SemanticVisitor
+template <typename Scopes>
+struct ScopeReplay : StaticVisitor<ScopeReplay<Scopes>> {
+    using StaticVisitor<ScopeReplay<Scopes>>::visit;
+    using StaticVisitor<ScopeReplay<Scopes>>::walk;
+    using StaticVisitor<ScopeReplay<Scopes>>::walk_children;
+
+    Scopes scopes;
+    Counts counts;
+
+    void visit(FunctionDecl& decl) {
+        ++counts.functions;
+        scopes.declare(decl.name, FunctionInfo(decl.return_mods, decl.return_type, decl.params));
+        BlockStmt* body = decl.get_body();
+        if (!body) return;
+        scopes.enter();
+        for (const auto& param : decl.params) scopes.declare(param.second, SymbolInfo(param.first.first, param.first.second));
+        walk(body);
+        scopes.exit();
+    }
+    void visit(BlockStmt& block) {
+        ++counts.blocks;
+        scopes.enter();
+        walk_children(block);
+        scopes.exit();
+    }
+    void visit(ForStmt& stmt) {
+        scopes.enter();
+        walk_children(stmt);
+        scopes.exit();
+    }
+    void visit(VarDecl& decl) {
+        for (auto& variable : decl.variables) {
+            walk(variable.init);
+            walk(variable.size);
+            scopes.declare(variable.name, SymbolInfo(decl.modifiers, decl.type));
+        }
+    }
+    void visit(IdExpr& expr) {
+        ++counts.lookups;
+        if (!scopes.found(expr.name)) ++counts.missing;
+    }
+    void visit(CallExpr& expr) {
+        for (auto arg : expr.args) walk(arg);
+    }
+};
+
+// Выражения дерева после анализа
+struct TypeCounter : StaticVisitor<TypeCounter> {
+    std::size_t exprs = 0;
+    std::size_t typed = 0;
+    std::size_t casts = 0;
+
+    template <typename Node>
+    void visit(Node& node) {
+        if constexpr (std::is_base_of_v<Expr, Node>) {
+            ++exprs;
+            if (node.type_id != 0) ++typed;
+            if constexpr (std::is_same_v<Node, CastExpr>) ++casts;
+        }
+        walk_children(node);
+    }
+};
+
+double best_of(int rounds, const std::function<void()>& run) {
+    double best = 0;
+    for (int r = 0; r < rounds; ++r) {
+        Stopwatch timer;
+        run();
+        double ms = timer.elapsed_ms();
+        if (r == 0 || ms < best) best = ms;
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        std::size_t size_mb = 8;
+        unsigned globals = 256;
+        unsigned depth = 4;
+        std::size_t threads = ThreadPool::default_threads();
+        int rounds = 5;
+        std::string path;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--size" && i + 1 < argc) size_mb = std::stoul(argv[++i]);
+            else if (arg == "--globals" && i + 1 < argc) globals = std::stoul(argv[++i]);
+            else if (arg == "--depth" && i + 1 < argc) depth = std::stoul(argv[++i]);
+            else if (arg == "--threads" && i + 1 < argc) threads = std::stoul(argv[++i]);
+            else if (arg == "--rounds" && i + 1 < argc) rounds = std::stoi(argv[++i]);
+            else if (arg == "--file" && i + 1 < argc) path = argv[++i];
+            else throw std::runtime_error("Unknown option: " + arg);
+        }
+        if (rounds < 1) rounds = 1;
+
+        std::string text;
+        SourceBuffer file;
+        if (!path.empty()) file = SourceBuffer::open(path);
+        else text = bench::generate_checked_program(size_mb << 20, globals, depth);
+        std::string_view source = path.empty() ? std::string_view(text) : file.view();
+        TokenBuffer tokens = Lexer(source).tokenize();
+        Parser parser(tokens);
+        parser.parse();
+        auto root = std::static_pointer_cast<TranslationUnitNode>(parser.getAST());
+
+        // Раунды обоих анализов чередуются, чтобы дрейф нагрузки машины не достался одному из них
+        ThreadPool pool(threads);
+        double check_ms = 0;
+        double parallel_check_ms = 0;
+        for (int r = 0; r < rounds; ++r) {
+            double serial = best_of(1, [&] { SemanticAnalyzer().analyze(root); });
+            double parallel = best_of(1, [&] { SemanticAnalyzer().analyze(root, pool); });
+            if (r == 0 || serial < check_ms) check_ms = serial;
+            if (r == 0 || parallel < parallel_check_ms) parallel_check_ms = parallel;
+        }
+        TypeCounter types;
+        types.walk(root.get());
+        std::size_t shadowed = 0;
+        double bind_ms = best_of(rounds, [&] {
+            Binder binder;
+            binder.bind(*root);
+            shadowed = binder.shadowings().size();
+        });
+
+        Counts counts;
+        double scope_ms = best_of(rounds, [&] {
+            ScopeReplay<StackScopes> replay;
+            replay.walk(root.get());
+            counts = replay.counts;
+        });
+        Counts legacy_counts;
+        double legacy_scope_ms = best_of(rounds, [&] {
+            ScopeReplay<LegacyScopes> replay;
+            replay.walk(root.get());
+            legacy_counts = replay.counts;
+        });
+        if (counts.missing != legacy_counts.missing || counts.lookups != legacy_counts.lookups) {
+            throw std::runtime_error("Scope replays disagree");
+        }
+
+        std::printf("bytes,globals,depth,functions,blocks,lookups,shadowed,exprs,typed,casts,threads,check_ms,"
+                    "parallel_check_ms,bind_ms,scope_ms,legacy_scope_ms\n");
+        std::printf("%zu,%u,%u,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%.3f,%.3f,%.3f,%.3f,%.3f\n", source.size(), globals, depth,
+                    counts.functions, counts.blocks, counts.lookups, shadowed, types.exprs, types.typed, types.casts,
+                    pool.size(), check_ms, parallel_check_ms, bind_ms, scope_ms, legacy_scope_ms);
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+    }
+    return 1;
+}
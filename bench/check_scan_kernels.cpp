@@ -0,0 +1,169 @@
+// Сверка векторных ядер сканирования со скалярными. Ненулевой код выхода - расхождение.
+// Использование: check_scan_kernels [--size KB] [--seed S] [--file путь]
+// Для каждого уровня (scan::Level), который поддерживает процессор, каждое ядро вызывается:
+// - на корпусах всех видов (generate_corpus) и программе: цепочкой от позиции, где
+//   остановился предыдущий вызов, и с каждой позиции с концом не дальше 70 байт;
+// - на длинах 0-33 байт при всех сдвигах от границы 64 байт: символ, останавливающий ядро,
+//   ставится в каждую позицию, за концом лежат символы, на которых ядро не остановилось бы.
+// Потоки токенов Lexer на каждом уровне сравниваются со скалярным.
+// Вывод - CSV: по строке на уровень и ядро
+#include "corpus.hpp"
+#include "lexer.hpp"
+#include "scan_kernels.hpp"
+#include "source_buffer.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Kernel = const char* (*)(const char* p, const char* end);
+
+struct KernelInfo {
+    const char* name;
+    Kernel scan::Kernels::*kernel;
+    const char* pass;   // символы, на которых ядро идёт дальше
+    const char* stop;   // символы, на которых останавливается
+};
+
+// find_comment_end останавливается на паре "*/": в pass - символы, из которых пара не сложится
+const KernelInfo kernel_infos[] = {
+    {"skip_whitespace", &scan::Kernels::skip_whitespace, " \t\n\v\f\r", "a0_*/\x80\xff"},
+    {"skip_identifier", &scan::Kernels::skip_identifier, "azAZ09_", " \n*/-\x80\xff"},
+    {"skip_digits", &scan::Kernels::skip_digits, "0123456789", "a_ ./\x80\xff"},
+    {"find_newline", &scan::Kernels::find_newline, "a \r*/\x80\xff", "\n"},
+    {"find_comment_end", &scan::Kernels::find_comment_end, "a /\n\x80\xff", "*"},
+};
+
+struct Checker {
+    scan::Kernels scalar;
+    scan::Kernels tested;
+    const char* level;
+    std::size_t calls = 0;
+    std::size_t mismatches = 0;
+
+    void compare(const KernelInfo& info, const char* p, const char* end, const char* what) {
+        ++calls;
+        const char* expected = (scalar.*info.kernel)(p, end);
+        const char* actual = (tested.*info.kernel)(p, end);
+        if (actual == expected) return;
+        if (mismatches++ < 10) {
+            std::cerr << level << ' ' << info.name << " on " << what << ": length " << end - p << ", address % 64 = "
+                      << reinterpret_cast<std::uintptr_t>(p) % 64 << ", expected " << expected - p << ", got "
+                      << actual - p << '\n';
+        }
+    }
+
+    void corpus(const KernelInfo& info, std::string_view text, const char* what) {
+        const char* begin = text.data();
+        const char* end = begin + text.size();
+        for (const char* p = begin; p < end;) {
+            const char* next = (scalar.*info.kernel)(p, end);
+            compare(info, p, end, what);
+            p = std::max(next, p + 1);
+        }
+        for (const char* p = begin; p < end; ++p) compare(info, p, std::min(end, p + 70), what);
+    }
+
+    // Буфер выровнен на 64 байта; для find_comment_end за стоп-символом '*' идёт '/'
+    void short_lengths(const KernelInfo& info, std::mt19937& rng) {
+        alignas(64) char buffer[192];
+        std::string_view pass = info.pass;
+        std::string_view stop = info.stop;
+        bool pair = std::string_view(info.name) == "find_comment_end";
+        for (std::size_t shift = 0; shift < 64; ++shift) {
+            for (std::size_t length = 0; length <= 33; ++length) {
+                char* p = buffer + shift;
+                for (std::size_t at = 0; at <= length; ++at) {
+                    for (char& c : buffer) c = pass[rng() % pass.size()];
+                    if (at < length) {
+                        p[at] = stop[rng() % stop.size()];
+                        if (pair && at + 1 < sizeof(buffer) - shift) p[at + 1] = '/';
+                    }
+                    compare(info, p, p + length, "short input");
+                }
+                // случайная смесь обоих классов
+                for (std::size_t k = 0; k < 4; ++k) {
+                    for (char& c : buffer) c = rng() % 2 ? pass[rng() % pass.size()] : stop[rng() % stop.size()];
+                    if (pair) {
+                        for (std::size_t i = 0; i + 1 < sizeof(buffer); ++i) {
+                            if (buffer[i] == '*' && rng() % 2) buffer[i + 1] = '/';
+                        }
+                    }
+                    compare(info, p, p + length, "short input");
+                }
+            }
+        }
+    }
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        std::size_t size_kb = 64;
+        unsigned seed = 1;
+        std::string path;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--size" && i + 1 < argc) size_kb = std::stoul(argv[++i]);
+            else if (arg == "--seed" && i + 1 < argc) seed = std::stoul(argv[++i]);
+            else if (arg == "--file" && i + 1 < argc) path = argv[++i];
+            else throw std::runtime_error("Unknown option: " + arg);
+        }
+
+        std::vector<std::pair<std::string, std::string>> corpora;
+        if (!path.empty()) {
+            corpora.emplace_back(path, std::string(SourceBuffer::open(path).view()));
+        } else {
+            for (bench::Mix mix : bench::all_mixes) {
+                corpora.emplace_back(bench::mix_name(mix), bench::generate_corpus(size_kb << 10, mix, seed));
+            }
+            corpora.emplace_back("program", bench::generate_program(size_kb << 10, seed));
+        }
+
+        const scan::Level initial = scan::active_level();
+        scan::set_level(scan::Level::Scalar);
+        const scan::Kernels scalar = scan::active_kernels;
+        std::vector<TokenBuffer> reference;
+        for (const auto& corpus : corpora) reference.push_back(Lexer(corpus.second).tokenize());
+
+        std::size_t mismatches = 0;
+        std::printf("level,kernel,calls,mismatches\n");
+        for (scan::Level level : {scan::Level::Scalar, scan::Level::SSE2, scan::Level::AVX2}) {
+            if (!scan::set_level(level)) {
+                std::printf("%s,unsupported,0,0\n", scan::level_name(level));
+                continue;
+            }
+            std::mt19937 rng(seed);
+            for (const KernelInfo& info : kernel_infos) {
+                Checker checker{scalar, scan::active_kernels, scan::level_name(level)};
+                for (const auto& corpus : corpora) checker.corpus(info, corpus.second, corpus.first.c_str());
+                checker.short_lengths(info, rng);
+                std::printf("%s,%s,%zu,%zu\n", checker.level, info.name, checker.calls, checker.mismatches);
+                mismatches += checker.mismatches;
+            }
+
+            std::size_t streams = 0;
+            for (std::size_t i = 0; i < corpora.size(); ++i) {
+                if (Lexer(corpora[i].second).tokenize() == reference[i]) continue;
+                std::cerr << scan::level_name(level) << " token stream differs from scalar on " << corpora[i].first << '\n';
+                ++streams;
+            }
+            std::printf("%s,tokenize,%zu,%zu\n", scan::level_name(level), corpora.size(), streams);
+            mismatches += streams;
+        }
+        scan::set_level(initial);
+        return mismatches == 0 ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+    }
+    return 1;
+}
@@ -0,0 +1,393 @@
+#pragma once
+// Генератор синтетических исходников для бенчмарков лексера и парсера
+#include <cstddef>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+
+namespace bench {
+
+// Преобладающий вид токенов в корпусе
+enum class Mix { Mixed, Identifiers, Numbers, Comments, Strings };
+
+inline constexpr Mix all_mixes[] = {Mix::Mixed, Mix::Identifiers, Mix::Numbers, Mix::Comments, Mix::Strings};
+
+inline const char* mix_name(Mix mix) {
+    switch (mix) {
+        case Mix::Mixed: return "mixed";
+        case Mix::Identifiers: return "identifiers";
+        case Mix::Numbers: return "numbers";
+        case Mix::Comments: return "comments";
+        case Mix::Strings: return "strings";
+    }
+    return "unknown";
+}
+
+inline bool parse_mix(std::string_view name, Mix& mix) {
+    for (Mix m : all_mixes) {
+        if (name == mix_name(m)) {
+            mix = m;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Похожий на настоящий код текст: объявления, выражения, литералы, комментарии, многострочные строки
+inline std::string generate_source(std::size_t bytes, unsigned seed = 1) {
+    static const char* const names[] = {"value", "counter", "i", "index_of_element", "tmp", "result_buffer_42", "x", "arr"};
+    static const char* const types[] = {"int", "double", "long", "char", "bool"};
+    static const char* const ops[] = {"+", "-", "*", "/", "%", "==", "!=", "<", "<=", "&&", "||"};
+    std::mt19937 rng(seed);
+    auto pick = [&](const auto& list) { return list[rng() % std::size(list)]; };
+
+    std::string out;
+    out.reserve(bytes + 256);
+    while (out.size() < bytes) {
+        switch (rng() % 8) {
+            case 0:
+                out += "/* block comment with \"quotes\" and 'chars'\n   spanning lines */\n";
+                break;
+            case 1:
+                out += "// line comment: int x = \"not a string\n";
+                break;
+            case 2:
+                out += "print(\"string literal with \\\"escapes\\\" and /* no comment */\\n\");\n";
+                break;
+            case 3:
+                out += "char c = '";
+                out += static_cast<char>('a' + rng() % 26);
+                out += "';\n";
+                break;
+            default:
+                out += pick(types);
+                out += ' ';
+                out += pick(names);
+                out += " = ";
+                out += std::to_string(rng() % 100000);
+                out += ' ';
+                out += pick(ops);
+                out += ' ';
+                out += pick(names);
+                out += " * 2.5;\n";
+                break;
+        }
+    }
+    return out;
+}
+
+// Идентификаторы разной длины из большого словаря, разделённые операторами
+inline std::string generate_identifiers(std::size_t bytes, unsigned seed) {
+    static const char* const ops[] = {" = ", ", ", " + ", "; ", "(", ") ", ".", " == "};
+    std::mt19937 rng(seed);
+    std::string out;
+    out.reserve(bytes + 64);
+    while (out.size() < bytes) {
+        unsigned id = rng() % 10000;
+        out += (id % 3 == 0) ? "very_long_identifier_name_" : (id % 3 == 1) ? "v" : "counter";
+        out += std::to_string(id);
+        out += ops[rng() % std::size(ops)];
+        if (rng() % 16 == 0) out += '\n';
+    }
+    return out;
+}
+
+// Целые и вещественные литералы во всех формах: основания, суффиксы, экспоненты
+inline std::string generate_numbers(std::size_t bytes, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::string out;
+    out.reserve(bytes + 64);
+    char buffer[64];
+    while (out.size() < bytes) {
+        switch (rng() % 6) {
+            case 0: std::snprintf(buffer, sizeof buffer, "%u", static_cast<unsigned>(rng() % 1000000)); break;
+            case 1: std::snprintf(buffer, sizeof buffer, "0x%X", static_cast<unsigned>(rng())); break;
+            case 2: std::snprintf(buffer, sizeof buffer, "%u.%u", static_cast<unsigned>(rng() % 1000), static_cast<unsigned>(rng() % 1000)); break;
+            case 3: std::snprintf(buffer, sizeof buffer, "%ue-%u", static_cast<unsigned>(rng() % 100), static_cast<unsigned>(rng() % 30)); break;
+            case 4: std::snprintf(buffer, sizeof buffer, "%uul", static_cast<unsigned>(rng())); break;
+            default: std::snprintf(buffer, sizeof buffer, "%u.%uf", static_cast<unsigned>(rng() % 100), static_cast<unsigned>(rng() % 100)); break;
+        }
+        out += buffer;
+        out += (rng() % 8 == 0) ? ",\n" : ", ";
+    }
+    return out;
+}
+
+// Длинные строчные и блочные комментарии, между ними редкие инструкции
+inline std::string generate_comments(std::size_t bytes, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::string out;
+    out.reserve(bytes + 256);
+    while (out.size() < bytes) {
+        switch (rng() % 3) {
+            case 0:
+                out += "// line comment describing the next statement in some detail, with \"quotes\"\n";
+                break;
+            case 1:
+                out += "/* block comment\n * spanning several lines * with stars\n * and // slashes\n */\n";
+                break;
+            default:
+                out += "x = x + 1;\n";
+                break;
+        }
+    }
+    return out;
+}
+
+// Строковые литералы разной длины, часть с escape-последовательностями
+inline std::string generate_strings(std::size_t bytes, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::string out;
+    out.reserve(bytes + 256);
+    while (out.size() < bytes) {
+        out += "print(\"";
+        std::size_t length = 4 + rng() % 60;
+        for (std::size_t i = 0; i < length; ++i) out += static_cast<char>('a' + rng() % 26);
+        if (rng() % 4 == 0) out += "\\n\\t\\\"";
+        out += "\");\n";
+    }
+    return out;
+}
+
+// Программа, которую парсер разбирает без ошибок: структуры, глобальные переменные
+// и функции с вложенными ветвлениями, циклами, вызовами и выражениями
+class ProgramWriter {
+public:
+    // extra_depth - насколько глубже обычного выражения в объявлениях и присваиваниях
+    explicit ProgramWriter(unsigned seed, int extra_depth = 0) : rng(seed), extra_depth(extra_depth) {}
+
+    std::string generate(std::size_t bytes) {
+        out.clear();
+        out.reserve(bytes + 1024);
+        for (unsigned n = 0; out.size() < bytes; ++n) {
+            switch (rng() % 6) {
+                case 0:
+                    out += "struct s" + std::to_string(n) + " {\n    int a;\n    double b;\n    long c;\n};\n\n";
+                    break;
+                case 1:
+                    out += std::string(pick(types)) + " g" + std::to_string(n) + " = ";
+                    expression(2);
+                    out += ";\n\n";
+                    break;
+                default:
+                    function(n);
+                    break;
+            }
+        }
+        return std::move(out);
+    }
+
+private:
+    static constexpr const char* types[] = {"int", "long", "double", "short"};
+    static constexpr const char* names[] = {"a", "b", "count", "total", "index", "value_of_item", "x", "y"};
+    static constexpr const char* ops[] = {"+", "-", "*", "/", "%", "<", ">", "<=", "==", "!=", "&&", "||"};
+
+    std::mt19937 rng;
+    int extra_depth;
+    std::string out;
+
+    template <typename List>
+    const char* pick(const List& list) { return list[rng() % std::size(list)]; }
+
+    void indent(int level) { out.append(4 * level, ' '); }
+
+    void function(unsigned n) {
+        out += std::string(pick(types)) + " f" + std::to_string(n) + "(int a, double b) {\n";
+        for (unsigned count = 2 + rng() % 6; count; --count) statement(1, 3);
+        indent(1);
+        out += "return ";
+        expression(2);
+        out += ";\n}\n\n";
+    }
+
+    void block(int level, int depth) {
+        out += "{\n";
+        for (unsigned count = 1 + rng() % 3; count; --count) statement(level + 1, depth - 1);
+        indent(level);
+        out += "}";
+    }
+
+    void statement(int level, int depth) {
+        indent(level);
+        switch (depth > 0 ? rng() % 8 : rng() % 3) {
+            case 0:
+                out += std::string(pick(types)) + ' ' + pick(names) + " = ";
+                expression(3 + extra_depth);
+                out += ";\n";
+                break;
+            case 1:
+                out += std::string(pick(names)) + (rng() % 2 ? " = " : " += ");
+                expression(3 + extra_depth);
+                out += ";\n";
+                break;
+            case 2:
+                out += "print(";
+                expression(2);
+                out += ", \"value\");\n";
+                break;
+            case 3:
+                out += "if (";
+                expression(2);
+                out += ") ";
+                block(level, depth);
+                if (rng() % 2) {
+                    out += " else ";
+                    block(level, depth);
+                }
+                out += '\n';
+                break;
+            case 4:
+                out += "while (";
+                expression(2);
+                out += ") ";
+                block(level, depth);
+                out += '\n';
+                break;
+            case 5:
+                out += "for (int i = 0; i < ";
+                expression(1);
+                out += "; i++) ";
+                block(level, depth);
+                out += '\n';
+                break;
+            default:
+                out += 'f' + std::to_string(rng() % 1000) + '(';
+                expression(2);
+                out += ", ";
+                expression(1);
+                out += ");\n";
+                break;
+        }
+    }
+
+    void expression(int depth) {
+        if (depth == 0 || rng() % 4 == 0) {
+            switch (rng() % 5) {
+                case 0: out += std::to_string(rng() % 1000); break;
+                case 1: out += std::to_string(rng() % 100) + '.' + std::to_string(rng() % 100); break;
+                case 2: out += std::string("arr[") + pick(names) + ']'; break;
+                default: out += pick(names); break;
+            }
+            return;
+        }
+        switch (rng() % 6) {
+            case 0:
+                out += '(';
+                expression(depth - 1);
+                out += ')';
+                break;
+            case 1:
+                out += "-(";
+                expression(depth - 1);
+                out += ')';
+                break;
+            case 2:
+                out += 'f' + std::to_string(rng() % 1000) + '(';
+                expression(depth - 1);
+                out += ')';
+                break;
+            default:
+                expression(depth - 1);
+                out += ' ';
+                out += pick(ops);
+                out += ' ';
+                expression(depth - 1);
+                break;
+        }
+    }
+};
+
+inline std::string generate_program(std::size_t bytes, unsigned seed = 1, int extra_depth = 0) {
+    return ProgramWriter(seed, extra_depth).generate(bytes);
+}
+
+// Глобальные массивы с большими инициализаторами (таблицы): целые, вещественные и строки.
+// distinct > 0 - значения берутся из distinct различных (повторяющиеся табличные значения), 0 - случайные
+inline std::string generate_arrays(std::size_t bytes, unsigned distinct = 0, unsigned seed = 1) {
+    std::mt19937 rng(seed);
+    std::string out;
+    out.reserve(bytes + 4096);
+    char buffer[64];
+    auto pick = [&] { return distinct ? rng() % distinct : rng(); };
+    for (unsigned n = 0; out.size() < bytes; ++n) {
+        unsigned kind = rng() % 8;
+        const char* type = kind < 5 ? "int" : kind < 7 ? "double" : "char";
+        out += std::string(type) + " table" + std::to_string(n) + "[1024] = {";
+        for (unsigned i = 0; i < 1024; ++i) {
+            if (i) out += (i % 16 == 0) ? ",\n    " : ", ";
+            unsigned value = pick();
+            if (kind < 5) std::snprintf(buffer, sizeof buffer, "%u", value % 100000);
+            else if (kind < 7) std::snprintf(buffer, sizeof buffer, "%u.%02u", value % 1000, value / 1000 % 100);
+            else std::snprintf(buffer, sizeof buffer, "\"item%u\"", value % 100000);
+            out += buffer;
+        }
+        out += "};\n\n";
+    }
+    return out;
+}
+
+// Машинно развёрнутые циклы: одни и те же индексные выражения и коэффициенты повторяются
+// в каждой копии тела (unroll - копий на итерацию)
+inline std::string generate_unrolled(std::size_t bytes, unsigned unroll = 8, unsigned seed = 1) {
+    std::mt19937 rng(seed);
+    std::string out = "int a[4096];\nint b[4096];\nint c[4096];\nint k[16];\n\n";
+    out.reserve(bytes + 4096);
+    for (unsigned n = 0; out.size() < bytes; ++n) {
+        out += "int kernel" + std::to_string(n) + "(int n) {\n    int i = 0;\n    while (i < n) {\n";
+        unsigned shift = rng() % 4;
+        for (unsigned u = 0; u < unroll; ++u) {
+            std::string at = "[i + " + std::to_string(u) + "]";
+            out += "        c" + at + " = a" + at + " * k[" + std::to_string(shift) + "] + b" + at + " * k[" +
+                   std::to_string(shift + 1) + "] + (a" + at + " - b" + at + ") / 2;\n";
+            out += "        if (c" + at + " > k[15]) c" + at + " = k[15] - (a" + at + " - b" + at + ") / 2;\n";
+        }
+        out += "        i = i + " + std::to_string(unroll) + ";\n    }\n    return c[0];\n}\n\n";
+    }
+    return out;
+}
+
+// Программа без семантических ошибок для проверки анализатором: globals глобальных переменных и функции
+// с блоками вложенностью depth. В каждом блоке x заново объявляется поверх внешнего (затенение),
+// есть циклы и вызовы уже объявленных функций - на каждый блок вход и выход из области и поиск имён.
+// Глобальные разных целых типов, поэтому в выражениях есть неявные преобразования
+inline std::string generate_checked_program(std::size_t bytes, unsigned globals = 256, unsigned depth = 4,
+                                            unsigned seed = 1) {
+    std::mt19937 rng(seed);
+    if (globals == 0) globals = 1;
+    std::string out;
+    out.reserve(bytes + 4096);
+    static const char* const types[] = {"int", "long", "int", "short"};
+    for (unsigned g = 0; g < globals; ++g) {
+        out += std::string(types[g % 4]) + " g" + std::to_string(g) + " = " + std::to_string(g) + ";\n";
+    }
+    out += "\n";
+    auto global = [&] { return "g" + std::to_string(rng() % globals); };
+    for (unsigned n = 0; out.size() < bytes; ++n) {
+        out += "int f" + std::to_string(n) + "(int a) {\n    int x = a + " + global() + ";\n";
+        for (unsigned d = 1; d <= depth; ++d) {
+            std::string pad(4 * d, ' ');
+            out += pad + "{\n";
+            out += pad + "    int x = x * 2 + " + global() + ";\n";
+            out += pad + "    while (x > " + global() + ") {\n" + pad + "        x = x - a;\n" + pad + "    }\n";
+            out += pad + "    for (int i = 0; i < 4; i++) {\n" + pad + "        x = x + i;\n" + pad + "    }\n";
+            if (n > 0) out += pad + "    x = x + f" + std::to_string(rng() % n) + "(x + " + global() + ");\n";
+        }
+        for (unsigned d = depth; d >= 1; --d) out += std::string(4 * d, ' ') + "}\n";
+        out += "    return x;\n}\n\n";
+    }
+    out += "int main() {\n    return f0(1);\n}\n";
+    return out;
+}
+
+inline std::string generate_corpus(std::size_t bytes, Mix mix, unsigned seed = 1) {
+    switch (mix) {
+        case Mix::Identifiers: return generate_identifiers(bytes, seed);
+        case Mix::Numbers: return generate_numbers(bytes, seed);
+        case Mix::Comments: return generate_comments(bytes, seed);
+        case Mix::Strings: return generate_strings(bytes, seed);
+        default: return generate_source(bytes, seed);
+    }
+}
+
+} // namespace bench
@@ -0,0 +1,136 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Арена с выделением "сдвигом указателя": объекты размещаются подряд в больших блоках
+// и освобождаются все сразу вместе с ареной. Деструкторы нетривиальных объектов
+// вызываются при уничтожении арены в порядке, обратном созданию. Тип, чей деструктор
+// нетривиален только формально (виртуальный, а полей-владельцев нет), объявляет
+// static constexpr bool arena_skip_destructor = true и обходится без записи деструктора
+class Arena {
+public:
+    static constexpr std::size_t block_size = 64 << 10;
+
+    Arena() = default;
+    ~Arena() { destroy(); }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    template <typename T, typename... Args>
+    T* make(Args&&... args) {
+        T* object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if constexpr (needs_cleanup<T>()) {
+            void* memory = allocate(sizeof(Cleanup), alignof(Cleanup));
+            cleanups = new (memory) Cleanup{[](void* p) { static_cast<T*>(p)->~T(); }, object, cleanups};
+            if (!last_cleanup) last_cleanup = cleanups;
+        }
+        ++object_count;
+        return object;
+    }
+
+    void* allocate(std::size_t size, std::size_t align) {
+        std::size_t offset = (used + align - 1) & ~(align - 1);
+        if (offset + size > capacity) {
+            grow(size + align);
+            offset = (used + align - 1) & ~(align - 1);
+        }
+        used_bytes += offset + size - used;
+        used = offset + size;
+        return current + offset;
+    }
+
+    // Уничтожить все объекты; первый блок остаётся для повторного использования
+    void reset() {
+        destroy();
+        if (blocks.size() > 1) blocks.resize(1);
+        current = blocks.empty() ? nullptr : blocks.front().data.get();
+        capacity = blocks.empty() ? 0 : blocks.front().size;
+        used = 0;
+        object_count = 0;
+        used_bytes = 0;
+        reserved_bytes = capacity;
+    }
+
+    // Забрать блоки и объекты другой арены: они уничтожаются вместе с этой, other остаётся пустой
+    void absorb(Arena& other) {
+        for (auto& block : other.blocks) blocks.push_back(std::move(block));
+        if (other.cleanups) {
+            other.last_cleanup->next = cleanups;
+            cleanups = other.cleanups;
+            if (!last_cleanup) last_cleanup = other.last_cleanup;
+        }
+        object_count += other.object_count;
+        used_bytes += other.used_bytes;
+        reserved_bytes += other.reserved_bytes;
+
+        other.blocks.clear();
+        other.current = nullptr;
+        other.used = 0;
+        other.capacity = 0;
+        other.cleanups = nullptr;
+        other.last_cleanup = nullptr;
+        other.object_count = 0;
+        other.used_bytes = 0;
+        other.reserved_bytes = 0;
+    }
+
+    // Статистика: созданные объекты, занятые байты (с выравниванием и записями деструкторов), байты блоков
+    std::size_t objects() const { return object_count; }
+    std::size_t bytes_used() const { return used_bytes; }
+    std::size_t bytes_reserved() const { return reserved_bytes; }
+
+private:
+    template <typename T, typename = void>
+    struct skips_destructor : std::false_type {};
+    template <typename T>
+    struct skips_destructor<T, std::void_t<decltype(T::arena_skip_destructor)>>
+        : std::bool_constant<T::arena_skip_destructor> {};
+
+    template <typename T>
+    static constexpr bool needs_cleanup() {
+        return !std::is_trivially_destructible_v<T> && !skips_destructor<T>::value;
+    }
+
+    struct Cleanup {
+        void (*destroy)(void*);
+        void* object;
+        Cleanup* next;
+    };
+
+    struct Block {
+        std::unique_ptr<char[]> data;
+        std::size_t size;
+    };
+
+    std::vector<Block> blocks;
+    char* current = nullptr;
+    std::size_t used = 0;
+    std::size_t capacity = 0;
+    Cleanup* cleanups = nullptr;
+    Cleanup* last_cleanup = nullptr;    // самая старая запись, для absorb
+
+    std::size_t object_count = 0;
+    std::size_t used_bytes = 0;
+    std::size_t reserved_bytes = 0;
+
+    void destroy() {
+        for (Cleanup* cleanup = cleanups; cleanup; cleanup = cleanup->next) cleanup->destroy(cleanup->object);
+        cleanups = nullptr;
+        last_cleanup = nullptr;
+    }
+
+    // Новый блок; new char[] выравнивает на alignof(max_align_t), этого хватает узлам AST
+    void grow(std::size_t at_least) {
+        capacity = std::max(block_size, at_least);
+        blocks.push_back({std::unique_ptr<char[]>(new char[capacity]), capacity});  // без обнуления, в отличие от make_unique
+        current = blocks.back().data.get();
+        used = 0;
+        reserved_bytes += capacity;
+    }
+};
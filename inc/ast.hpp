@@ -1,61 +1,119 @@
 #pragma once
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <set>
 #include <string>
+#include <type_traits>
 #include <variant>
 
 #include "token.hpp"
+#include "symbol.hpp"
 #include "types.hpp"
 #include "modifiers.hpp"
+#include "arena.hpp"
+#include "constant_pool.hpp"
 
 struct ASTVisitor;
 
+// Вид узла: по одному на класс узла AST, плюс None на месте пустого ребра и Variable/ArrayVariable
+// для переменных VarDecl в плоской форме (FlatAST). Cast - неявное преобразование, его вставляет
+// семантический анализ, парсер не создаёт
+enum class NodeKind : std::uint8_t {
+    None,
+    Literal, Id, Binary, Logical, Assign, Unary, Postfix, Sizeof, Ternary,
+    Call, MemberAccess, ArrayAccess, ArrayInit,
+    ExprStmt, Block, If, While, For, Return, Break, Continue, Print, Read, Exit,
+    Variable, ArrayVariable,
+    VarDecl, StructDecl, FunctionDecl, AssertDecl, TypedefDecl,
+    TranslationUnit,
+    Cast,
+};
+
+// Узлы AST размещаются в арене корня (TranslationUnitNode::arena) и живут, пока жив корень.
+// Рёбра дерева - невладеющие указатели. Каждый узел хранит свой вид: по нему dispatch и StaticVisitor
+// (visitor.hpp) выбирают класс без виртуального вызова, а node_cast проверяет класс без RTTI
 
 struct ASTNode {
+    NodeKind kind;
+    // Общий узел hash-consing (Parser::set_hash_consing): выражение без побочных эффектов,
+    // у которого может быть несколько родителей. Такие узлы нельзя менять на месте; исключение -
+    // результаты анализа, зависящие только от самого выражения (тип, преобразования операндов)
+    bool shared = false;
+    explicit ASTNode(NodeKind kind) : kind(kind) {}
     virtual ~ASTNode() = default;
     virtual void accept(ASTVisitor& visitor) = 0; // Метод для посещения узла
 };
 
-typedef std::shared_ptr<ASTNode> ASTNodePtr;
+typedef ASTNode* ASTNodePtr;
 
 struct Expr : ASTNode {
+    // Тип значения (TypeContext::type), его записывает семантический анализ; 0 - не проверялось
+    // (и у имени вызываемой функции и поля структуры). Лежит в выравнивании после kind и shared
+    TypeId type_id = 0;
+    explicit Expr(NodeKind kind) : ASTNode(kind) {}
     virtual ~Expr() = default;
     void accept(ASTVisitor& visitor) override = 0; // Метод для посещения выражения
 };
-typedef std::shared_ptr<Expr> ExprPtr;
+typedef Expr* ExprPtr;
 
 struct Stmt : ASTNode {
+    explicit Stmt(NodeKind kind) : ASTNode(kind) {}
     virtual ~Stmt() = default;
     void accept(ASTVisitor& visitor) override = 0; // Метод для посещения инструкции
 };
-typedef std::shared_ptr<Stmt> StmtPtr;
+typedef Stmt* StmtPtr;
 
 struct Decl : ASTNode {
+    explicit Decl(NodeKind kind) : ASTNode(kind) {}
     virtual ~Decl() = default;
     void accept(ASTVisitor& visitor) override = 0; // Метод для посещения объявления
 };
-typedef std::shared_ptr<Decl> DeclPtr;
+typedef Decl* DeclPtr;
 
 // Литеральное выражение
+// Значение хранится в пуле констант единицы трансляции, узел - только ссылка на него
 struct LiteralExpr : Expr {
-    std::variant<bool, char, short, int, long, float, double, long double, std::string> value;
-    explicit LiteralExpr(std::variant<bool, char, short, int, long, float, double, long double, std::string> val) : value(val) {}
+    using Value = ConstantPool::Value;
+    static constexpr NodeKind node_kind = NodeKind::Literal;
+    static constexpr bool arena_skip_destructor = true;   // ничем не владеет
+    // Ссылка Constant по частям: вид и индекс ложатся в хвост ASTNode за kind и shared, узел - 24 байта
+    std::uint8_t type;
+    std::uint32_t index;
+    const ConstantPool* pool;
+    LiteralExpr(const ConstantPool& pool, Constant constant) :
+        Expr(node_kind), type(constant.type), index(constant.index), pool(&pool) {}
+    Constant constant() const { return {index, type}; }
+    Value value() const { return pool->get(constant()); }
     void accept(ASTVisitor& visitor) override;
 };
 
+// Что означает имя после привязки (Binder): переменная и где она лежит или функция.
+// Unresolved - привязка не выполнялась или имя не объявлено
+enum class BindingKind : std::uint8_t { Unresolved, Global, Param, Local, Function };
+
+// Global - номер глобальной переменной, Param и Local - ячейка кадра функции (параметры первыми),
+// Function - номер функции в порядке первого объявления
+struct Binding {
+    BindingKind kind = BindingKind::Unresolved;
+    std::uint32_t slot = 0;
+};
+
 // Выражение переменной
 struct IdExpr : Expr {
-    std::string name;
-    explicit IdExpr(const std::string& n) : name(n) {}
+    static constexpr NodeKind node_kind = NodeKind::Id;
+    Symbol name;
+    Binding binding;
+    explicit IdExpr(Symbol n) : Expr(node_kind), name(n) {}
     void accept(ASTVisitor& visitor) override;
 };
 
 // Унарное выражение
 struct UnaryExpr : Expr {
+    static constexpr NodeKind node_kind = NodeKind::Unary;
     std::string op;
     ExprPtr operand;
-    UnaryExpr(const std::string& op, ExprPtr operand) : op(op), operand(std::move(operand)) {}
+    UnaryExpr(const std::string& op, ExprPtr operand, NodeKind kind = node_kind) : Expr(kind), op(op), operand(std::move(operand)) {}
     void accept(ASTVisitor& visitor) override;
 
     ~UnaryExpr() = default;
@@ -64,7 +122,8 @@ struct UnaryExpr : Expr {
 
 // Постфиксное выражение
 struct PostfixExpr : UnaryExpr {
-    PostfixExpr(ExprPtr e, const std::string& o) : UnaryExpr(op, operand) {}
+    static constexpr NodeKind node_kind = NodeKind::Postfix;
+    PostfixExpr(ExprPtr e, const std::string& o) : UnaryExpr(o, std::move(e), node_kind) {}
     void accept(ASTVisitor& visitor) override;
 };
 
@@ -73,27 +132,32 @@ struct BinaryExpr : Expr {
     std::string op;
     ExprPtr left;
     ExprPtr right;
-    BinaryExpr(const std::string& o, ExprPtr l, ExprPtr r) : op(o), left(std::move(l)), right(std::move(r)) {}
+    static constexpr NodeKind node_kind = NodeKind::Binary;
+    BinaryExpr(const std::string& o, ExprPtr l, ExprPtr r, NodeKind kind = node_kind) :
+        Expr(kind), op(o), left(std::move(l)), right(std::move(r)) {}
     void accept(ASTVisitor& visitor) override;
 };
 
 // Выражение присваивания
 struct AssignExpr : BinaryExpr {
-    AssignExpr(const std::string& o, ExprPtr l, ExprPtr r) : BinaryExpr(o , l, r) {}
+    static constexpr NodeKind node_kind = NodeKind::Assign;
+    AssignExpr(const std::string& o, ExprPtr l, ExprPtr r) : BinaryExpr(o , l, r, node_kind) {}
     void accept(ASTVisitor& visitor) override;
 };
 
 // Логическое выражение
 struct LogicalExpr : BinaryExpr {
-    LogicalExpr(const std::string& o, ExprPtr l, ExprPtr r) : BinaryExpr(o, l, r) {}
+    static constexpr NodeKind node_kind = NodeKind::Logical;
+    LogicalExpr(const std::string& o, ExprPtr l, ExprPtr r) : BinaryExpr(o, l, r, node_kind) {}
     void accept(ASTVisitor& visitor) override;
 };
 
 typedef std::shared_ptr<Type> TypePtr;
 
 struct SizeofExpr : UnaryExpr {
+    static constexpr NodeKind node_kind = NodeKind::Sizeof;
     std::variant<TypePtr, ExprPtr> type;
-    SizeofExpr(ExprPtr operand, std::variant<TypePtr, ExprPtr> type) : UnaryExpr("sizeof", operand), type(type) {}
+    SizeofExpr(ExprPtr operand, std::variant<TypePtr, ExprPtr> type) : UnaryExpr("sizeof", operand, node_kind), type(type) {}
     void accept(ASTVisitor& visitor) override;
 };
 
@@ -102,7 +166,8 @@ struct TernaryExpr : Expr {
     ExprPtr cond;
     ExprPtr true_expr;
     ExprPtr false_expr;
-    TernaryExpr(ExprPtr c, ExprPtr t, ExprPtr f) : cond(std::move(c)), true_expr(std::move(t)), false_expr(std::move(f)) {}
+    static constexpr NodeKind node_kind = NodeKind::Ternary;
+    TernaryExpr(ExprPtr c, ExprPtr t, ExprPtr f) : Expr(node_kind), cond(std::move(c)), true_expr(std::move(t)), false_expr(std::move(f)) {}
     void accept(ASTVisitor& visitor) override;
 };
 
@@ -110,7 +175,8 @@ struct TernaryExpr : Expr {
 struct CallExpr : Expr {
     ExprPtr callee;
     std::vector<ExprPtr> args;
-    explicit CallExpr(ExprPtr name, std::vector<ExprPtr> args) : callee(name), args(args) {}
+    static constexpr NodeKind node_kind = NodeKind::Call;
+    explicit CallExpr(ExprPtr name, std::vector<ExprPtr> args) : Expr(node_kind), callee(name), args(args) {}
     void accept(ASTVisitor& visitor) override;
 };
 
@@ -118,7 +184,8 @@ struct CallExpr : Expr {
 struct MemberAccessExpr : Expr {
     ExprPtr object;
     ExprPtr member;
-    MemberAccessExpr(ExprPtr obj, ExprPtr mem) : object(std::move(obj)), member(std::move(mem)) {}
+    static constexpr NodeKind node_kind = NodeKind::MemberAccess;
+    MemberAccessExpr(ExprPtr obj, ExprPtr mem) : Expr(node_kind), object(std::move(obj)), member(std::move(mem)) {}
     void accept(ASTVisitor& visitor) override;
 };
 
@@ -126,7 +193,8 @@ struct MemberAccessExpr : Expr {
 struct ArrayAccessExpr : Expr {
     ExprPtr array;
     ExprPtr index;
-    ArrayAccessExpr(ExprPtr arr, ExprPtr idx) : array(std::move(arr)), index(std::move(idx)) {}
+    static constexpr NodeKind node_kind = NodeKind::ArrayAccess;
+    ArrayAccessExpr(ExprPtr arr, ExprPtr idx) : Expr(node_kind), array(std::move(arr)), index(std::move(idx)) {}
     void accept(ASTVisitor& visitor) override;
 };
 
@@ -134,27 +202,32 @@ struct ArrayAccessExpr : Expr {
 struct CastExpr : Expr {
     TypePtr type;
     ExprPtr operand;
-    CastExpr(TypePtr t, ExprPtr o) : type(t), operand(std::move(o)) {}
+    static constexpr NodeKind node_kind = NodeKind::Cast;
+    CastExpr(TypePtr t, ExprPtr o) : Expr(node_kind), type(t), operand(std::move(o)) {}
     void accept(ASTVisitor& visitor) override;
 };
 
 // Инициализация массива
 struct ArrayInitExpr : Expr {
     std::vector<ExprPtr> elements;
-    ArrayInitExpr(std::vector<ExprPtr> elems) : elements(std::move(elems)) {}
+    static constexpr NodeKind node_kind = NodeKind::ArrayInit;
+    ArrayInitExpr(std::vector<ExprPtr> elems) : Expr(node_kind), elements(std::move(elems)) {}
     void accept(ASTVisitor& visitor) override;
 };
 
 // Инструкция-выражение
 struct ExprStmt : Stmt {
     ASTNodePtr expr; 
-    explicit ExprStmt(ASTNodePtr e) : expr(std::move(e)) {}
+    static constexpr NodeKind node_kind = NodeKind::ExprStmt;
+    explicit ExprStmt(ASTNodePtr e) : Stmt(node_kind), expr(std::move(e)) {}
     void accept(ASTVisitor& visitor) override;
 };
 
 // Блок инструкций
 struct BlockStmt : Stmt {
+    static constexpr NodeKind node_kind = NodeKind::Block;
     std::vector<StmtPtr> statements;
+    BlockStmt() : Stmt(node_kind) {}
     void accept(ASTVisitor& visitor) override;
 };
 
@@ -163,7 +236,8 @@ struct IfStmt : Stmt {
     ExprPtr condition;
     StmtPtr then_branch;
     StmtPtr else_branch;
-    IfStmt(ExprPtr cond, StmtPtr then_b, StmtPtr else_b = nullptr) : condition(std::move(cond)), then_branch(std::move(then_b)), else_branch(std::move(else_b)) {}
+    static constexpr NodeKind node_kind = NodeKind::If;
+    IfStmt(ExprPtr cond, StmtPtr then_b, StmtPtr else_b = nullptr) : Stmt(node_kind), condition(std::move(cond)), then_branch(std::move(then_b)), else_branch(std::move(else_b)) {}
     void accept(ASTVisitor& visitor) override;
 };
 
@@ -171,7 +245,8 @@ struct IfStmt : Stmt {
 struct WhileStmt : Stmt {
     ExprPtr condition;
     StmtPtr body;
-    WhileStmt(ExprPtr cond, StmtPtr b) : condition(std::move(cond)), body(std::move(b)) {}
+    static constexpr NodeKind node_kind = NodeKind::While;
+    WhileStmt(ExprPtr cond, StmtPtr b) : Stmt(node_kind), condition(std::move(cond)), body(std::move(b)) {}
     void accept(ASTVisitor& visitor) override;
 };
 
@@ -181,55 +256,65 @@ struct ForStmt : Stmt {
     ExprPtr condition;
     ExprPtr increment;
     StmtPtr body;
-    ForStmt(DeclPtr i, ExprPtr cond, ExprPtr inc, StmtPtr b) : init(std::move(i)), condition(std::move(cond)), increment(std::move(inc)), body(std::move(b)) {}
+    static constexpr NodeKind node_kind = NodeKind::For;
+    ForStmt(DeclPtr i, ExprPtr cond, ExprPtr inc, StmtPtr b) : Stmt(node_kind), init(std::move(i)), condition(std::move(cond)), increment(std::move(inc)), body(std::move(b)) {}
     void accept(ASTVisitor& visitor) override;
 };
 
 // Инструкция возврата
 struct ReturnStmt : Stmt {
     ExprPtr expr;
-    ReturnStmt(ExprPtr e = nullptr) : expr(std::move(e)) {}
+    static constexpr NodeKind node_kind = NodeKind::Return;
+    ReturnStmt(ExprPtr e = nullptr) : Stmt(node_kind), expr(std::move(e)) {}
     void accept(ASTVisitor& visitor) override;
 };
 
 // Инструкция break
 struct BreakStmt : Stmt {
+    static constexpr NodeKind node_kind = NodeKind::Break;
+    BreakStmt() : Stmt(node_kind) {}
     void accept(ASTVisitor& visitor) override;
 };
 
 // Инструкция continue
 struct ContinueStmt : Stmt {
+    static constexpr NodeKind node_kind = NodeKind::Continue;
+    ContinueStmt() : Stmt(node_kind) {}
     void accept(ASTVisitor& visitor) override;
 };
 
 // Инструкция вывода
 struct PrintStmt : Stmt {
     std::vector<ExprPtr> expr;
-    PrintStmt(const std::vector<ExprPtr>& e) : expr(std::move(e)) {}
+    static constexpr NodeKind node_kind = NodeKind::Print;
+    PrintStmt(const std::vector<ExprPtr>& e) : Stmt(node_kind), expr(std::move(e)) {}
     void accept(ASTVisitor& visitor) override;
 };
 
 // Инструкция ввода
 struct ReadStmt : Stmt {
     ExprPtr expr;
-    ReadStmt(ExprPtr name) : expr(std::move(name)) {}
+    static constexpr NodeKind node_kind = NodeKind::Read;
+    ReadStmt(ExprPtr name) : Stmt(node_kind), expr(std::move(name)) {}
     void accept(ASTVisitor& visitor) override;
 };
 
 // Инструкция выхода
 struct ExitStmt : Stmt {
     ExprPtr expr;
-    ExitStmt(ExprPtr e) : expr(std::move(e)) {}
+    static constexpr NodeKind node_kind = NodeKind::Exit;
+    ExitStmt(ExprPtr e) : Stmt(node_kind), expr(std::move(e)) {}
     void accept(ASTVisitor& visitor) override;
 };
 
 struct Variable {
-    std::string name;       
+    Symbol name;
     ExprPtr init;           
     ExprPtr size;           
     bool is_array;
+    Binding binding;        // ячейка самой переменной (Binder)
 
-    Variable(const std::string& name, ExprPtr init = nullptr, ExprPtr size = nullptr, bool is_array = false) :
+    Variable(Symbol name, ExprPtr init = nullptr, ExprPtr size = nullptr, bool is_array = false) :
         name(name), init(std::move(init)), size(std::move(size)), is_array(is_array) {}
 };
 
@@ -238,8 +323,9 @@ struct VarDecl : Decl {
     TypePtr type;
     std::vector<Variable> variables; // name, init, size
     Modifiers modifiers;
+    static constexpr NodeKind node_kind = NodeKind::VarDecl;
     VarDecl(const TypePtr type, std::vector<Variable> variables, const Modifiers& mods) : 
-        type(type), variables(std::move(variables)), modifiers(mods) {}
+        Decl(node_kind), type(type), variables(std::move(variables)), modifiers(mods) {}
     void accept(ASTVisitor& visitor) override;
 };
 
@@ -247,31 +333,54 @@ struct VarDecl : Decl {
 struct TypedefDecl : Decl {
     Modifiers original_modifiers;
     TypePtr original_type;
-    std::string alias_name;     //псевдоним
+    Symbol alias_name;     //псевдоним
 
-    TypedefDecl(const Modifiers& orig_mods, const TypePtr& orig_types, const std::string& alias) :
-        original_modifiers(orig_mods), original_type(orig_types), alias_name(alias) {}
+    static constexpr NodeKind node_kind = NodeKind::TypedefDecl;
+    TypedefDecl(const Modifiers& orig_mods, const TypePtr& orig_types, Symbol alias) :
+        Decl(node_kind), original_modifiers(orig_mods), original_type(orig_types), alias_name(alias) {}
 
     void accept(ASTVisitor& visitor) override;
 };
 
 // Декларация структуры
 struct StructDecl : Decl {
-    std::string name;
+    Symbol name;
     std::vector<VarDecl> fields;    // мб Decl
-    StructDecl(const std::string& n, const std::vector<VarDecl>& f) : name(n), fields(f) {}
+    static constexpr NodeKind node_kind = NodeKind::StructDecl;
+    StructDecl(Symbol n, const std::vector<VarDecl>& f) : Decl(node_kind), name(n), fields(f) {}
     void accept(ASTVisitor& visitor) override;
 };
 
+// Тело функции, разбор которого отложен до первого обращения (ленивый режим парсера)
+struct DeferredBody {
+    virtual ~DeferredBody() = default;
+    virtual BlockStmt* parse() = 0;
+    // Узлы прежней арены перешли в arena (Arena::absorb): тело разбирается уже туда
+    virtual void move_to(Arena& arena) = 0;
+};
+
 // Декларация функции
 struct FunctionDecl : Decl {
+    static constexpr NodeKind node_kind = NodeKind::FunctionDecl;
     Modifiers return_mods;
     TypePtr return_type;    // enum и строка
-    std::string name;
-    std::vector<std::pair<std::pair<Modifiers, TypePtr>, std::string>> params;    // param_decl
-    std::shared_ptr<BlockStmt> body;
-    FunctionDecl(const TypePtr rt, const std::string& n, const std::vector<std::pair<std::pair<Modifiers, TypePtr>, std::string>>& p, std::shared_ptr<BlockStmt> b = nullptr) : 
-        return_type(rt), name(n), params(p), body(std::move(b)) {}
+    Symbol name;
+    std::vector<std::pair<std::pair<Modifiers, TypePtr>, Symbol>> params;    // param_decl
+    BlockStmt* body;
+    DeferredBody* deferred = nullptr;   // ещё не разобранное тело; узел арены, как и body
+    std::uint32_t frame_size = 0;       // ячеек кадра: параметры и локальные (Binder)
+    FunctionDecl(const Modifiers& rm, const TypePtr rt, Symbol n, const std::vector<std::pair<std::pair<Modifiers, TypePtr>, Symbol>>& p, BlockStmt* b = nullptr) : 
+        Decl(node_kind), return_mods(rm), return_type(rt), name(n), params(p), body(b) {}
+    FunctionDecl(const Modifiers& rm, const TypePtr rt, Symbol n, const std::vector<std::pair<std::pair<Modifiers, TypePtr>, Symbol>>& p, DeferredBody* d) : 
+        Decl(node_kind), return_mods(rm), return_type(rt), name(n), params(p), body(nullptr), deferred(d) {}
+    // Тело функции (nullptr у прототипа); отложенное тело разбирается при первом обращении
+    BlockStmt* get_body() {
+        if (deferred) {
+            body = deferred->parse();
+            deferred = nullptr;
+        }
+        return body;
+    }
     void accept(ASTVisitor& visitor) override;
 };
 
@@ -279,16 +388,43 @@ struct FunctionDecl : Decl {
 struct AssertDecl : Decl {
     ExprPtr expr;       
     std::string message; 
-    AssertDecl(ExprPtr e, std::string m) : expr(std::move(e)), message(m) {}
+    static constexpr NodeKind node_kind = NodeKind::AssertDecl;
+    AssertDecl(ExprPtr e, std::string m) : Decl(node_kind), expr(std::move(e)), message(m) {}
     void accept(ASTVisitor& visitor) override;
 };
 
 // Узел корня AST
 struct TranslationUnitNode : ASTNode {
+    Arena arena;    // владеет всеми узлами дерева
+    // Пул литералов; лежит в арене, поэтому пулы частей, собранных через Arena::absorb, живут вместе с деревом
+    ConstantPool* constants = arena.make<ConstantPool>();
     std::vector<DeclPtr> decls; 
-    TranslationUnitNode() = default;
-    TranslationUnitNode(std::vector<DeclPtr> decls) : decls(std::move(decls)) {}
+    static constexpr NodeKind node_kind = NodeKind::TranslationUnit;
+    TranslationUnitNode() : ASTNode(node_kind) {}
+    TranslationUnitNode(std::vector<DeclPtr> decls) : ASTNode(node_kind), decls(std::move(decls)) {}
+    // Удалить все узлы и начать с пустого пула (первый блок арены остаётся)
+    void clear() {
+        decls.clear();
+        arena.reset();
+        constants = arena.make<ConstantPool>();
+    }
     void accept(ASTVisitor& visitor) override;
 };
 
-
+// Узел вида kind - объект класса T или его наследника (замена dynamic_cast по виду узла)
+template <typename T>
+constexpr bool is_kind_of(NodeKind kind) {
+    if constexpr (std::is_same_v<T, ASTNode>) return kind != NodeKind::None;
+    else if constexpr (std::is_same_v<T, Expr>) return (kind >= NodeKind::Literal && kind <= NodeKind::ArrayInit) || kind == NodeKind::Cast;
+    else if constexpr (std::is_same_v<T, Stmt>) return kind >= NodeKind::ExprStmt && kind <= NodeKind::Exit;
+    else if constexpr (std::is_same_v<T, Decl>) return kind >= NodeKind::VarDecl && kind <= NodeKind::TypedefDecl;
+    else if constexpr (std::is_same_v<T, UnaryExpr>) return kind == NodeKind::Unary || kind == NodeKind::Postfix || kind == NodeKind::Sizeof;
+    else if constexpr (std::is_same_v<T, BinaryExpr>) return kind == NodeKind::Binary || kind == NodeKind::Logical || kind == NodeKind::Assign;
+    else return kind == T::node_kind;
+}
+
+// Приведение вниз с проверкой вида: nullptr, если node не T (или сам nullptr)
+template <typename T>
+T* node_cast(ASTNode* node) {
+    return node && is_kind_of<T>(node->kind) ? static_cast<T*>(node) : nullptr;
+}
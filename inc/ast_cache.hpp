@@ -0,0 +1,44 @@
+#pragma once
+#include "flat_ast.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Кэш разобранных программ на диске. Файл - двоичная форма FlatAST (узлы, боковые таблицы,
+// типы с модификаторами и полями структур, написания имён; после семантического анализа -
+// ещё типы выражений и вставленные им преобразования Cast) с заголовком: формат, версия
+// интерпретатора, хеш и размер исходника, размер и контрольная сумма данных. Имя файла -
+// хеш исходника вместе с версиями, поэтому другой исходник или новая версия интерпретатора
+// просто не находят старый файл. Загрузка отображает файл в память (SourceBuffer) и проверяет
+// заголовок, контрольную сумму и структуру дерева; любое несоответствие - промах, а не ошибка
+class AstCache {
+public:
+    // Менять при изменениях парсера, от которых зависит дерево
+    static constexpr std::string_view interpreter_version = "0.3";
+    static constexpr std::uint32_t format_version = 3;
+    // Заголовок: сигнатура, формат, платформа, ключ, размер исходника, размер данных, контрольная сумма данных
+    static constexpr std::size_t header_size = 48;
+
+    explicit AstCache(std::string directory);
+
+    // true - дерево для source загружено в flat; иначе причина промаха в miss_reason()
+    bool load(std::string_view source, FlatAST& flat);
+    // Записать через временный файл и rename, чтобы параллельные запуски не видели половину файла.
+    // Проверенное дерево (FlatAST::analyzed) заменяет прежнюю запись непроверенного. false - записать не удалось (кэш только ускоряет запуск, это не ошибка программы)
+    bool store(std::string_view source, const FlatAST& flat);
+
+    std::string path(std::string_view source) const;
+    const std::string& miss_reason() const { return reason; }
+
+    // Двоичная форма без обращения к диску; decode бросает std::runtime_error на повреждённых данных
+    static std::string encode(const FlatAST& flat, std::string_view source);
+    static FlatAST decode(std::string_view file, std::string_view source);
+
+    static std::uint64_t hash(std::string_view bytes, std::uint64_t seed = 0);
+
+private:
+    std::string directory;
+    std::string reason;
+
+    static std::uint64_t key(std::string_view source);
+};
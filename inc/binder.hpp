@@ -0,0 +1,71 @@
+#pragma once
+#include "ast.hpp"
+#include "scope.hpp"
+#include "visitor.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Объявление, закрывшее собой одноимённое из внешней области
+struct Shadowing {
+    Symbol name;
+    Symbol function;        // где объявлено внутреннее; у глобальных - недействительный символ
+    BindingKind inner;
+    BindingKind outer;
+
+    std::string message() const;
+};
+
+// Привязка имён один раз после разбора: каждому IdExpr - вид (глобальная, параметр, локальная,
+// функция) и номер ячейки, каждой переменной VarDecl - её ячейка, функции - размер кадра.
+// Дальнейшим проходам и исполнению хватает номера, поиск по имени больше не нужен.
+// Области видимости - как в SemanticVisitor: параметры в своей области, тело функции - блок,
+// у for - своя область, имя видно только после своего инициализатора. Ячейки локальных
+// переиспользуются после выхода из блока. Необъявленные имена остаются Unresolved - о них
+// сообщает семантический анализ. Общие узлы hash-consing привязываются одинаково: парсер
+// не делит идентификатор между объявлениями
+class Binder : public StaticVisitor<Binder> {
+public:
+    using StaticVisitor<Binder>::visit;
+
+    void bind(TranslationUnitNode& root) { walk(&root); }
+
+    const std::vector<Shadowing>& shadowings() const { return shadowed; }
+    std::uint32_t globals() const { return global_count; }
+    std::uint32_t functions() const { return function_count; }
+    std::size_t resolved() const { return resolved_count; }
+    std::size_t unresolved() const { return unresolved_count; }
+
+    void visit(IdExpr& expr);
+    void visit(CallExpr& expr);
+    void visit(MemberAccessExpr& expr);
+    void visit(BlockStmt& stmt);
+    void visit(ForStmt& stmt);
+    void visit(VarDecl& decl);
+    void visit(StructDecl&) {}
+    void visit(FunctionDecl& decl);
+
+private:
+    struct Mark {
+        std::size_t vars;
+        std::uint32_t next_slot;
+    };
+
+    ShadowTable<Binding> vars;
+    ShadowTable<Binding> funcs;
+    std::vector<Mark> marks;            // открытые области; глубина - их число
+
+    FunctionDecl* function = nullptr;   // текущая функция; nullptr - глобальная область
+    std::uint32_t next_slot = 0;        // первая свободная ячейка кадра текущей функции
+
+    std::uint32_t global_count = 0;
+    std::uint32_t function_count = 0;
+    std::size_t resolved_count = 0;
+    std::size_t unresolved_count = 0;
+    std::vector<Shadowing> shadowed;
+
+    std::uint32_t depth() const { return static_cast<std::uint32_t>(marks.size()); }
+    void enter() { marks.push_back({vars.size(), next_slot}); }
+    void exit();
+    Binding declare(Symbol name, BindingKind kind);
+};
@@ -0,0 +1,168 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// Номер альтернативы T в std::variant V
+template <typename T, typename V, std::size_t I = 0>
+constexpr std::size_t alternative_index() {
+    static_assert(I < std::variant_size_v<V>, "type is not an alternative");
+    if constexpr (std::is_same_v<std::variant_alternative_t<I, V>, T>) return I;
+    else return alternative_index<T, V, I + 1>();
+}
+
+// Ссылка на константу пула: вид значения (номер альтернативы ConstantPool::Value) и индекс в таблице этого вида
+struct Constant {
+    std::uint32_t index;
+    std::uint8_t type;
+
+    bool operator==(const Constant& other) const { return index == other.index && type == other.type; }
+    bool operator!=(const Constant& other) const { return !(*this == other); }
+};
+
+// Пул констант единицы трансляции. Значения одного вида лежат подряд в своей таблице
+// (int - по 4 байта, double - по 8, строки - std::string), каждое различное значение один раз:
+// повторный add возвращает прежнюю ссылку. Скаляры сравниваются по значению, но 0.0 и -0.0
+// различаются, а NaN не совпадает ни с чем; строки - по содержимому.
+// Поиск - открытая адресация по 32-битным ячейкам (вид и индекс), без копий значений
+class ConstantPool {
+public:
+    using Value = std::variant<bool, char, short, int, unsigned, long, unsigned long, float, double, long double, std::string>;
+
+    static constexpr std::size_t type_count = std::variant_size_v<Value>;
+    static constexpr std::uint32_t type_bits = 4;
+    static constexpr std::uint32_t max_index = (UINT32_MAX >> type_bits) - 1;  // последняя комбинация - пустая ячейка
+
+    // Упаковка ссылки в 32 бита (поле данных FlatAST) и обратно
+    static std::uint32_t pack(Constant constant) { return constant.index << type_bits | constant.type; }
+    static Constant unpack(std::uint32_t packed) {
+        return {packed >> type_bits, static_cast<std::uint8_t>(packed & ((1u << type_bits) - 1))};
+    }
+
+    Constant add(const Value& value) {
+        return dispatch<Constant>(value.index(), [&](auto type) { return add_typed<type>(std::get<type>(value)); });
+    }
+    template <typename T>
+    Constant add(const T& value) { return add_typed<alternative_index<T, Value>()>(value); }
+    // Строка без временного std::string, если такая уже есть в пуле
+    Constant add(std::string_view value) { return add_typed<alternative_index<std::string, Value>()>(value); }
+
+    Value get(Constant constant) const {
+        return dispatch<Value>(constant.type, [&](auto type) {
+            return Value(std::in_place_index<type>, std::get<type>(tables)[constant.index]);
+        });
+    }
+    // Ссылка принадлежит пулу: вид в допустимых пределах и индекс внутри таблицы
+    bool contains(Constant constant) const { return constant.type < type_count && constant.index < count(constant.type); }
+
+    std::size_t count(std::uint8_t type) const {
+        return dispatch<std::size_t>(type, [&](auto t) { return std::get<t>(tables).size(); });
+    }
+    std::size_t size() const { return filled; }    // различных констант
+
+    // Байты таблиц (со строками в куче) и индекса поиска
+    std::size_t bytes() const {
+        std::size_t total = slots.capacity() * sizeof(std::uint32_t);
+        std::apply([&](const auto&... table) { ((total += table_bytes(table)), ...); }, tables);
+        return total;
+    }
+
+private:
+    // bool хранится байтом: у std::vector<bool> нет ссылок на элементы
+    template <typename T>
+    using Stored = std::conditional_t<std::is_same_v<T, bool>, std::uint8_t, T>;
+
+    template <typename V>
+    struct TablesOf;
+    template <typename... Ts>
+    struct TablesOf<std::variant<Ts...>> {
+        using type = std::tuple<std::vector<Stored<Ts>>...>;
+    };
+
+    static constexpr std::uint32_t empty = UINT32_MAX;
+
+    typename TablesOf<Value>::type tables;
+    std::vector<std::uint32_t> slots;   // степень двойки, заполнено не больше половины
+    std::size_t filled = 0;
+
+    // f(std::integral_constant<std::size_t, type>) для вида, известного только во время выполнения
+    template <typename R, typename F, std::size_t I = 0>
+    static R dispatch(std::size_t type, F&& f) {
+        if constexpr (I == type_count) throw std::runtime_error("Bad constant type: " + std::to_string(type));
+        else if (type == I) return f(std::integral_constant<std::size_t, I>());
+        else return dispatch<R, F, I + 1>(type, std::forward<F>(f));
+    }
+
+    template <typename K>
+    static std::size_t hash(std::size_t type, const K& value) {
+        std::size_t h = std::hash<K>()(value) ^ (type * 0x9e3779b97f4a7c15ull);
+        h ^= h >> 29;
+        h *= 0xbf58476d1ce4e5b9ull;
+        return h ^ (h >> 32);
+    }
+
+    template <typename T, typename K>
+    static bool same(const T& a, const K& b) {
+        if constexpr (std::is_floating_point_v<T>) return a == b && std::signbit(a) == std::signbit(b);
+        else return a == b;
+    }
+
+    template <typename T>
+    static std::size_t table_bytes(const std::vector<T>& table) {
+        std::size_t total = table.capacity() * sizeof(T);
+        if constexpr (std::is_same_v<T, std::string>) {
+            for (const auto& s : table)
+                if (s.capacity() >= sizeof(std::string)) total += s.capacity() + 1;   // не поместилась в сам объект
+        }
+        return total;
+    }
+
+    // value - значение вида I или ключ, сравнимый с ним с тем же хешем (std::string_view для строк)
+    template <std::size_t I, typename K>
+    Constant add_typed(const K& value) {
+        if (2 * (filled + 1) > slots.size()) grow();
+        auto& table = std::get<I>(tables);
+        std::size_t mask = slots.size() - 1;
+        for (std::size_t s = hash(I, value) & mask;; s = (s + 1) & mask) {
+            if (slots[s] == empty) {
+                if (table.size() > max_index) throw std::runtime_error("Too many constants");
+                auto index = static_cast<std::uint32_t>(table.size());
+                table.emplace_back(value);
+                ++filled;
+                Constant constant{index, static_cast<std::uint8_t>(I)};
+                slots[s] = pack(constant);
+                return constant;
+            }
+            Constant found = unpack(slots[s]);
+            if (found.type == I && same(table[found.index], value)) return found;
+        }
+    }
+
+    void grow() {
+        std::vector<std::uint32_t> old(std::max<std::size_t>(16, slots.size() * 2), empty);
+        old.swap(slots);
+        std::size_t mask = slots.size() - 1;
+        for (std::uint32_t packed : old) {
+            if (packed == empty) continue;
+            Constant constant = unpack(packed);
+            std::size_t h = dispatch<std::size_t>(constant.type, [&](auto type) {
+                const auto& value = std::get<type>(tables)[constant.index];
+                if constexpr (type == 0) return hash(type, static_cast<bool>(value));
+                else return hash(type, value);
+            });
+            std::size_t s = h & mask;
+            while (slots[s] != empty) s = (s + 1) & mask;
+            slots[s] = packed;
+        }
+    }
+};
@@ -0,0 +1,89 @@
+#pragma once
+#include "ast.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Таблица hash-consing выражений (Parser::set_hash_consing): структурно одинаковые выражения без
+// побочных эффектов становятся одним общим узлом. Дети к моменту создания родителя уже общие, поэтому
+// ключ неглубокий: вид узла, его данные (оператор, имя, константа) и указатели детей.
+// У IdExpr в ключе ещё эпоха областей видимости: парсер меняет её, когда имя может начать означать
+// другое (объявление, конец блока), поэтому общий узел всюду ссылается на одно и то же.
+// Родители идентификаторов разных эпох различаются через детей. У остальных выражений в ключе
+// номер объявления верхнего уровня: общий узел не выходит за одно объявление.
+// Узлы в таблице принадлежат арене: при её сбросе таблицу нужно очистить.
+// Устроена как ConstantPool: записи подряд, поиск - открытая адресация по 32-битным номерам записей
+class ExprInterner {
+public:
+    struct Key {
+        NodeKind kind;
+        std::uint32_t data;         // тип токена оператора, id имени, ConstantPool::pack константы
+        std::uint32_t epoch;        // у IdExpr - эпоха областей видимости, у остальных - номер объявления
+        const Expr* children[3];
+
+        bool operator==(const Key& other) const {
+            return kind == other.kind && data == other.data && epoch == other.epoch &&
+                   children[0] == other.children[0] && children[1] == other.children[1] &&
+                   children[2] == other.children[2];
+        }
+    };
+
+    // Общий узел для ключа. nullptr - ключ новый: он уже добавлен, и в возвращённую ссылку
+    // нужно записать созданный узел до следующего обращения к таблице
+    Expr*& lookup(const Key& key) {
+        if (2 * (entries.size() + 1) > slots.size()) grow();
+        std::size_t mask = slots.size() - 1;
+        for (std::size_t s = hash(key) & mask;; s = (s + 1) & mask) {
+            if (slots[s] == empty) {
+                slots[s] = static_cast<std::uint32_t>(entries.size());
+                entries.push_back({key, nullptr});
+                return entries.back().node;
+            }
+            Entry& entry = entries[slots[s]];
+            if (entry.key == key) {
+                ++hit_count;
+                return entry.node;
+            }
+        }
+    }
+    void clear() {
+        entries.clear();
+        std::fill(slots.begin(), slots.end(), empty);
+    }
+
+    // Статистика: различных общих узлов и повторов, заменённых ссылкой на общий
+    std::size_t size() const { return entries.size(); }
+    std::size_t hits() const { return hit_count; }
+
+private:
+    struct Entry {
+        Key key;
+        Expr* node;
+    };
+
+    static constexpr std::uint32_t empty = UINT32_MAX;
+
+    std::vector<Entry> entries;
+    std::vector<std::uint32_t> slots;   // степень двойки, заполнено не больше половины
+    std::size_t hit_count = 0;
+
+    static std::size_t hash(const Key& key) {
+        std::size_t h = static_cast<std::size_t>(key.kind) * 0x9e3779b97f4a7c15ull;
+        auto mix = [&h](std::size_t value) { h = (h ^ value) * 0xbf58476d1ce4e5b9ull; h ^= h >> 31; };
+        mix(key.data);
+        mix(key.epoch);
+        for (auto child : key.children) mix(reinterpret_cast<std::uintptr_t>(child));
+        return h;
+    }
+
+    void grow() {
+        slots.assign(std::max<std::size_t>(16, slots.size() * 2), empty);
+        std::size_t mask = slots.size() - 1;
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            std::size_t s = hash(entries[i].key) & mask;
+            while (slots[s] != empty) s = (s + 1) & mask;
+            slots[s] = static_cast<std::uint32_t>(i);
+        }
+    }
+};
@@ -0,0 +1,177 @@
+#pragma once
+#include "ast.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Плоское представление AST: узлы лежат в параллельных массивах в прямом порядке обхода
+// (узел, затем поддеревья детей слева направо). У узла хранятся вид (NodeKind), конец поддерева
+// (индекс за последним потомком) и 32-битное поле данных; остальное - в боковых таблицах.
+// Первый ребёнок узла i - i + 1, следующий брат ребёнка c - end(c).
+//
+// Данные и дети по видам:
+//   Literal: ConstantPool::pack ссылки в literals   Id: id символа
+//   Binary, Logical, Assign: оператор; left, right
+//   Unary, Postfix: оператор; operand
+//   Sizeof: индекс в types или no_data; operand, выражение-тип (пустые - None)
+//   Cast: индекс целевого типа в types; operand
+//   Ternary: cond, true, false                 Call: callee, аргументы
+//   MemberAccess: object, member               ArrayAccess: array, index
+//   ArrayInit, Block, Print: элементы          ExprStmt, Return, Read, Exit: выражение
+//   If: cond, then, else                       While: cond, body
+//   For: init, cond, increment, body
+//   Variable, ArrayVariable: id имени; init, size
+//   VarDecl: индекс в var_types; переменные    StructDecl: id имени; поля (VarDecl)
+//   FunctionDecl: индекс в functions; тело     AssertDecl: индекс в messages; выражение
+//   TypedefDecl: индекс в typedefs             TranslationUnit (узел 0): объявления
+// Дерево после семантического анализа несёт ещё типы выражений (Expr::type_id) - по индексу
+// в types на узел (expr_types); у непроверенного дерева этот массив пуст.
+class FlatNode;
+
+// Посетитель плоской формы: FlatAST::accept передаёт ему корень, к детям он переходит сам
+// через FlatNode - без дерева указателей
+struct FlatVisitor {
+    virtual void visit(FlatNode node) = 0;
+    virtual ~FlatVisitor() = default;
+};
+
+class FlatAST {
+public:
+    static constexpr std::uint32_t no_data = UINT32_MAX;
+
+    struct VarType {
+        TypePtr type;
+        Modifiers modifiers;
+    };
+    struct Function {
+        Modifiers return_mods;
+        TypePtr return_type;
+        Symbol name;
+        std::vector<std::pair<std::pair<Modifiers, TypePtr>, Symbol>> params;
+    };
+    struct Typedef {
+        Modifiers modifiers;
+        TypePtr type;
+        Symbol alias;
+    };
+
+    FlatAST();
+    explicit FlatAST(const TranslationUnitNode& root);   // все объявления дерева указателей
+
+    // Дописать объявление верхнего уровня (nullptr - пустое объявление)
+    void append(Decl* decl);
+
+    std::size_t size() const { return kinds.size(); }
+    NodeKind kind(std::uint32_t i) const { return kinds[i]; }
+    std::uint32_t end(std::uint32_t i) const { return ends[i]; }
+    std::uint32_t data(std::uint32_t i) const { return datas[i]; }
+
+    std::uint32_t first_child(std::uint32_t i) const { return i + 1; }
+    std::uint32_t next_sibling(std::uint32_t i) const { return ends[i]; }
+    std::uint32_t child(std::uint32_t i, std::uint32_t n) const;    // n-й ребёнок
+
+    LiteralExpr::Value literal(std::uint32_t i) const { return literals.get(ConstantPool::unpack(datas[i])); }
+    Symbol symbol(std::uint32_t i) const { return Symbol(datas[i]); }
+    const std::string& op(std::uint32_t i) const { return operators[datas[i]]; }
+    const TypePtr& type(std::uint32_t i) const { return types[datas[i]]; }
+    const VarType& var_type(std::uint32_t i) const { return var_types[datas[i]]; }
+    const Function& function(std::uint32_t i) const { return functions[datas[i]]; }
+    const Typedef& typedef_info(std::uint32_t i) const { return typedefs[datas[i]]; }
+    const std::string& message(std::uint32_t i) const { return messages[datas[i]]; }
+
+    // Записано ли дерево после семантического анализа; тип выражения i или nullptr
+    bool analyzed() const { return !expr_types.empty(); }
+    TypePtr expr_type(std::uint32_t i) const;
+
+    const ConstantPool& constants() const { return literals; }
+
+    // Байты, занятые массивами узлов и боковыми таблицами
+    std::size_t bytes() const;
+
+    // Дерево указателей, построенное по плоской форме: для проходов, которые пишут в дерево
+    // (семантический анализ записывает типы и вставляет преобразования)
+    std::shared_ptr<TranslationUnitNode> expand() const;
+    // Обход без построения дерева: посетитель получает виды узлов прямо в массивах
+    void accept(FlatVisitor& visitor) const;
+
+private:
+    friend class FlatWriter;
+    friend class FlatParser;
+    friend class AstCache;
+
+    std::vector<NodeKind> kinds;
+    std::vector<std::uint32_t> ends;
+    std::vector<std::uint32_t> datas;
+
+    ConstantPool literals;                  // одинаковые литералы всех объявлений - одна константа
+    std::vector<std::string> operators;     // различных операторов немного: поиск перебором
+    std::vector<TypePtr> types;
+    std::vector<VarType> var_types;
+    std::vector<Function> functions;
+    std::vector<Typedef> typedefs;
+    std::vector<std::string> messages;
+    std::vector<std::uint32_t> expr_types;  // по узлу: индекс в types или no_data; пусто - не анализировалось
+
+    std::uint32_t open(NodeKind kind, std::uint32_t data = no_data);
+    void close(std::uint32_t node) { ends[node] = static_cast<std::uint32_t>(kinds.size()); }
+    std::uint32_t intern_operator(const std::string& op);
+    // Для записи по ходу разбора, когда вид узла становится известен после его первого ребёнка:
+    // wrap вставляет узел перед последним поддеревом [first, size()) и закрывает его (узлы
+    // поддерева сдвигаются на один), rotate меняет местами два последних соседних куска
+    // [first, middle) и [middle, size()), truncate отбрасывает узлы от size. Парсер пишет
+    // непроверенное дерево, expr_types они не трогают
+    void wrap(std::uint32_t first, NodeKind kind, std::uint32_t data = no_data);
+    void rotate(std::uint32_t first, std::uint32_t middle);
+    void truncate(std::uint32_t size);
+};
+
+// Узел плоской формы для FlatVisitor: массивы и индекс. Пустое ребро - узел вида None
+class FlatNode {
+public:
+    class iterator {
+    public:
+        iterator(const FlatAST& flat, std::uint32_t i) : flat(&flat), i(i) {}
+        FlatNode operator*() const { return {*flat, i}; }
+        iterator& operator++() {
+            i = flat->next_sibling(i);
+            return *this;
+        }
+        bool operator!=(const iterator& other) const { return i != other.i; }
+
+    private:
+        const FlatAST* flat;
+        std::uint32_t i;
+    };
+    struct Children {
+        iterator first, last;
+        iterator begin() const { return first; }
+        iterator end() const { return last; }
+    };
+
+    FlatNode(const FlatAST& flat, std::uint32_t index) : flat(&flat), i(index) {}
+
+    NodeKind kind() const { return flat->kind(i); }
+    bool empty() const { return kind() == NodeKind::None; }
+    std::uint32_t index() const { return i; }
+    const FlatAST& ast() const { return *flat; }
+
+    FlatNode child(std::uint32_t n) const { return {*flat, flat->child(i, n)}; }
+    Children children() const { return {{*flat, flat->first_child(i)}, {*flat, flat->end(i)}}; }
+    std::uint32_t child_count() const;
+    bool is_last(const FlatNode& child) const { return flat->next_sibling(child.i) == flat->end(i); }
+
+    LiteralExpr::Value literal() const { return flat->literal(i); }
+    Symbol symbol() const { return flat->symbol(i); }
+    const std::string& op() const { return flat->op(i); }
+    bool has_type() const { return flat->data(i) != FlatAST::no_data; }
+    const TypePtr& type() const { return flat->type(i); }
+    const FlatAST::VarType& var_type() const { return flat->var_type(i); }
+    const FlatAST::Function& function() const { return flat->function(i); }
+    const FlatAST::Typedef& typedef_info() const { return flat->typedef_info(i); }
+    const std::string& message() const { return flat->message(i); }
+
+private:
+    const FlatAST* flat;
+    std::uint32_t i;
+};
@@ -0,0 +1,40 @@
+#pragma once
+#include "token_buffer.hpp"
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Правка текста: замена диапазона [offset, offset + length) прежнего текста на text
+struct TextEdit {
+    std::size_t offset;
+    std::size_t length;
+    std::string text;
+};
+
+// Применить правки к тексту. Правки упорядочены по offset и не пересекаются, координаты - в прежнем тексте
+std::string apply_edits(std::string_view source, const std::vector<TextEdit>& edits);
+
+// Лексирование после правок. Токены, которые правки не затрагивают, переносятся из прежнего
+// потока со сдвигом смещений. Заново лексируется участок от конца последнего целого токена
+// перед правкой до синхронизации - первого нового токена, который за правкой начинается там же,
+// где начинался прежний токен. Результат совпадает с Lexer(source).tokenize().
+class IncrementalLexer {
+public:
+    // previous - поток токенов прежнего текста, source - текст после правок (apply_edits)
+    IncrementalLexer(const TokenBuffer& previous, std::string_view source, const std::vector<TextEdit>& edits);
+
+    TokenBuffer tokenize();
+
+    // Статистика последнего запуска
+    std::size_t reused_tokens() const { return reused_count; }
+    std::size_t relexed_tokens() const { return relexed_count; }
+
+private:
+    const TokenBuffer& previous;
+    std::string_view source;
+    const std::vector<TextEdit>& edits;
+
+    std::size_t reused_count = 0;
+    std::size_t relexed_count = 0;
+};
@@ -1,26 +1,53 @@
 #pragma once
 #include "token.hpp"
+#include "token_buffer.hpp"
+#include "symbol.hpp"
 #include <string>
-#include <vector>
+#include <string_view>
 #include <unordered_map>
 
 class Lexer {
 public:
-    Lexer(const std::string&);
-    std::vector<Token> tokenize();
+    // Исходник не копируется: буфер токенов ссылается на него, он должен пережить результат
+    explicit Lexer(std::string_view input);
+    // Лексер, продолжающий разбор с позиции start: она должна быть началом токена,
+    // комментария или пробела в истинном потоке, иначе результат - разбор "с середины".
+    // С local идентификаторы интернируются в локальную таблицу (id нужно перевести SymbolRemap),
+    // иначе - сразу в глобальную
+    Lexer(std::string_view input, std::size_t start, Interner* local = nullptr);
+    TokenBuffer tokenize();
+    // Лексирование окна потокового ввода: токен, который может продолжиться за концом окна,
+    // не выдаётся; в resume записывается позиция, с которой начнётся следующее окно
+    TokenBuffer tokenize_prefix(std::size_t& resume);
+    // Токены, начинающиеся до позиции end (без END); в resume - начало первого токена
+    // не раньше end или конец ввода. Последний токен может заканчиваться за end
+    TokenBuffer tokenize_range(std::size_t end, std::size_t& resume);
+
+    // Пошаговый разбор: пропустить пробелы и комментарии, затем выдать один токен в tokens.
+    // false - достигнут конец ввода
+    bool skip_trivia();
+    bool next(TokenBuffer& tokens);
+    std::size_t position() const { return index; }
 
 private:
-    std::string input;
+    std::string_view input;
     std::size_t index = 0;
+    TokenBuffer* out = nullptr;     // буфер, в который пишет текущий вызов
+    Interner* local = nullptr;
+    // Уже встречавшиеся имена: глобальная таблица блокируется только для новых
+    std::unordered_map<std::string_view, Symbol> symbols;
+
+    Symbol symbol_for(std::string_view name);
 
-    static const std::unordered_map<std::string, TokenType> keywords;
-    static const std::unordered_map<std::string, TokenType> operators;
+    // символ за концом ввода читается как '\0'
+    char at(std::size_t i) const { return i < input.size() ? input[i] : '\0'; }
+    std::size_t skip_digits(std::size_t i) const;
 
-    Token extract();
-    Token extract_number();
-    Token extract_identifier();
-    Token extract_string();
-    Token extract_char();
-    Token extract_operator();
+    void extract();     // токен, начинающийся в index (пробелы и комментарии уже пропущены)
+    void extract_number();
+    void extract_identifier();
+    void extract_string();
+    void extract_char();
+    void extract_operator();
     void extract_comment();
 };
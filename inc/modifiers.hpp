@@ -23,7 +23,7 @@ struct Modifiers {
         return mods.count(mod) != 0; // Проверка наличия элемента
     }
 
-    std::string get_str(){
+    std::string get_str() const {
         std::string str = "";
         for (const auto& mod : mods) {
             switch (mod) {
@@ -33,6 +33,7 @@ struct Modifiers {
             }
             str += " ";
         }
+        return str;
     }
 
 };
\ No newline at end of file
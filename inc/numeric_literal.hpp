@@ -0,0 +1,12 @@
+#pragma once
+#include <string_view>
+#include <variant>
+
+// Значение числового литерала, декодированное лексером. Тип выбирается по правилам C:
+// суффиксы u/l/f, основание и величина значения (int -> long при переполнении)
+using NumericValue = std::variant<int, unsigned, long, unsigned long, float, double, long double>;
+
+// Декодирование частей литерала, выделенных лексером; ошибки - std::runtime_error.
+// digits - цифры без префикса 0x/0b, suffix - всё, что идёт за цифрами (и экспонентой)
+NumericValue decode_integer(std::string_view digits, int base, std::string_view suffix);
+NumericValue decode_floating(std::string_view text, std::string_view suffix);
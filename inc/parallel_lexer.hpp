@@ -0,0 +1,37 @@
+#pragma once
+#include "thread_pool.hpp"
+#include "token_buffer.hpp"
+#include <cstddef>
+#include <string_view>
+
+// Параллельное лексирование большого исходника. Исходник режется на куски по границам строк,
+// каждый кусок лексируется в пуле "на удачу" - как будто его начало находится вне строки,
+// символа и комментария. При склейке истинная позиция разбора (начало первого токена
+// за предыдущим куском) ищется среди начал токенов куска: совпадение означает, что дальше
+// поток куска совпадает с последовательным. Иначе кусок переразбирается последовательно
+// с истинной позиции до первого совпадения. Результат всегда совпадает с Lexer::tokenize.
+// Идентификаторы кусков интернируются в локальные таблицы и получают глобальные id при склейке
+// в порядке появления, поэтому id символов тоже совпадают с последовательным разбором.
+class ParallelLexer {
+public:
+    static constexpr std::size_t min_chunk_size = 256 << 10;
+
+    // chunks == 0 - по одному куску на поток пула
+    ParallelLexer(std::string_view input, ThreadPool& pool, std::size_t chunks = 0);
+
+    TokenBuffer tokenize();
+
+    // Статистика последнего запуска
+    std::size_t chunks() const { return chunk_count; }
+    std::size_t resynced() const { return resynced_count; }    // куски, разобранные заново (частично или целиком)
+    std::size_t relexed_bytes() const { return relexed_count; }
+
+private:
+    std::string_view input;
+    ThreadPool& pool;
+    std::size_t requested_chunks;
+
+    std::size_t chunk_count = 0;
+    std::size_t resynced_count = 0;
+    std::size_t relexed_count = 0;
+};
@@ -0,0 +1,48 @@
+#pragma once
+#include "ast.hpp"
+#include "parser.hpp"
+#include "thread_pool.hpp"
+#include "token_buffer.hpp"
+#include <cstddef>
+#include <memory>
+
+// Параллельный разбор объявлений верхнего уровня. Быстрый просмотр типов токенов с подсчётом
+// скобок находит границы объявлений: функция (выбирается так же, как в Parser::declaration)
+// кончается закрывающей '}' тела или ';' прототипа, остальные объявления - ';' вне скобок.
+// Объявления собираются в группы примерно равного числа токенов, каждая группа разбирается
+// в пуле своим Parser "на удачу" в свою арену. При склейке арены переходят к общему корню,
+// объявления - в порядке исходника. Если группа не дошла ровно до своей границы или в ней
+// есть ошибки, весь вход разбирается последовательно: результат и диагностика всегда
+// совпадают с Parser::parse
+class ParallelParser {
+public:
+    static constexpr std::size_t min_group_tokens = 16 << 10;
+
+    // groups == 0 - по четыре группы на поток пула
+    ParallelParser(const TokenBuffer& tokens, ThreadPool& pool, std::size_t groups = 0);
+
+    std::shared_ptr<TranslationUnitNode> parse();
+    void set_max_depth(std::size_t limit) { max_depth = limit; }    // см. Parser::set_max_depth
+    void set_hash_consing(bool enabled) { hash_consing = enabled; }  // см. Parser::set_hash_consing, таблица у каждой группы своя
+    // См. Parser::set_lazy_bodies. Отложенные тела после склейки разбираются в арену общего корня
+    void set_lazy_bodies(bool lazy) { lazy_bodies = lazy; }
+
+    // Статистика последнего запуска
+    std::size_t declarations() const { return declaration_count; }
+    std::size_t groups() const { return group_count; }
+    bool fell_back() const { return fallback; }    // пришлось разбирать последовательно
+
+private:
+    const TokenBuffer& tokens;
+    ThreadPool& pool;
+    std::size_t requested_groups;
+    std::size_t max_depth = Parser::default_max_depth;
+    bool hash_consing = false;
+    bool lazy_bodies = false;
+
+    std::size_t declaration_count = 0;
+    std::size_t group_count = 0;
+    bool fallback = false;
+
+    std::shared_ptr<TranslationUnitNode> parse_serial();
+};
@@ -1,70 +1,171 @@
 #pragma once
 #include "token.hpp"
+#include "token_buffer.hpp"
+#include "token_cursor.hpp"
 #include "ast.hpp" // Для работы с AST
+#include "flat_ast.hpp"
+#include "expr_interner.hpp"
+#include <memory>
 #include <vector>
 #include <string>
 #include <stdexcept>
 
 class Parser {
 public:
-    explicit Parser(const std::vector<Token>& tokens);
+    // Предел вложенности по умолчанию. Самый дорогой уровень - скобки в выражении, около 1.4 КБ стека
+    // в сборке без оптимизации; 500 уровней с запасом умещаются в стек 1 МБ вместе с рекурсивными
+    // обходами готового дерева (печать, семантический анализ), глубина которого не больше глубины разбора
+    static constexpr std::size_t default_max_depth = 500;
+
+    explicit Parser(const TokenBuffer& tokens);
+    // Разбор по мере лексирования: токены приходят пачками из конвейера
+    explicit Parser(TokenPipeline& tokens);
+    // Разбор части буфера, начиная с токена begin (см. parse_range)
+    Parser(const TokenBuffer& tokens, std::size_t begin);
     void parse();  // точка входа парсинга - translation_unit()
     std::shared_ptr<ASTNode> getAST() const; // Метод для получения корня AST
+    // Разбор в плоскую форму: узлы пишутся прямо в массивы FlatAST, дерево указателей не строится.
+    // Тела функций разбираются сразу, общих узлов hash-consing в плоской форме нет
+    FlatAST parse_flat();
+    // Разбор "на удачу" объявлений верхнего уровня от begin до токена end (для ParallelParser).
+    // Диагностика не печатается; true, если разбор ровно дошёл до end без ошибок -
+    // только тогда результат совпадает с соответствующей частью последовательного разбора
+    bool parse_range(std::size_t end);
+    // Ленивые тела функций: func_decl запоминает только начало тела, найдя его конец по скобкам,
+    // а разбирает тело FunctionDecl::get_body при первом обращении. Работает при разборе
+    // из TokenBuffer, который должен жить, пока используется AST. Ошибки в теле выдаются при его разборе
+    void set_lazy_bodies(bool lazy) { lazy_bodies = lazy; }
+    // Вложенность блоков, операторов и выражений (скобок, префиксных операторов) сверх limit -
+    // ошибка разбора std::runtime_error вместо переполнения стека рекурсивного спуска
+    void set_max_depth(std::size_t limit) { max_depth = limit; }
+    // Hash-consing: одинаковые выражения без побочных эффектов (литералы, имена, арифметика, логика,
+    // индексы, поля, тернарный оператор из таких же частей) разбираются в один общий узел.
+    // Дерево становится DAG: общий узел помечен ASTNode::shared. Ленивое тело заводит свою таблицу
+    void set_hash_consing(bool enabled) { interner = enabled ? std::make_unique<ExprInterner>() : nullptr; }
+    const ExprInterner* expr_table() const { return interner.get(); }   // nullptr, если режим выключен
 
 private:
-    const std::vector<Token>& tokens;
-    size_t pos = 0;
-    std::shared_ptr<TranslationUnitNode> root; // Корень AST
+    friend class DeferredFunctionBody;
+    friend class FlatParser;
+
+    TokenCursor cursor;
+    const TokenBuffer* tokens = nullptr;    // весь поток токенов, если он не приходит из конвейера
+    std::shared_ptr<TranslationUnitNode> root; // Корень AST и арена его узлов
+    Arena* arena = nullptr;                 // арена узлов: root->arena или арена отложенного тела
+    ConstantPool* constants = nullptr;      // пул литералов этой арены
+    bool lazy_bodies = false;
+    std::size_t depth = 0;
+    std::size_t max_depth = default_max_depth;
+    std::unique_ptr<ExprInterner> interner;
+    // Эпоха имён для hash-consing: растёт, когда имя может начать означать другое
+    // (новое объявление, конец блока или for), и входит в ключ IdExpr
+    std::uint32_t scope_epoch = 0;
+    // Номер объявления верхнего уровня: входит в ключ остальных выражений, поэтому общие узлы
+    // не выходят за одно объявление и тела функций можно проверять параллельно (SemanticAnalyzer)
+    std::uint32_t decl_epoch = 0;
+
+    // Уровень рекурсивного спуска на время жизни объекта
+    class DepthGuard {
+    public:
+        explicit DepthGuard(Parser& parser);
+        ~DepthGuard() { --parser.depth; }
+        DepthGuard(const DepthGuard&) = delete;
+        DepthGuard& operator=(const DepthGuard&) = delete;
+
+    private:
+        Parser& parser;
+    };
+    bool speculative = false;       // разбор куска в parse_range: ошибки только считаются
+    std::size_t error_count = 0;
+
+    void set_root(std::shared_ptr<TranslationUnitNode> node);
+
+    // Узел в текущей арене
+    template <typename T, typename... Args>
+    T* make(Args&&... args) { return arena->make<T>(std::forward<Args>(args)...); }
+    // Литерал со значением из пула текущей арены
+    template <typename T>
+    Expr* literal(const T& value) {
+        Constant constant = constants->add(value);
+        return make_expr<LiteralExpr>(ConstantPool::pack(constant), {}, *constants, constant);
+    }
+
+    // Узел выражения без побочных эффектов: при hash-consing, если все дети общие, берётся
+    // общий узел с тем же видом, данными (data) и детьми, иначе создаётся новый
+    template <typename T, typename... Args>
+    Expr* make_expr(std::uint32_t data, std::initializer_list<const Expr*> children, Args&&... args) {
+        if (interner) {
+            ExprInterner::Key key{T::node_kind, data, T::node_kind == NodeKind::Id ? scope_epoch : decl_epoch, {}};
+            bool pure = true;
+            std::size_t n = 0;
+            for (auto child : children) {
+                pure = pure && child && child->shared;
+                key.children[n++] = child;
+            }
+            if (pure) {
+                Expr*& node = interner->lookup(key);
+                if (!node) {
+                    node = make<T>(std::forward<Args>(args)...);
+                    node->shared = true;
+                }
+                return node;
+            }
+        }
+        return make<T>(std::forward<Args>(args)...);
+    }
+    // Бинарное или логическое выражение; оператор входит в ключ hash-consing типом своего токена
+    template <typename T>
+    Expr* binary(TokenType type, const std::string& op, Expr* left, Expr* right) {
+        return make_expr<T>(static_cast<std::uint32_t>(type), {left, right}, op, left, right);
+    }
 
     // вспомогательные
     Token peek() const;
+    Token previous() const;
     Token advance();
+    Symbol advance_symbol();    // advance() и интернированное имя токена
     bool match(TokenType type);
     bool check(TokenType type) const;
     bool token_is_type() const;
     bool token_is_modifier() const;
     void expect(TokenType type, const std::string& error_msg);
+    void report(const std::string& message);   // диагностика разбора
 
     // грамматические правила
     void translation_unit();
-    std::shared_ptr<Decl> declaration();
+    Decl* declaration();
     Modifiers parse_modifiers();
-    std::shared_ptr<Decl> var_decl();
-    std::shared_ptr<Stmt> expr_statement();
-    std::shared_ptr<FunctionDecl> func_decl();
-    std::shared_ptr<Decl> struct_decl();
-    std::shared_ptr<Decl> assert_decl();
-    std::shared_ptr<Decl> typedef_decl();
+    Decl* var_decl();
+    Stmt* expr_statement();
+    FunctionDecl* func_decl();
+    // Список параметров в скобках
+    std::vector<std::pair<std::pair<Modifiers, TypePtr>, Symbol>> parameters();
+    std::size_t body_end(std::size_t begin) const;    // индекс за '}' тела или 0, если скобки не сбалансированы
+    Decl* struct_decl();
+    Decl* assert_decl();
+    Decl* typedef_decl();
 
-    std::shared_ptr<Stmt> statement();
-    std::shared_ptr<Stmt> conditional_statement();
-    std::shared_ptr<Stmt> loop_statement();
-    std::shared_ptr<Stmt> while_statement();
-    std::shared_ptr<Stmt> do_while_statement();
-    std::shared_ptr<Stmt> for_statement();
-    std::shared_ptr<Stmt> break_statement();
-    std::shared_ptr<Stmt> continue_statement();
-    std::shared_ptr<Stmt> return_statement();
-    std::shared_ptr<Stmt> io_statement();
-    std::shared_ptr<Stmt> exit_statement();
-    std::shared_ptr<Stmt> block_statement();
+    Stmt* statement();
+    Stmt* conditional_statement();
+    Stmt* loop_statement();
+    Stmt* while_statement();
+    Stmt* do_while_statement();
+    Stmt* for_statement();
+    Stmt* break_statement();
+    Stmt* continue_statement();
+    Stmt* return_statement();
+    Stmt* io_statement();
+    Stmt* exit_statement();
+    Stmt* block_statement();
 
     // выражения
-    std::shared_ptr<Expr> expression(bool allow_comma = true);
-    std::shared_ptr<Expr> assignment();
-    std::shared_ptr<Expr> ternary();
-    std::shared_ptr<Expr> logical_or();
-    std::shared_ptr<Expr> logical_and();
-    std::shared_ptr<Expr> equality();
-    std::shared_ptr<Expr> comparison();
-    std::shared_ptr<Expr> term();
-    std::shared_ptr<Expr> factor();
-    std::shared_ptr<Expr> binary();
-    std::shared_ptr<Expr> unary();
-    std::shared_ptr<Expr> postfix();
-    std::shared_ptr<Expr> primary();
-    std::shared_ptr<Expr> convert_literal();
-    std::shared_ptr<Expr> ternary_expression();
-    std::shared_ptr<Expr> cast_expression();
-    std::shared_ptr<Expr> array_initializer(); // Обработка инициализации массивов
+    Expr* expression(bool allow_comma = true);
+    // Операнд и следующие за ним операторы с приоритетом не ниже min_precedence
+    Expr* binary_expression(int min_precedence);
+    Expr* unary();
+    Expr* postfix();
+    Expr* primary();
+    Expr* convert_literal();
+    Expr* cast_expression();
+    Expr* array_initializer(); // Обработка инициализации массивов
 };
@@ -0,0 +1,21 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+
+// Пиковый размер резидентной памяти процесса в байтах (0, если платформа не поддерживается)
+std::size_t peak_rss_bytes();
+
+// Замер времени этапов: загрузка, лексер, парсер
+class Stopwatch {
+public:
+    Stopwatch() : start(std::chrono::steady_clock::now()) {}
+
+    void reset() { start = std::chrono::steady_clock::now(); }
+
+    double elapsed_ms() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start;
+};
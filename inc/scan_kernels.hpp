@@ -0,0 +1,48 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+// Ядра сканирования для горячего цикла лексера. Классы символов - только ASCII,
+// без учёта локали. Реализация (скалярная, SSE2 или AVX2) выбирается при запуске
+// по возможностям процессора, все реализации дают одинаковый результат.
+namespace scan {
+
+enum class Level { Scalar, SSE2, AVX2 };
+
+Level active_level();
+Level best_level();                 // лучшая реализация, доступная на этом процессоре
+bool set_level(Level level);        // false, если процессор не поддерживает level
+const char* level_name(Level level);
+
+// Таблица реализаций; все функции возвращают первую позицию в [p, end),
+// не удовлетворяющую условию, или end
+struct Kernels {
+    const char* (*skip_whitespace)(const char* p, const char* end);
+    const char* (*skip_identifier)(const char* p, const char* end);     // [A-Za-z0-9_]
+    const char* (*skip_digits)(const char* p, const char* end);
+    const char* (*find_newline)(const char* p, const char* end);
+    const char* (*find_comment_end)(const char* p, const char* end);    // позиция '*' в "*/"
+};
+
+extern Kernels active_kernels;
+
+inline const char* skip_whitespace(const char* p, const char* end) { return active_kernels.skip_whitespace(p, end); }
+inline const char* skip_identifier(const char* p, const char* end) { return active_kernels.skip_identifier(p, end); }
+inline const char* skip_digits(const char* p, const char* end) { return active_kernels.skip_digits(p, end); }
+inline const char* find_newline(const char* p, const char* end) { return active_kernels.find_newline(p, end); }
+inline const char* find_comment_end(const char* p, const char* end) { return active_kernels.find_comment_end(p, end); }
+
+enum CharClass : std::uint8_t {
+    Space = 1,
+    Digit = 2,
+    Alpha = 4,          // буквы и '_'
+};
+
+extern const std::array<std::uint8_t, 256> char_class;
+
+inline bool is_space(char c) { return char_class[static_cast<unsigned char>(c)] & Space; }
+inline bool is_digit(char c) { return char_class[static_cast<unsigned char>(c)] & Digit; }
+inline bool is_ident_start(char c) { return char_class[static_cast<unsigned char>(c)] & Alpha; }
+inline bool is_ident(char c) { return char_class[static_cast<unsigned char>(c)] & (Alpha | Digit); }
+
+} // namespace scan
@@ -1,66 +1,140 @@
 #pragma once
-#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
 #include "symbol_table.hpp"
 
+// Объявления одного пространства имён во всех открытых областях: стек объявлений и цепочки
+// затенения. heads[id имени] - самое внутреннее объявление, у объявления - номер затенённого им.
+// Поиск - одно обращение к массиву по id, без обхода таблиц родительских областей.
+// Стек служит и журналом отката: при выходе из области снимаются объявления выше отметки,
+// головы цепочек возвращаются к затенённым
+template <typename Info>
+class ShadowTable {
+public:
+    // Самое внутреннее объявление; nullptr - имя не объявлено
+    const Info* find(Symbol name) const {
+        std::uint32_t top = head(name);
+        return top == none ? nullptr : &entries[top].info;
+    }
+    // Самое внутреннее из первых limit объявлений: таблица, какой она была при size() == limit
+    const Info* find(Symbol name, std::size_t limit) const {
+        std::uint32_t at = head(name);
+        while (at != none && at >= limit) at = entries[at].shadowed;
+        return at == none ? nullptr : &entries[at].info;
+    }
+    // Объявление именно в области depth
+    const Info* find_local(Symbol name, std::uint32_t depth) const {
+        std::uint32_t top = head(name);
+        return top != none && entries[top].depth == depth ? &entries[top].info : nullptr;
+    }
+
+    // false - имя уже объявлено в этой области. Новое объявление закрывает прежнее, но прежнее
+    // остаётся в стеке: find(name, limit) с отметкой до повтора по-прежнему находит его
+    bool declare(Symbol name, const Info& info, std::uint32_t depth) {
+        std::uint32_t top = head(name);
+        if (name.id >= heads.size()) heads.resize(name.id + 1, none);
+        heads[name.id] = static_cast<std::uint32_t>(entries.size());
+        entries.push_back({name, depth, top, info});
+        return top == none || entries[top].depth != depth;
+    }
+
+    std::size_t size() const { return entries.size(); }
+    void unwind(std::size_t mark) {
+        while (entries.size() > mark) {
+            heads[entries.back().name.id] = entries.back().shadowed;
+            entries.pop_back();
+        }
+    }
+
+private:
+    static constexpr std::uint32_t none = UINT32_MAX;
+
+    struct Entry {
+        Symbol name;
+        std::uint32_t depth;
+        std::uint32_t shadowed;     // затенённое объявление того же имени или none
+        Info info;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<std::uint32_t> heads;
 
+    std::uint32_t head(Symbol name) const { return name.id < heads.size() ? heads[name.id] : none; }
+};
+
+// Все области видимости анализа одним стеком: глобальная (глубина 0) и вложенные.
+// Вход и выход - O(1) плюс число объявлений области, поиск не зависит от глубины вложенности.
+// Для параллельной проверки тел функций Scope строится поверх чужой глобальной области:
+// та только читается (из любого числа потоков), и из неё видны объявления до отметки set_visible
 class Scope {
     public:
-    Scope(std::shared_ptr<Scope> parent = nullptr) : _parent(parent) {}
+    // Размеры стеков объявлений: граница области или снимок глобальной области
+    struct Mark {
+        std::size_t vars;
+        std::size_t functions;
+        std::size_t typedefs;
+    };
 
-    std::shared_ptr<Scope> enterScope() {
-        return std::make_shared<Scope>(std::make_shared<Scope>(*this));
-    }
+    Scope() = default;
+    explicit Scope(const Scope* globals) : globals(globals) {}
 
-    std::shared_ptr<Scope> exitScope() {
-        return _parent ? _parent : nullptr;
-    }
+    Mark mark() const { return {vars.size(), functions.size(), typedefs.size()}; }
+    void set_visible(Mark mark) { visible = mark; }
 
-    void declare(const std::string& name, const SymbolInfo& info) {
-        _symbol_table.declare(name, info);
-    }
+    void enterScope() { marks.push_back(mark()); }
 
-    void declare(const std::string& name, const FunctionInfo& info) {
-        _symbol_table.declare(name, info);
+    void exitScope() {
+        const Mark& mark = marks.back();
+        vars.unwind(mark.vars);
+        functions.unwind(mark.functions);
+        typedefs.unwind(mark.typedefs);
+        marks.pop_back();
     }
 
-    void declare(const std::string& name, const TypedefInfo& info) {
-        _symbol_table.declare(name, info);
+    std::uint32_t depth() const { return static_cast<std::uint32_t>(marks.size()); }
+
+    // Повторное объявление в той же области - не ошибка: прежнее заменяется, а предупреждение
+    // копится до take_warnings, чтобы параллельная проверка могла выдать их в порядке исходника
+    void declare(Symbol name, const SymbolInfo& info) {
+        if (!vars.declare(name, info, depth())) warnings.push_back("Symbol '" + name.str() + "' already declared.");
     }
 
-    std::optional<SymbolInfo> lookup_var(const std::string& name) const {
-        return _symbol_table.lookup_var(name);
+    void declare(Symbol name, const FunctionInfo& info) {
+        if (!functions.declare(name, info, depth())) warnings.push_back("Function '" + name.str() + "' is already declared.");
     }
 
-    std::optional<SymbolInfo> exists_var(const std::string& name) const {
-        if (auto info = _symbol_table.lookup_var(name)) {
-            return info;
-        }
-        // Если не найдено, ищем в родительской области
-        return _parent ? _parent->exists_var(name) : std::nullopt;
+    void declare(Symbol name, const TypedefInfo& info) {
+        if (!typedefs.declare(name, info, depth())) warnings.push_back("Typedef '" + name.str() + "' is already declared.");
     }
 
-    std::optional<FunctionInfo> lookup_func(const std::string& name) const {
-        return _symbol_table.lookup_func(name);
+    std::vector<std::string> take_warnings() { return std::exchange(warnings, {}); }
+
+    // lookup_* - только текущая область, exists_* - самое внутреннее объявление во всех открытых
+    const SymbolInfo* lookup_var(Symbol name) const { return vars.find_local(name, depth()); }
+    const SymbolInfo* exists_var(Symbol name) const {
+        if (auto info = vars.find(name)) return info;
+        return globals ? globals->vars.find(name, visible.vars) : nullptr;
     }
-    
-    std::optional<FunctionInfo> exists_func(const std::string& name) const {
-        if (auto info = _symbol_table.lookup_func(name)) {
-            return info;
-        }
-        // Если не найдено, ищем в родительской области
-        return _parent ? _parent->exists_func(name) : std::nullopt;
+    const FunctionInfo* lookup_func(Symbol name) const { return functions.find_local(name, depth()); }
+    const FunctionInfo* exists_func(Symbol name) const {
+        if (auto info = functions.find(name)) return info;
+        return globals ? globals->functions.find(name, visible.functions) : nullptr;
     }
-
-    std::optional<TypedefInfo> exists_type(const std::string& name) const {
-        if (auto info = _symbol_table.lookup_typedef(name)) {
-            return info;
-        }
-        // Если не найдено, ищем в родительской области
-        return _parent ? _parent->exists_type(name) : std::nullopt;
+    const TypedefInfo* exists_type(Symbol name) const {
+        if (auto info = typedefs.find(name)) return info;
+        return globals ? globals->typedefs.find(name, visible.typedefs) : nullptr;
     }
 
     private:
+    const Scope* globals = nullptr;
+    Mark visible{};
 
-    SymbolTable _symbol_table;    
-    std::shared_ptr<Scope> _parent;
-};
\ No newline at end of file
+    ShadowTable<SymbolInfo> vars;
+    ShadowTable<FunctionInfo> functions;
+    ShadowTable<TypedefInfo> typedefs;
+    std::vector<Mark> marks;    // размеры стеков при входе в каждую открытую область
+    std::vector<std::string> warnings;
+};
@@ -1,18 +1,40 @@
 #pragma once
-#include "symbol_table.hpp"
-#include "visitor.hpp"
+#include "ast.hpp"
+#include "thread_pool.hpp"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
 
+// Семантические проверки разобранной программы; первая ошибка - std::runtime_error,
+// предупреждения о повторных объявлениях печатаются в std::cout
 class SemanticAnalyzer {
 public:
-    SemanticAnalyzer();
+    // Ошибка проверки: номер объявления верхнего уровня и текст
+    struct Diagnostic {
+        std::size_t decl;
+        std::string message;
+    };
 
     void analyze(std::shared_ptr<TranslationUnitNode> root);
 
-private:
-    SymbolTable symbolTable;
+    // Проверка в две фазы. Первая последовательно проходит объявления верхнего уровня: глобальные
+    // переменные, структуры, typedef и сигнатуры функций попадают в глобальную область, ленивые тела
+    // разбираются. Дальше глобальная область только читается, и тела функций проверяются в пуле:
+    // у каждой задачи свои области видимости и своя арена для узлов преобразований. Тела делятся
+    // между задачами отрезками, освободившаяся задача крадёт половину чужого отрезка; одну из задач
+    // выполняет вызывающий поток. Предупреждения и ошибки собираются по объявлениям и после
+    // завершения задач выдаются в порядке последовательного обхода: предупреждения до первой
+    // ошибки печатаются, первая ошибка бросается
+    void analyze(std::shared_ptr<TranslationUnitNode> root, ThreadPool& pool);
+
+    // Все ошибки последнего параллельного запуска в порядке исходника
+    const std::vector<Diagnostic>& diagnostics() const { return errors; }
+    std::size_t functions() const { return function_count; }    // тел, проверенных параллельно
+    std::size_t steals() const { return steal_count; }          // отрезков, забранных у других задач
 
-    void checkVariableDeclarations(std::shared_ptr<Decl> decl);
-    void checkFunctionCalls(std::shared_ptr<Expr> expr);
-    void checkControlFlow(std::shared_ptr<Stmt> stmt);
-    void checkTypeCompatibility(const std::string& expected, const std::string& actual);
-};
\ No newline at end of file
+private:
+    std::vector<Diagnostic> errors;
+    std::size_t function_count = 0;
+    std::size_t steal_count = 0;
+};
@@ -1,15 +1,33 @@
 #pragma once
 #include "visitor.hpp"
-#include "symbol_table.hpp"
+#include "scope.hpp"
 
+// Проверка всего дерева - accept корня. Для параллельной проверки (SemanticAnalyzer) те же шаги
+// доступны по отдельности: объявление функции в глобальной области и проверка её тела
 class SemanticVisitor : public ASTVisitor {
 public:
-    explicit SemanticVisitor(SymbolTable& symbolTable) : symbolTable(symbolTable) {}
+    SemanticVisitor() = default;
+    // Узлы преобразований создаются в arena. С globals тела проверяются поверх этой глобальной
+    // области: она только читается, и видно в ней то, что объявлено до отметки (см. check_body)
+    explicit SemanticVisitor(Arena& arena, const Scope* globals = nullptr) : scope(globals), arena(&arena) {}
+
+    // Проверить сигнатуру функции и объявить её в текущей области; тело не проверяется
+    void declare_function(FunctionDecl& decl);
+    // Проверить тело функции; из глобальной области видны объявления до отметки visible -
+    // ровно то, что видел бы последовательный обход
+    void check_body(FunctionDecl& decl, Scope::Mark visible);
+    // main должна возвращать int
+    static void check_main(const FunctionDecl& decl);
+
+    const Scope& globals() const { return scope; }
+    // Предупреждения о повторных объявлениях с прошлого вызова, в порядке обхода
+    std::vector<std::string> take_warnings() { return scope.take_warnings(); }
 
     void visit(LiteralExpr& expr) override;
     void visit(IdExpr& expr) override;
     void visit(BinaryExpr& expr) override;
     void visit(UnaryExpr& expr) override;
+    void visit(SizeofExpr& expr) override;
     void visit(TernaryExpr& expr) override;
     void visit(CallExpr& expr) override;
     void visit(MemberAccessExpr& expr) override;
@@ -18,6 +36,7 @@ public:
     void visit(PostfixExpr& expr) override;
     void visit(AssignExpr& expr) override;
     void visit(ArrayInitExpr& expr) override;
+    void visit(CastExpr& expr) override;
 
     void visit(ExprStmt& stmt) override;
     void visit(BlockStmt& stmt) override;
@@ -40,10 +59,17 @@ public:
     void visit(TranslationUnitNode& node) override;
 
 private:
-    SymbolTable& symbolTable;
+    Scope scope;                // глобальная область и открытые вложенные
+    TypePtr cur_type = nullptr;   // тип только что проверенного выражения
+    bool inside_loop = false;
+    TypePtr return_type = nullptr;
+    bool has_return = false;
+    Arena* arena = nullptr;     // арена дерева: в ней создаются узлы преобразований
 
-    void checkVariableUsage(IdExpr& expr);
-    void checkFunctionCall(CallExpr& expr);
-    void checkControlFlow(Stmt& stmt);
-    void checkTypeCompatibility(Expr& expr1, Expr& expr2);
-};
\ No newline at end of file
+    // Проверить выражение и записать его тип в узел (Expr::type_id); возвращает этот тип
+    TypePtr infer(Expr* expr);
+    void check_body(FunctionDecl& decl);
+    // Неявное преобразование значения типа from к типу to (расширение или арифметическое)
+    // становится явным узлом CastExpr на месте ребра expr
+    void convert(ExprPtr& expr, const TypePtr& from, const TypePtr& to);
+};
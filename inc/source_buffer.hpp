@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Исходный текст программы без лишних копий: обычный файл отображается в память (mmap),
+// каналы и прочие потоки читаются через read() в собственный буфер.
+class SourceBuffer {
+public:
+    SourceBuffer() = default;
+    ~SourceBuffer();
+
+    SourceBuffer(SourceBuffer&& other) noexcept;
+    SourceBuffer& operator=(SourceBuffer&& other) noexcept;
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+    // "-" - стандартный ввод
+    static SourceBuffer open(const std::string& path);
+
+    std::string_view view() const { return {data, length}; }
+    std::size_t size() const { return length; }
+    bool is_mapped() const { return mapped; }
+
+private:
+    const char* data = "";
+    std::size_t length = 0;
+    bool mapped = false;
+    std::string storage;    // используется, если отобразить файл не удалось
+
+    void release();
+};
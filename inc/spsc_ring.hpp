@@ -0,0 +1,45 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Ограниченная очередь без блокировок для одного производителя и одного потребителя.
+// Производитель пишет только tail, потребитель - только head; элемент публикуется
+// release-записью индекса и забирается после acquire-чтения
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(std::size_t capacity) : slots(capacity + 1) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // false - очередь заполнена, value не тронут
+    bool try_push(T& value) {
+        std::size_t tail = tail_index.load(std::memory_order_relaxed);
+        std::size_t next = advance(tail);
+        if (next == head_index.load(std::memory_order_acquire)) return false;
+        slots[tail] = std::move(value);
+        tail_index.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // false - очередь пуста
+    bool try_pop(T& value) {
+        std::size_t head = head_index.load(std::memory_order_relaxed);
+        if (head == tail_index.load(std::memory_order_acquire)) return false;
+        value = std::move(slots[head]);
+        head_index.store(advance(head), std::memory_order_release);
+        return true;
+    }
+
+    std::size_t capacity() const { return slots.size() - 1; }
+
+private:
+    std::vector<T> slots;   // один слот всегда пуст: так полная очередь отличается от пустой
+    alignas(64) std::atomic<std::size_t> head_index{0};
+    alignas(64) std::atomic<std::size_t> tail_index{0};
+
+    std::size_t advance(std::size_t i) const { return i + 1 == slots.size() ? 0 : i + 1; }
+};
@@ -0,0 +1,29 @@
+#pragma once
+#include "token_buffer.hpp"
+#include <cstddef>
+#include <functional>
+#include <string>
+
+// Потоковый лексер для файлов, которые не помещаются в память: исходник читается окнами,
+// токены каждого окна передаются в sink и после этого освобождаются.
+// Смещения токенов отсчитываются от начала окна, base - смещение окна в файле.
+class StreamingLexer {
+public:
+    using Sink = std::function<void(const TokenBuffer& tokens, std::size_t base)>;
+
+    explicit StreamingLexer(const std::string& path, std::size_t window_size = std::size_t(64) << 20);
+
+    void run(const Sink& sink);
+
+    std::size_t bytes() const { return total_bytes; }
+    std::size_t tokens() const { return total_tokens; }
+    std::size_t windows() const { return window_count; }
+    std::size_t max_window() const { return window_capacity; }
+
+private:
+    std::string path;
+    std::size_t window_capacity;
+    std::size_t total_bytes = 0;
+    std::size_t total_tokens = 0;
+    std::size_t window_count = 0;
+};
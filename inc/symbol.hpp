@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Интернированный идентификатор: плотный 32-битный id в глобальной таблице имён.
+// Сравнение и хеширование - по id; написание нужно только для диагностики и печати
+struct Symbol {
+    static constexpr std::uint32_t none = UINT32_MAX;
+    std::uint32_t id = none;
+
+    Symbol() = default;
+    explicit constexpr Symbol(std::uint32_t id) : id(id) {}
+
+    bool valid() const { return id != none; }
+    const std::string& str() const;
+
+    bool operator==(Symbol other) const { return id == other.id; }
+    bool operator!=(Symbol other) const { return id != other.id; }
+    bool operator<(Symbol other) const { return id < other.id; }
+};
+
+template <>
+struct std::hash<Symbol> {
+    std::size_t operator()(Symbol s) const noexcept { return s.id; }
+};
+
+// Таблица интернирования без синхронизации: id выдаются подряд в порядке первого появления.
+// Используется как локальная таблица потока (параллельное лексирование)
+class Interner {
+public:
+    Symbol intern(std::string_view name);
+    Symbol find(std::string_view name) const;      // Symbol() - если имени нет
+    const std::string& spelling(Symbol symbol) const { return spellings[symbol.id]; }
+    std::size_t size() const { return spellings.size(); }
+
+private:
+    std::deque<std::string> spellings;      // deque: ссылки на строки не меняются при росте
+    std::unordered_map<std::string_view, std::uint32_t> ids;
+};
+
+// Глобальная таблица, общая для лексера, AST и таблиц символов. Потокобезопасна
+Symbol intern(std::string_view name);
+std::size_t interned_count();
+
+// Перевод id локальной таблицы в глобальные. Глобальный id выдаётся при первом обращении,
+// поэтому обход токенов по порядку даёт те же id, что и последовательное лексирование
+class SymbolRemap {
+public:
+    explicit SymbolRemap(const Interner& local) : local(local), global(local.size()) {}
+    Symbol operator()(Symbol symbol);
+
+private:
+    const Interner& local;
+    std::vector<Symbol> global;
+};
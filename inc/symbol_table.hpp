@@ -21,56 +21,56 @@ struct SymbolInfo {
 };
 
 struct FunctionInfo {
-    FunctionInfo(const Modifiers& return_mods, const TypePtr return_type, const std::vector<std::pair<std::pair<Modifiers, TypePtr>, std::string>>& params) :
+    FunctionInfo(const Modifiers& return_mods, const TypePtr return_type, const std::vector<std::pair<std::pair<Modifiers, TypePtr>, Symbol>>& params) :
         return_mods(return_mods), return_type(return_type), params(params) {}
     Modifiers return_mods;
     TypePtr return_type; // Тип возвращаемого значения
-    std::vector<std::pair<std::pair<Modifiers, TypePtr>, std::string>> params; // Параметры функции (модификаторы,тип и имя)
+    std::vector<std::pair<std::pair<Modifiers, TypePtr>, Symbol>> params; // Параметры функции (модификаторы,тип и имя)
 };
 
 class SymbolTable {
 public:
     SymbolTable() = default;
 
-    void declare(const std::string& name, const SymbolInfo& info) {
+    void declare(Symbol name, const SymbolInfo& info) {
         if (_table.find(name) != _table.end()) {
-            std::cout << "Symbol '" + name + "' already declared." << std::endl;
-            //throw std::runtime_error("Symbol '" + name + "' already declared.");
+            std::cout << "Symbol '" + name.str() + "' already declared." << std::endl;
+            //throw std::runtime_error("Symbol '" + name.str() + "' already declared.");
         }
-        _table[name] = info;
+        _table.insert_or_assign(name, info);
     }
 
-    void declare(const std::string& name, const FunctionInfo& info) {
+    void declare(Symbol name, const FunctionInfo& info) {
         if (_functions.find(name) != _functions.end()) {
-            std::cout << "Function '" + name + "' is already declared." << std::endl;
-            //throw std::runtime_error("Function '" + name + "' is already declared.");
+            std::cout << "Function '" + name.str() + "' is already declared." << std::endl;
+            //throw std::runtime_error("Function '" + name.str() + "' is already declared.");
         }
-        _functions[name] = info;
+        _functions.insert_or_assign(name, info);
     }
 
-    void declare(const std::string& name, const TypedefInfo& info) {
+    void declare(Symbol name, const TypedefInfo& info) {
         if (_typedefs.find(name) != _typedefs.end()) {
-            std::cout << "Typedef '" + name + "' is already declared." << std::endl;
-            //throw std::runtime_error("Function '" + name + "' is already declared.");
+            std::cout << "Typedef '" + name.str() + "' is already declared." << std::endl;
+            //throw std::runtime_error("Function '" + name.str() + "' is already declared.");
         }
-        _typedefs[name] = info;
+        _typedefs.insert_or_assign(name, info);
     }
 
-    std::optional<SymbolInfo> lookup_var(const std::string& name) const {
+    std::optional<SymbolInfo> lookup_var(Symbol name) const {
         if (auto it = _table.find(name); it != _table.end()) {
             return it->second;
         }
         return std::nullopt; // Сигнал, что переменная не найдена
     }
 
-    std::optional<FunctionInfo> lookup_func(const std::string& name) const {
+    std::optional<FunctionInfo> lookup_func(Symbol name) const {
         if (auto it = _functions.find(name); it != _functions.end()) {
             return it->second;
         }
         return std::nullopt; // Функция не найдена
     }
 
-    std::optional<TypedefInfo> lookup_typedef(const std::string& name) const {
+    std::optional<TypedefInfo> lookup_typedef(Symbol name) const {
         if (auto it = _typedefs.find(name); it != _typedefs.end()) {
             return it->second;
         }
@@ -79,8 +79,9 @@ public:
  
 
 private:
-    std::unordered_map<std::string, SymbolInfo> _table;
-    std::unordered_map<std::string, TypedefInfo> _typedefs;
-    std::unordered_map<std::string, FunctionInfo> _functions;
+    // ключи - интернированные имена: поиск сравнивает id, а не строки
+    std::unordered_map<Symbol, SymbolInfo> _table;
+    std::unordered_map<Symbol, TypedefInfo> _typedefs;
+    std::unordered_map<Symbol, FunctionInfo> _functions;
 };
 
@@ -0,0 +1,76 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Пул потоков с общей очередью задач. Результат и исключения задачи передаются через future
+class ThreadPool {
+public:
+    explicit ThreadPool(std::size_t threads = default_threads()) {
+        if (threads == 0) threads = 1;
+        workers.reserve(threads);
+        for (std::size_t i = 0; i < threads; ++i) {
+            workers.emplace_back([this] { work(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    template <typename F>
+    std::future<std::invoke_result_t<F>> submit(F&& task) {
+        using Result = std::invoke_result_t<F>;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> result = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.emplace_back([packaged] { (*packaged)(); });
+        }
+        wake.notify_one();
+        return result;
+    }
+
+    std::size_t size() const { return workers.size(); }
+
+    static std::size_t default_threads() {
+        std::size_t threads = std::thread::hardware_concurrency();
+        return threads ? threads : 1;
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> queue;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    void work() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (queue.empty()) return;      // остановка: очередь уже разобрана
+                task = std::move(queue.front());
+                queue.pop_front();
+            }
+            task();
+        }
+    }
+};
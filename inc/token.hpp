@@ -1,8 +1,9 @@
 #pragma once
 
-#include <string>
+#include <cstdint>
+#include <string_view>
 
-enum class TokenType {
+enum class TokenType : std::uint8_t {
     TYPE_LONG, TYPE_INT, TYPE_SHORT, TYPE_CHAR, TYPE_BOOL, TYPE_VOID,
     TYPE_LONG_DOUBLE, TYPE_DOUBLE, TYPE_FLOAT, 
     
@@ -33,9 +34,10 @@ enum class TokenType {
 };
 
 
+// Лёгкое представление токена: текст - view в исходник или в декодированное хранилище TokenBuffer
 struct Token {
     TokenType type;
-    std::string value;
+    std::string_view value;
 
     bool operator==(TokenType t) const {
         return this->type == t;
@@ -0,0 +1,79 @@
+#pragma once
+#include "token.hpp"
+#include "numeric_literal.hpp"
+#include "symbol.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Буфер токенов в виде структуры массивов: вид, смещение и длина хранятся
+// в параллельных массивах, текст токена - view в исходный код.
+// Отдельное хранилище нужно строковым/символьным литералам с escape-последовательностями
+// и декодированным значениям числовых литералов.
+class TokenBuffer {
+public:
+    static constexpr std::uint32_t no_payload = UINT32_MAX;
+
+    TokenBuffer() = default;
+    explicit TokenBuffer(std::string_view source) : src(source) {}
+
+    void reserve(std::size_t count);
+    void push(TokenType type, std::size_t offset, std::size_t length);
+    void push_decoded(TokenType type, std::size_t offset, std::size_t length, std::string value);
+    void push_number(TokenType type, std::size_t offset, std::size_t length, NumericValue value);
+    void push_symbol(std::size_t offset, std::size_t length, Symbol symbol);   // идентификатор (ID)
+    void truncate(std::size_t count);   // отбросить токены начиная с count
+    // Перевести id идентификаторов, начиная с токена from, из локальной таблицы в глобальную
+    void remap_symbols(std::size_t from, SymbolRemap& remap);
+    // Дописать токены other из [from, to), сдвинув смещения на shift.
+    // Без сдвига other должен ссылаться на тот же исходник, со сдвигом - на тот же текст в новом месте
+    void append(const TokenBuffer& other, std::size_t from = 0, std::size_t to = SIZE_MAX, std::ptrdiff_t shift = 0);
+
+    std::size_t size() const { return types.size(); }
+    bool empty() const { return types.empty(); }
+    std::string_view source() const { return src; }
+
+    TokenType type(std::size_t i) const { return types[i]; }
+    std::size_t offset(std::size_t i) const { return offsets[i]; }
+    std::size_t length(std::size_t i) const { return lengths[i]; }
+    bool is_decoded(std::size_t i) const { return payloads[i] != no_payload && is_text_payload(types[i]); }
+    // Значение числового литерала (NUM_INT, NUM_DOUBLE)
+    const NumericValue& number(std::size_t i) const { return numbers[payloads[i]]; }
+    // Интернированное имя идентификатора (ID)
+    Symbol symbol(std::size_t i) const { return Symbol(payloads[i]); }
+    // Начало токена в исходнике: у строк и символов смещение указывает за открывающую кавычку
+    std::size_t start(std::size_t i) const {
+        return offsets[i] - (types[i] == TokenType::STRING || types[i] == TokenType::CHAR ? 1 : 0);
+    }
+    // Конец токена (позиция за последним символом, включая закрывающую кавычку)
+    std::size_t end(std::size_t i) const {
+        return offsets[i] + lengths[i] + (types[i] == TokenType::STRING || types[i] == TokenType::CHAR ? 1 : 0);
+    }
+
+    // Текст токена: для литералов без escape - содержимое между кавычками
+    std::string_view text(std::size_t i) const {
+        if (is_decoded(i)) return decoded[payloads[i]];
+        return src.substr(offsets[i], lengths[i]);
+    }
+
+    Token operator[](std::size_t i) const { return {types[i], text(i)}; }
+
+    // Совпадение потоков токенов: виды, позиции и текст
+    bool operator==(const TokenBuffer& other) const;
+    bool operator!=(const TokenBuffer& other) const { return !(*this == other); }
+
+private:
+    std::string_view src;
+    std::vector<TokenType> types;
+    std::vector<std::size_t> offsets;
+    std::vector<std::uint32_t> lengths;
+    // Индекс дополнительных данных токена или no_payload:
+    // для STRING/CHAR - в decoded, для NUM_INT/NUM_DOUBLE - в numbers, для ID - id символа
+    std::vector<std::uint32_t> payloads;
+    std::vector<std::string> decoded;
+    std::vector<NumericValue> numbers;
+
+    static bool is_text_payload(TokenType type) { return type == TokenType::STRING || type == TokenType::CHAR; }
+};
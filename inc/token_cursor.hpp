@@ -0,0 +1,86 @@
+#pragma once
+#include "token_buffer.hpp"
+#include <cstddef>
+
+class TokenPipeline;
+
+// Курсор парсера по потоку токенов: целиком лежащему в одном буфере или приходящему пачками
+// из TokenPipeline. Во втором случае хранятся только предыдущая, текущая и следующая пачки -
+// этого хватает для previous() и заглядывания вперёд не дальше TokenPipeline::min_batch.
+// Выход за конец возвращает последний токен (END)
+class TokenCursor {
+public:
+    explicit TokenCursor(const TokenBuffer& tokens) : current(&tokens) {}
+    // Начать с токена start; previous() и заглядывание вперёд видят весь буфер
+    TokenCursor(const TokenBuffer& tokens, std::size_t start) : current(&tokens), index(start), pos(start) {}
+    explicit TokenCursor(TokenPipeline& pipeline);
+
+    // current может указывать на собственную пачку
+    TokenCursor(const TokenCursor&) = delete;
+    TokenCursor& operator=(const TokenCursor&) = delete;
+
+    TokenType peek_type(std::size_t ahead = 0) const {
+        Slot slot = locate(ahead);
+        return slot.buffer->type(slot.index);
+    }
+    Token peek(std::size_t ahead = 0) const {
+        Slot slot = locate(ahead);
+        return (*slot.buffer)[slot.index];
+    }
+    Token previous() const {
+        Slot slot = before();
+        return (*slot.buffer)[slot.index];
+    }
+    Token advance() {
+        if (index == current->size()) step();
+        if (index == current->size()) return (*current)[index - 1];    // END
+        ++pos;
+        return (*current)[index++];
+    }
+
+    // Декодированные значения предыдущего (только что пройденного) токена
+    Symbol previous_symbol() const {
+        Slot slot = before();
+        return slot.buffer->symbol(slot.index);
+    }
+    const NumericValue& previous_number() const {
+        Slot slot = before();
+        return slot.buffer->number(slot.index);
+    }
+
+    std::size_t position() const { return pos; }
+    // Перейти к токену position; только для курсора по целому буферу
+    void seek(std::size_t position) { index = pos = position; }
+
+private:
+    struct Slot {
+        const TokenBuffer* buffer;
+        std::size_t index;
+    };
+
+    const TokenBuffer* current;
+    std::size_t index = 0;      // позиция в current
+    std::size_t pos = 0;        // позиция в потоке
+
+    // Пачки конвейера
+    TokenPipeline* pipeline = nullptr;
+    TokenBuffer before_batch;
+    TokenBuffer current_batch;
+    mutable TokenBuffer ahead_batch;    // подкачивается при заглядывании за конец текущей
+    mutable bool has_ahead = false;
+    bool has_before = false;
+
+    Slot locate(std::size_t ahead) const {
+        std::size_t i = index + ahead;
+        if (i < current->size()) return {current, i};
+        return locate_ahead(i - current->size());
+    }
+    Slot before() const {
+        if (index > 0) return {current, index - 1};
+        if (has_before) return {&before_batch, before_batch.size() - 1};
+        return {current, 0};
+    }
+    Slot locate_ahead(std::size_t i) const;
+    bool fetch() const;
+    void step();    // перейти к следующей пачке, если она есть
+};
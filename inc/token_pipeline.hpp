@@ -0,0 +1,51 @@
+#pragma once
+#include "spsc_ring.hpp"
+#include "token_buffer.hpp"
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <string_view>
+#include <thread>
+
+// Конвейер лексер -> парсер: лексер работает в своём потоке и передаёт токены пачками
+// через ограниченную очередь, поэтому разбор начинается сразу, а в памяти одновременно
+// находится не больше depth + 3 пачек. Смещения токенов в пачках - от начала исходника,
+// последняя пачка заканчивается END. Ошибка лексера передаётся потребителю из next()
+class TokenPipeline {
+public:
+    static constexpr std::size_t default_batch = 4096;
+    static constexpr std::size_t default_depth = 16;
+    // Пачка не короче предпросмотра парсера: заглядывание вперёд пересекает не больше одной границы
+    static constexpr std::size_t min_batch = 8;
+
+    explicit TokenPipeline(std::string_view input, std::size_t batch_tokens = default_batch,
+                           std::size_t depth = default_depth);
+    ~TokenPipeline();
+
+    TokenPipeline(const TokenPipeline&) = delete;
+    TokenPipeline& operator=(const TokenPipeline&) = delete;
+
+    // Следующая пачка; false - поток уже выдан целиком
+    bool next(TokenBuffer& batch);
+
+    // Статистика потребителя
+    std::size_t batches() const { return batch_count; }
+    std::size_t tokens() const { return token_count; }
+    std::size_t waits() const { return wait_count; }     // сколько раз парсер ждал лексер
+
+private:
+    std::string_view input;
+    std::size_t batch_tokens;
+    SpscRing<TokenBuffer> ring;
+    std::exception_ptr error;           // пишется до публикации пустой пачки-маркера
+    std::atomic<bool> stopping{false};
+    bool finished = false;
+    std::thread producer;
+
+    std::size_t batch_count = 0;
+    std::size_t token_count = 0;
+    std::size_t wait_count = 0;
+
+    void produce();
+    bool publish(TokenBuffer& batch);   // false - потребитель ушёл
+};
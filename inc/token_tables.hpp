@@ -0,0 +1,174 @@
+#pragma once
+#include "token.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Списки ключевых слов и операторов и распознаватели, построенные по ним на этапе компиляции:
+// совершенный хеш для ключевых слов и ДКА для операторов. Во время работы нет ни выделений
+// памяти, ни хеширования строки целиком.
+
+struct Spelling {
+    std::string_view text;
+    TokenType type;
+};
+
+inline constexpr Spelling keyword_list[] = {
+    {"short", TokenType::TYPE_SHORT}, {"int", TokenType::TYPE_INT}, {"long", TokenType::TYPE_LONG},
+    {"char", TokenType::TYPE_CHAR}, {"bool", TokenType::TYPE_BOOL}, {"void", TokenType::TYPE_VOID},
+    {"ldouble", TokenType::TYPE_LONG_DOUBLE}, {"double", TokenType::TYPE_DOUBLE}, {"float", TokenType::TYPE_FLOAT},
+
+    {"const", TokenType::KW_CONST}, {"static", TokenType::KW_STATIC},
+    {"unsigned", TokenType::KW_UNSIGNED},
+
+    {"True", TokenType::BOOL}, {"False", TokenType::BOOL},
+    {"true", TokenType::BOOL}, {"false", TokenType::BOOL},
+
+    {"struct", TokenType::KW_STRUCT},
+    {"typedef", TokenType::KW_TYPEDEF},
+    {"if", TokenType::KW_IF}, {"else", TokenType::KW_ELSE}, {"while", TokenType::KW_WHILE},
+    {"for", TokenType::KW_FOR}, {"return", TokenType::KW_RETURN}, {"break", TokenType::KW_BREAK},
+    {"continue", TokenType::KW_CONTINUE},
+
+    {"sizeof", TokenType::KW_SIZEOF},
+    {"read", TokenType::KW_READ}, {"print", TokenType::KW_PRINT},
+    {"assert", TokenType::KW_ASSERT}, {"exit", TokenType::KW_EXIT},
+};
+
+inline constexpr Spelling operator_list[] = {
+    {"+", TokenType::PLUS},   {"-", TokenType::MINUS}, {"*", TokenType::STAR},
+    {"/", TokenType::SLASH},  {"%", TokenType::MOD},   {"=", TokenType::ASSIGN},
+    {"++", TokenType::INC}, {"--", TokenType::DEC},
+    {"+=", TokenType::PLUS_ASSIGN}, {"-=", TokenType::MINUS_ASSIGN},
+    {"*=", TokenType::MULT_ASSIGN}, {"/=", TokenType::DIV_ASSIGN},
+    {"%=", TokenType::MOD_ASSIGN},
+    {"&&", TokenType::AND}, {"||", TokenType::OR}, {"!", TokenType::NOT},
+    {"==", TokenType::EQ}, {"!=", TokenType::NEQ}, {">", TokenType::GT},
+    {"<", TokenType::LT}, {">=", TokenType::GE}, {"<=", TokenType::LE},
+    {"?", TokenType::QUESTION}, {":", TokenType::COLON},
+    {";", TokenType::SEMICOLON}, {",", TokenType::COMMA}, {".", TokenType::DOT},
+    {"(", TokenType::LPAREN}, {")", TokenType::RPAREN},
+    {"{", TokenType::LBRACE},    {"}", TokenType::RBRACE},
+    {"[", TokenType::LBRACKET}, {"]", TokenType::RBRACKET},
+};
+
+namespace token_tables {
+
+// ---------------- ключевые слова: совершенный хеш ----------------
+// Хеш читает длину и три символа (первый, средний, последний), зерно подбирается при компиляции
+
+constexpr unsigned keyword_bits = 7;
+constexpr std::size_t keyword_slots = std::size_t(1) << keyword_bits;
+
+constexpr std::size_t max_keyword_length() {
+    std::size_t length = 0;
+    for (const auto& kw : keyword_list) length = kw.text.size() > length ? kw.text.size() : length;
+    return length;
+}
+
+constexpr std::uint32_t keyword_hash(std::string_view s, std::uint32_t seed) {
+    std::uint32_t h = (static_cast<std::uint32_t>(s.size()) + seed) * 0x9E3779B1u;
+    h = (h ^ static_cast<unsigned char>(s[0])) * 0x01000193u;
+    h = (h ^ static_cast<unsigned char>(s[s.size() / 2])) * 0x01000193u;
+    h = (h ^ static_cast<unsigned char>(s[s.size() - 1])) * 0x01000193u;
+    return h >> (32 - keyword_bits);
+}
+
+constexpr bool seed_is_perfect(std::uint32_t seed) {
+    std::array<bool, keyword_slots> used{};
+    for (const auto& kw : keyword_list) {
+        auto slot = keyword_hash(kw.text, seed);
+        if (used[slot]) return false;
+        used[slot] = true;
+    }
+    return true;
+}
+
+constexpr std::uint32_t find_keyword_seed() {
+    for (std::uint32_t seed = 0; seed < 100000; ++seed) {
+        if (seed_is_perfect(seed)) return seed;
+    }
+    throw "no perfect hash seed for keyword_list";
+}
+
+inline constexpr std::uint32_t keyword_seed = find_keyword_seed();
+
+struct KeywordSlot {
+    std::string_view text;
+    TokenType type = TokenType::ID;
+};
+
+constexpr std::array<KeywordSlot, keyword_slots> build_keyword_table() {
+    std::array<KeywordSlot, keyword_slots> table{};
+    for (const auto& kw : keyword_list) {
+        table[keyword_hash(kw.text, keyword_seed)] = {kw.text, kw.type};
+    }
+    return table;
+}
+
+inline constexpr auto keyword_table = build_keyword_table();
+
+// ---------------- операторы: ДКА ----------------
+// Символы операторов сжаты в классы, переход в состояние 0 означает отсутствие перехода
+
+constexpr std::size_t max_operator_states = 64;
+constexpr std::size_t max_operator_classes = 32;
+
+struct OperatorDfa {
+    std::array<std::uint8_t, 256> char_class{};
+    std::array<std::array<std::uint8_t, max_operator_classes>, max_operator_states> next{};
+    std::array<TokenType, max_operator_states> accept{};
+    std::array<bool, max_operator_states> accepting{};
+};
+
+constexpr OperatorDfa build_operator_dfa() {
+    OperatorDfa dfa{};
+    std::uint8_t classes = 1;
+    std::uint8_t states = 1;
+    for (const auto& op : operator_list) {
+        std::uint8_t state = 0;
+        for (char c : op.text) {
+            auto& cls = dfa.char_class[static_cast<unsigned char>(c)];
+            if (!cls) cls = classes++;
+            auto& next = dfa.next[state][cls];
+            if (!next) next = states++;
+            state = next;
+        }
+        if (classes > max_operator_classes || states > max_operator_states) throw "operator DFA is too large";
+        dfa.accepting[state] = true;
+        dfa.accept[state] = op.type;
+    }
+    return dfa;
+}
+
+inline constexpr OperatorDfa operator_dfa = build_operator_dfa();
+
+} // namespace token_tables
+
+// Вид токена для идентификатора: ключевое слово, BOOL или ID
+constexpr TokenType keyword_type(std::string_view name) {
+    if (name.empty() || name.size() > token_tables::max_keyword_length()) return TokenType::ID;
+    const auto& slot = token_tables::keyword_table[token_tables::keyword_hash(name, token_tables::keyword_seed)];
+    return slot.text == name ? slot.type : TokenType::ID;
+}
+
+// Самый длинный оператор, начинающийся в p; возвращает его длину (0 - не оператор)
+constexpr std::size_t match_operator(const char* p, const char* end, TokenType& type) {
+    const auto& dfa = token_tables::operator_dfa;
+    std::size_t state = 0;
+    std::size_t length = 0;
+    for (const char* q = p; q < end; ++q) {
+        auto cls = dfa.char_class[static_cast<unsigned char>(*q)];
+        if (!cls || !dfa.next[state][cls]) break;
+        state = dfa.next[state][cls];
+        if (dfa.accepting[state]) {
+            type = dfa.accept[state];
+            length = static_cast<std::size_t>(q - p) + 1;
+        }
+    }
+    return length;
+}
+
+static_assert(keyword_type("while") == TokenType::KW_WHILE, "keyword table");
+static_assert(keyword_type("whilst") == TokenType::ID, "keyword table");
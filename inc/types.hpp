@@ -1,11 +1,18 @@
 #pragma once
-#include <string>
-#include <vector>
+#include <array>
+#include <cstdint>
+#include <deque>
 #include <memory>
 #include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 #include "modifiers.hpp"
+#include "symbol.hpp"
 
-enum class TypeRank {
+enum class TypeRank : std::uint8_t {
     Bool,
     Char,
     Short,
@@ -16,39 +23,71 @@ enum class TypeRank {
     LongDouble
 };
 
+// Вид типа: классификация по тегу вместо dynamic_cast
+enum class TypeKind : std::uint8_t {
+    Void,
+    Arithmetic,
+    Array,
+    Struct
+};
+
+// Неявное преобразование значения одного типа в другой (TypeContext::conversion)
+enum class Conversion : std::uint8_t {
+    None,           // несовместимы
+    Identity,       // тот же тип с точностью до const
+    Promotion,      // расширение внутри целых или внутри вещественных
+    Arithmetic,     // остальные арифметические: сужение, целое <-> вещественное
+    Elements        // массивы с совместимыми элементами
+};
+
+class Type;
+typedef std::shared_ptr<Type> TypePtr;
+// Номер канонического типа в TypeContext (TypeContext::type); 0 - тип не известен
+typedef std::uint32_t TypeId;
+
+// Типы канонические: каждый различный тип (вместе с const) существует в TypeContext в одном
+// экземпляре, поэтому равенство типов - сравнение указателей. Тип после создания не меняется,
+// кроме полей структуры, которые задаёт TypeContext::define_struct
 class Type {
-    public:
-    Type() = default;
-    Type(bool is_const) : _is_const(is_const) {}
+public:
+    virtual ~Type() = default;
     // Метод для получения имени типа (строка)
     virtual std::string get_name() const = 0;
-    
-    // Метод для проверки совместимости типов
-    virtual bool is_compatible_with(const std::shared_ptr<Type> other) const = 0;
-    
-    bool is_const() const { return _is_const; }
 
-    virtual ~Type() = default;
+    TypeId id() const { return _id; }
+    TypeKind kind() const { return _kind; }
+    TypeRank rank() const { return _rank; }     // только у арифметических
+    bool is_const() const { return _is_const; }
+    const Type* unqualified() const { return _unqualified; }    // тот же тип без const
 
-protected:
-    bool _is_const;
-};
+    bool is_void() const { return _kind == TypeKind::Void; }
+    bool is_arithmetic() const { return _kind == TypeKind::Arithmetic; }
+    bool is_integral() const { return is_arithmetic() && _rank <= TypeRank::Long; }
+    bool is_floating() const { return is_arithmetic() && _rank >= TypeRank::Float; }
+    bool is_array() const { return _kind == TypeKind::Array; }
+    bool is_struct() const { return _kind == TypeKind::Struct; }
 
-typedef std::shared_ptr<Type> TypePtr;
+    // Метод для проверки совместимости типов: по таблице преобразований TypeContext
+    bool is_compatible_with(const TypePtr& other) const;
 
-std::shared_ptr<Type> make_type(const std::string& type_name, bool is_const = false);
-std::shared_ptr<Type> make_type_arr(const std::string& type_name, bool is_const = false);
-std::shared_ptr<Type> make_type_struct(const std::string& type_name, std::vector<std::pair<std::pair<Modifiers, TypePtr>, std::string>> members, bool is_const = false);
+protected:
+    Type(TypeKind kind, bool is_const, TypeRank rank = TypeRank::Int) : _kind(kind), _rank(rank), _is_const(is_const) {}
 
-class FundamentalType : public virtual Type {
-public:
-    virtual ~FundamentalType() = default; 
+private:
+    friend class TypeContext;
+    TypeId _id = 0;
+    TypeKind _kind;
+    TypeRank _rank;
+    bool _is_const;
+    const Type* _unqualified = this;
 };
 
-class VoidType : public FundamentalType {
+// const void не различается: make_type всегда отдаёт один void
+class VoidType : public Type {
 public:
+    static constexpr TypeKind type_kind = TypeKind::Void;
+    VoidType() : Type(type_kind, false) {}
     std::string get_name() const override { return "void"; }
-    bool is_compatible_with(const TypePtr other) const override;
 };
 
 // class NullptrType : public FundamentalType {
@@ -57,97 +96,12 @@ public:
 //     bool is_compatible_with(const Type& other) const override;
 // };
 
-class ArithmeticType : public FundamentalType {
-public:
-    bool is_compatible_with(TypePtr other) const override;
-    
-    virtual ~ArithmeticType() = default; 
-protected:
-    TypeRank rank;
-};
-
-class IntegralType : public ArithmeticType {
+// bool, char, short, int, long (целые) и float, double, ldouble (вещественные) - различаются рангом
+class ArithmeticType : public Type {
 public:
-
-    virtual ~IntegralType() = default; 
-};
-
-class BoolType : public IntegralType {
-public:
-    BoolType(bool is_const) : Type(is_const) {
-        rank = TypeRank::Bool;
-    }
-
-    std::string get_name() const override { return "bool"; }
-};
-
-class CharType : public IntegralType {
-public:
-    CharType(bool is_const) : Type(is_const) {
-        rank = TypeRank::Char;
-    }
-
-    std::string get_name() const override { return "char"; }
-};
-
-class IntType : public IntegralType {
-public:
-    IntType(bool is_const) : Type(is_const) {
-        rank = TypeRank::Int;
-    }
-    std::string get_name() const override { return "int"; }
-};
-
-class ShortIntType : public IntegralType {
-public:
-    ShortIntType(bool is_const) : Type(is_const) {
-        rank = TypeRank::Short;
-    }
-    std::string get_name() const override { return "short"; }
-};
-
-class LongIntType : public IntegralType {
-    public:
-        LongIntType(bool is_const) : Type(is_const) {
-            rank = TypeRank::Long;
-        }
-        std::string get_name() const override { return "long"; }
-    };
-
-
-class FloatingType : public ArithmeticType {
-public:
-
-    virtual ~FloatingType() = default; 
-};
-
-class FloatType : public FloatingType {
-public:
-    FloatType(bool is_const) : Type(is_const) {
-        rank = TypeRank::Float;
-    }
-    std::string get_name() const override { return "float"; }
-};
-
-class DoubleType : public FloatingType {
-public:
-    DoubleType(bool is_const) : Type(is_const) {
-        rank = TypeRank::Double;
-    }
-    std::string get_name() const override { return "double"; }
-};
-
-class LongDoubleType : public FloatingType {
-public:
-    LongDoubleType(bool is_const) : Type(is_const) {
-        rank = TypeRank::LongDouble;
-    }
-    std::string get_name() const override { return "ldouble"; }
-};
-
-class CompositeType : public virtual Type {
-public:
-    virtual ~CompositeType() = default; 
+    static constexpr TypeKind type_kind = TypeKind::Arithmetic;
+    ArithmeticType(TypeRank rank, bool is_const) : Type(type_kind, is_const, rank) {}
+    std::string get_name() const override;
 };
 
 // class FunctionType : public CompositeType {
@@ -156,39 +110,98 @@ public:
 //     bool is_compatible_with(const TypePtr other) const override;
 // };
 
-class ArrayType : public CompositeType {
+class ArrayType : public Type {
     public:
-        ArrayType(TypePtr element_type, bool is_const) : element_type(element_type), Type(is_const) {}
+        static constexpr TypeKind type_kind = TypeKind::Array;
+        ArrayType(TypePtr element_type, bool is_const) : Type(type_kind, is_const), element_type(std::move(element_type)) {}
 
         TypePtr element_type;
 
         std::string get_name() const override { return "array"; }
-        bool is_compatible_with(const TypePtr other) const override;
 };
 
-// Record Types (struct, class, union)
-class RecordType : public CompositeType {
+// Record Types (struct, class, union). Структура определяется именем: поля общие у вариантов с const и без
+class StructType : public Type {
     public:
-    virtual ~RecordType() = default; 
-};
+        using Member = std::pair<std::pair<Modifiers, TypePtr>, Symbol>;    // (модификаторы, тип), имя
+        static constexpr TypeKind type_kind = TypeKind::Struct;
+        StructType(Symbol name, bool is_const) : Type(type_kind, is_const), name(name) {}
+
+        Symbol name;
 
-class StructType : public RecordType {
-    public:
-        StructType(const std::string& name, bool is_const) : name(name) , Type(is_const) {}
-        StructType(const std::string& name, const std::vector<std::pair<std::pair<Modifiers, TypePtr>, std::string>>& members) :
-            name(name), members(members) {}
-        
-        std::string name;
-        std::vector<std::pair<std::pair<Modifiers, TypePtr>, std::string>> members; // name, type
-        
         std::string get_name() const override { return "struct"; }
 
-        std::optional<std::pair<std::pair<Modifiers, TypePtr>, std::string>> lookup_member(const std::string& member_name) const;
+        const std::vector<Member>& members() const { return static_cast<const StructType*>(unqualified())->fields; }
+        std::optional<Member> lookup_member(Symbol member_name) const;
 
-        bool is_compatible_with(const TypePtr other) const override;
+    private:
+        friend class TypeContext;
+        std::vector<Member> fields;     // заполнены только у варианта без const
+};
 
+// Приведение по тегу вида вместо dynamic_pointer_cast; nullptr, если вид другой
+template <typename T>
+const T* type_cast(const TypePtr& type) {
+    return type && type->kind() == T::type_kind ? static_cast<const T*>(type.get()) : nullptr;
+}
+
+// Таблица канонических типов. Фундаментальные создаются заранее и выдаются без блокировок,
+// массивы и структуры - при первом обращении, сразу парой "без const" и "const".
+// Совместимость и общий тип арифметических операндов берутся из таблиц, посчитанных при компиляции.
+// Типы живут до конца программы, как и глобальная таблица имён. Потокобезопасна
+class TypeContext {
+public:
+    TypeContext();
+    TypeContext(const TypeContext&) = delete;
+    TypeContext& operator=(const TypeContext&) = delete;
+
+    TypePtr void_type() const { return _void; }
+    TypePtr arithmetic(TypeRank rank, bool is_const = false) const {
+        return _arithmetic[is_const][static_cast<std::size_t>(rank)];
+    }
+    // Тип по ключевому слову (int, ldouble, void...); nullptr - не фундаментальный
+    TypePtr fundamental(std::string_view name, bool is_const = false) const;
+    // Фундаментальный или, для любого другого имени, структура с этим именем
+    TypePtr named(std::string_view name, bool is_const = false);
+    TypePtr array_of(const TypePtr& element, bool is_const = false);
+    TypePtr struct_type(Symbol name, bool is_const = false);
+    // Задаёт поля структуры name (вариант без const); повторное определение заменяет поля
+    TypePtr define_struct(Symbol name, std::vector<StructType::Member> members);
+    // Тот же тип с другим const
+    TypePtr qualified(const TypePtr& type, bool is_const);
+    // Тип по номеру Type::id; для 0 - пустой указатель. Ссылка действительна до конца программы
+    const TypePtr& type(TypeId id) const;
+
+    // Преобразование значения типа from в тип to
+    static Conversion conversion(const Type& from, const Type& to);
+    static bool compatible(const Type& a, const Type& b) { return conversion(b, a) != Conversion::None; }
+    // Тип результата арифметической операции (обычные арифметические преобразования:
+    // bool, char и short расширяются до int, затем берётся старший ранг); nullptr - не оба арифметические
+    TypePtr common_type(const Type& a, const Type& b) const;
+
+    std::size_t size() const;   // различных типов
+
+private:
+    TypePtr _void;
+    std::array<std::array<TypePtr, 8>, 2> _arithmetic;    // [const][ранг]
+
+    mutable std::shared_mutex mutex;
+    std::unordered_map<const Type*, std::array<TypePtr, 2>> arrays;     // по элементу: [const]
+    std::unordered_map<Symbol, std::array<TypePtr, 2>> structs;
+    std::deque<TypePtr> ids;    // [Type::id], в начале пустой на месте 0; deque не двигает элементы
+
+    void number(const TypePtr& type);
+    template <typename T, typename Key, typename... Args>
+    TypePtr canonical(std::unordered_map<Key, std::array<TypePtr, 2>>& table, const Key& key, bool is_const, Args&&... args);
 };
 
+// Общая таблица типов: парсер, кэш AST и семантический анализ
+TypeContext& type_context();
+
+std::shared_ptr<Type> make_type(std::string_view type_name, bool is_const = false);
+std::shared_ptr<Type> make_type_arr(std::string_view type_name, bool is_const = false);
+std::shared_ptr<Type> make_type_struct(const std::string& type_name, std::vector<StructType::Member> members);
+
 // class ClassType : public RecordType {
 // public:
 //     std::string get_name() const override { return "class"; }
@@ -1,7 +1,9 @@
 #pragma once
+#include "flat_ast.hpp"
 #include "visitor.hpp"
 
-struct PrintVisitor : ASTVisitor {
+// Печать дерева указателей и плоской формы (FlatAST::accept) в одном формате
+struct PrintVisitor : ASTVisitor, FlatVisitor {
     void visit(LiteralExpr& expr) override;
     void visit(IdExpr& expr) override;
     void visit(BinaryExpr& expr) override;
@@ -15,6 +17,7 @@ struct PrintVisitor : ASTVisitor {
     void visit(PostfixExpr& expr) override;
     void visit(AssignExpr& expr) override;
     void visit(ArrayInitExpr& expr) override;
+    void visit(CastExpr& expr) override;
 
     void visit(ExprStmt& stmt) override;
     void visit(BlockStmt& stmt) override;
@@ -35,4 +38,10 @@ struct PrintVisitor : ASTVisitor {
     void visit(TypedefDecl& decl) override;
 
     void visit(TranslationUnitNode& node) override;
+
+    void visit(FlatNode node) override;
+
+private:
+    // Дети node через separator
+    void visit_children(FlatNode node, const char* separator);
 };
\ No newline at end of file
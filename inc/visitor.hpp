@@ -1,6 +1,10 @@
 #pragma once
 #include "ast.hpp"
+#include <stdexcept>
+#include <string>
+#include <type_traits>
 
+// Двойная диспетчеризация через ASTNode::accept: проходы, которым нужен полиморфный посетитель
 struct ASTVisitor {
     virtual void visit(LiteralExpr& expr) = 0;
     virtual void visit(IdExpr& expr) = 0;
@@ -15,6 +19,7 @@ struct ASTVisitor {
     virtual void visit(PostfixExpr& expr) = 0;
     virtual void visit(AssignExpr& expr) = 0;
     virtual void visit(ArrayInitExpr& expr) = 0;
+    virtual void visit(CastExpr& expr) = 0;
 
     virtual void visit(ExprStmt& stmt) = 0;
     virtual void visit(BlockStmt& stmt) = 0;
@@ -39,3 +44,126 @@ struct ASTVisitor {
     virtual ~ASTVisitor() = default;
 };
 
+
+// Вызвать f с узлом, приведённым к его классу по node.kind: switch вместо виртуального вызова,
+// f - обобщённая лямбда или объект с перегрузками для всех классов узлов
+template <typename F>
+decltype(auto) dispatch(ASTNode& node, F&& f) {
+    switch (node.kind) {
+        case NodeKind::Literal: return f(static_cast<LiteralExpr&>(node));
+        case NodeKind::Id: return f(static_cast<IdExpr&>(node));
+        case NodeKind::Binary: return f(static_cast<BinaryExpr&>(node));
+        case NodeKind::Logical: return f(static_cast<LogicalExpr&>(node));
+        case NodeKind::Assign: return f(static_cast<AssignExpr&>(node));
+        case NodeKind::Unary: return f(static_cast<UnaryExpr&>(node));
+        case NodeKind::Postfix: return f(static_cast<PostfixExpr&>(node));
+        case NodeKind::Sizeof: return f(static_cast<SizeofExpr&>(node));
+        case NodeKind::Ternary: return f(static_cast<TernaryExpr&>(node));
+        case NodeKind::Call: return f(static_cast<CallExpr&>(node));
+        case NodeKind::MemberAccess: return f(static_cast<MemberAccessExpr&>(node));
+        case NodeKind::ArrayAccess: return f(static_cast<ArrayAccessExpr&>(node));
+        case NodeKind::ArrayInit: return f(static_cast<ArrayInitExpr&>(node));
+        case NodeKind::Cast: return f(static_cast<CastExpr&>(node));
+
+        case NodeKind::ExprStmt: return f(static_cast<ExprStmt&>(node));
+        case NodeKind::Block: return f(static_cast<BlockStmt&>(node));
+        case NodeKind::If: return f(static_cast<IfStmt&>(node));
+        case NodeKind::While: return f(static_cast<WhileStmt&>(node));
+        case NodeKind::For: return f(static_cast<ForStmt&>(node));
+        case NodeKind::Return: return f(static_cast<ReturnStmt&>(node));
+        case NodeKind::Break: return f(static_cast<BreakStmt&>(node));
+        case NodeKind::Continue: return f(static_cast<ContinueStmt&>(node));
+        case NodeKind::Print: return f(static_cast<PrintStmt&>(node));
+        case NodeKind::Read: return f(static_cast<ReadStmt&>(node));
+        case NodeKind::Exit: return f(static_cast<ExitStmt&>(node));
+
+        case NodeKind::VarDecl: return f(static_cast<VarDecl&>(node));
+        case NodeKind::StructDecl: return f(static_cast<StructDecl&>(node));
+        case NodeKind::FunctionDecl: return f(static_cast<FunctionDecl&>(node));
+        case NodeKind::AssertDecl: return f(static_cast<AssertDecl&>(node));
+        case NodeKind::TypedefDecl: return f(static_cast<TypedefDecl&>(node));
+
+        case NodeKind::TranslationUnit: return f(static_cast<TranslationUnitNode&>(node));
+        default: break;     // None, Variable, ArrayVariable - только в плоской форме
+    }
+    throw std::runtime_error("Bad AST node kind: " + std::to_string(static_cast<unsigned>(node.kind)));
+}
+
+// Вызвать f(ASTNode*) для каждого ребёнка узла слева направо; пустые рёбра передаются как nullptr
+template <typename Node, typename F>
+void for_each_child(Node& node, F&& f) {
+    if constexpr (std::is_base_of_v<BinaryExpr, Node>) {
+        f(node.left);
+        f(node.right);
+    } else if constexpr (std::is_same_v<Node, SizeofExpr>) {
+        f(node.operand);
+        if (auto type = std::get_if<ExprPtr>(&node.type)) f(*type);
+    } else if constexpr (std::is_base_of_v<UnaryExpr, Node> || std::is_same_v<Node, CastExpr>) {
+        f(node.operand);
+    } else if constexpr (std::is_same_v<Node, TernaryExpr>) {
+        f(node.cond);
+        f(node.true_expr);
+        f(node.false_expr);
+    } else if constexpr (std::is_same_v<Node, CallExpr>) {
+        f(node.callee);
+        for (auto arg : node.args) f(arg);
+    } else if constexpr (std::is_same_v<Node, MemberAccessExpr>) {
+        f(node.object);
+        f(node.member);
+    } else if constexpr (std::is_same_v<Node, ArrayAccessExpr>) {
+        f(node.array);
+        f(node.index);
+    } else if constexpr (std::is_same_v<Node, ArrayInitExpr>) {
+        for (auto element : node.elements) f(element);
+    } else if constexpr (std::is_same_v<Node, BlockStmt>) {
+        for (auto statement : node.statements) f(statement);
+    } else if constexpr (std::is_same_v<Node, IfStmt>) {
+        f(node.condition);
+        f(node.then_branch);
+        f(node.else_branch);
+    } else if constexpr (std::is_same_v<Node, WhileStmt>) {
+        f(node.condition);
+        f(node.body);
+    } else if constexpr (std::is_same_v<Node, ForStmt>) {
+        f(node.init);
+        f(node.condition);
+        f(node.increment);
+        f(node.body);
+    } else if constexpr (std::is_same_v<Node, PrintStmt>) {
+        for (auto expr : node.expr) f(expr);
+    } else if constexpr (std::is_same_v<Node, ExprStmt> || std::is_same_v<Node, ReturnStmt> ||
+                         std::is_same_v<Node, ReadStmt> || std::is_same_v<Node, ExitStmt> ||
+                         std::is_same_v<Node, AssertDecl>) {
+        f(node.expr);
+    } else if constexpr (std::is_same_v<Node, VarDecl>) {
+        for (auto& variable : node.variables) {
+            f(variable.init);
+            f(variable.size);
+        }
+    } else if constexpr (std::is_same_v<Node, StructDecl>) {
+        for (auto& field : node.fields) f(&field);
+    } else if constexpr (std::is_same_v<Node, FunctionDecl>) {
+        f(node.get_body());
+    } else if constexpr (std::is_same_v<Node, TranslationUnitNode>) {
+        for (auto decl : node.decls) f(decl);
+    }
+    // LiteralExpr, IdExpr, BreakStmt, ContinueStmt, TypedefDecl - без детей
+}
+
+// Обход с выбором метода во время компиляции (CRTP). Derived объявляет visit (не виртуальные) для нужных
+// ему классов узлов и пишет using StaticVisitor<Derived>::visit; остальные узлы просто обходят детей.
+// Вызовы visit разрешаются статически и встраиваются - в отличие от двойной диспетчеризации ASTVisitor
+template <typename Derived>
+struct StaticVisitor {
+    void walk(ASTNode* node) {
+        if (node) dispatch(*node, [this](auto& n) { static_cast<Derived*>(this)->visit(n); });
+    }
+
+    template <typename Node>
+    void visit(Node& node) { walk_children(node); }
+
+    template <typename Node>
+    void walk_children(Node& node) {
+        for_each_child(node, [this](ASTNode* child) { walk(child); });
+    }
+};
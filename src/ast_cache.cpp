@@ -0,0 +1,560 @@
+#include "ast_cache.hpp"
+#include "source_buffer.hpp"
+#include "types.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+
+namespace {
+
+constexpr std::string_view magic = "IASTCACH";
+constexpr std::size_t max_type_depth = 64;
+
+// Платформа, на которой записан файл: числа и long double хранятся в её представлении
+std::uint32_t abi_tag() {
+    std::uint16_t probe = 1;
+    unsigned char little = 0;
+    std::memcpy(&little, &probe, 1);
+    return static_cast<std::uint32_t>(sizeof(long double) | sizeof(long) << 8 | little << 16);
+}
+
+std::uint64_t mix(std::uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+class Writer {
+public:
+    std::string bytes;
+
+    template <typename T>
+    void put(T value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    void put_string(std::string_view text) {
+        put(static_cast<std::uint32_t>(text.size()));
+        bytes.append(text);
+    }
+    template <typename T>
+    void put_array(const std::vector<T>& values) {
+        bytes.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+};
+
+// Чтение с проверкой границ: выход за конец данных - исключение, а не чтение чужой памяти
+class Reader {
+public:
+    explicit Reader(std::string_view bytes) : bytes(bytes) {}
+
+    std::string_view take(std::size_t size) {
+        if (size > bytes.size() - pos) throw std::runtime_error("Corrupted AST cache: unexpected end of data");
+        std::string_view result = bytes.substr(pos, size);
+        pos += size;
+        return result;
+    }
+    template <typename T>
+    T get() {
+        T value;
+        std::memcpy(&value, take(sizeof(T)).data(), sizeof(T));
+        return value;
+    }
+    std::string get_string() { return std::string(take(get<std::uint32_t>())); }
+    // Число элементов; каждый занимает не меньше min_size байт, так что огромное число
+    // из повреждённого файла отсекается до выделения памяти
+    std::uint32_t get_count(std::size_t min_size) {
+        auto count = get<std::uint32_t>();
+        if (count > (bytes.size() - pos) / min_size) throw std::runtime_error("Corrupted AST cache: bad element count");
+        return count;
+    }
+    template <typename T>
+    void get_array(std::vector<T>& values, std::size_t count) {
+        std::string_view raw = take(count * sizeof(T));
+        values.resize(count);
+        std::memcpy(values.data(), raw.data(), raw.size());
+    }
+
+    std::size_t position() const { return pos; }
+    bool done() const { return pos == bytes.size(); }
+
+private:
+    std::string_view bytes;
+    std::size_t pos = 0;
+};
+
+[[noreturn]] void corrupted(const std::string& what) { throw std::runtime_error("Corrupted AST cache: " + what); }
+
+enum class TypeTag : std::uint8_t { Null, Fundamental, Array, Struct };
+
+// Запись: имена переводятся в плотные локальные номера, таблица написаний идёт перед данными
+class Encoder {
+public:
+    Writer out;
+
+    std::uint32_t symbol(Symbol name) {
+        if (!name.valid()) return Symbol::none;
+        auto [it, added] = local.try_emplace(name.id, static_cast<std::uint32_t>(spellings.size()));
+        if (added) spellings.push_back(name);
+        return it->second;
+    }
+    void put_symbol(Symbol name) { out.put(symbol(name)); }
+
+    void put_modifiers(const Modifiers& modifiers) {
+        std::uint8_t mask = 0;
+        for (Modifier modifier : modifiers.mods) mask |= 1u << static_cast<unsigned>(modifier);
+        out.put(mask);
+    }
+
+    void put_type(const TypePtr& type) {
+        if (!type) {
+            out.put(TypeTag::Null);
+        } else if (auto array = type_cast<ArrayType>(type)) {
+            out.put(TypeTag::Array);
+            out.put<std::uint8_t>(array->is_const());
+            put_type(array->element_type);
+        } else if (auto record = type_cast<StructType>(type)) {
+            out.put(TypeTag::Struct);
+            out.put_string(record->name.str());
+            out.put<std::uint8_t>(record->is_const());
+            out.put(static_cast<std::uint32_t>(record->members().size()));
+            for (const auto& member : record->members()) put_member(member);
+        } else {
+            out.put(TypeTag::Fundamental);
+            out.put_string(type->get_name());
+            out.put<std::uint8_t>(type->is_const());
+        }
+    }
+
+    void put_member(const std::pair<std::pair<Modifiers, TypePtr>, Symbol>& member) {
+        put_modifiers(member.first.first);
+        put_type(member.first.second);
+        put_symbol(member.second);
+    }
+
+    void put_literal(const LiteralExpr::Value& value) {
+        out.put(static_cast<std::uint8_t>(value.index()));
+        std::visit([&](const auto& v) {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, std::string>) out.put_string(v);
+            else if constexpr (std::is_same_v<T, bool>) out.put<std::uint8_t>(v);
+            else out.put(v);
+        }, value);
+    }
+
+    std::string finish() {
+        Writer table;
+        table.put(static_cast<std::uint32_t>(spellings.size()));
+        for (Symbol name : spellings) table.put_string(name.str());
+        return table.bytes + out.bytes;
+    }
+
+private:
+    std::unordered_map<std::uint32_t, std::uint32_t> local;
+    std::vector<Symbol> spellings;
+};
+
+class Decoder {
+public:
+    Reader in;
+    std::vector<Symbol> symbols;
+
+    explicit Decoder(std::string_view payload) : in(payload) {
+        std::uint32_t count = in.get_count(sizeof(std::uint32_t));
+        symbols.reserve(count);
+        for (std::uint32_t i = 0; i < count; ++i) symbols.push_back(intern(in.get_string()));
+    }
+
+    Symbol symbol(std::uint32_t local) {
+        if (local == Symbol::none) return Symbol();
+        if (local >= symbols.size()) corrupted("bad name index");
+        return symbols[local];
+    }
+    Symbol get_symbol() { return symbol(in.get<std::uint32_t>()); }
+
+    Modifiers get_modifiers() {
+        auto mask = in.get<std::uint8_t>();
+        if (mask >> 3) corrupted("bad modifiers");
+        Modifiers modifiers;
+        for (auto modifier : {Modifier::Const, Modifier::Static, Modifier::Unsigned}) {
+            if (mask & 1u << static_cast<unsigned>(modifier)) modifiers.add(modifier);
+        }
+        return modifiers;
+    }
+
+    bool get_flag() {
+        auto flag = in.get<std::uint8_t>();
+        if (flag > 1) corrupted("bad flag");
+        return flag;
+    }
+
+    TypePtr get_type(std::size_t depth = 0) {
+        if (depth > max_type_depth) corrupted("type nesting is too deep");
+        auto tag = in.get<TypeTag>();
+        switch (tag) {
+            case TypeTag::Null: return nullptr;
+            case TypeTag::Array: {
+                bool is_const = get_flag();
+                return type_context().array_of(get_type(depth + 1), is_const);
+            }
+            case TypeTag::Struct: {
+                Symbol name = intern(in.get_string());
+                bool is_const = get_flag();
+                std::uint32_t count = in.get_count(2 + sizeof(std::uint32_t));
+                if (count == 0) return type_context().struct_type(name, is_const);
+                std::vector<StructType::Member> members;
+                for (std::uint32_t i = 0; i < count; ++i) members.push_back(get_member(depth + 1));
+                return type_context().qualified(type_context().define_struct(name, std::move(members)), is_const);
+            }
+            case TypeTag::Fundamental: {
+                std::string name = in.get_string();
+                if (auto type = type_context().fundamental(name, get_flag())) return type;
+                corrupted("unknown type '" + name + "'");
+            }
+        }
+        corrupted("bad type tag");
+    }
+
+    std::pair<std::pair<Modifiers, TypePtr>, Symbol> get_member(std::size_t depth = 0) {
+        Modifiers modifiers = get_modifiers();
+        TypePtr type = get_type(depth);
+        return {{modifiers, type}, get_symbol()};
+    }
+
+    template <std::size_t I = 0>
+    LiteralExpr::Value get_literal_value(std::size_t index) {
+        if constexpr (I == std::variant_size_v<LiteralExpr::Value>) {
+            corrupted("bad literal type");
+        } else {
+            using T = std::variant_alternative_t<I, LiteralExpr::Value>;
+            if (index != I) return get_literal_value<I + 1>(index);
+            if constexpr (std::is_same_v<T, std::string>) return in.get_string();
+            else if constexpr (std::is_same_v<T, bool>) return get_flag();
+            else return in.get<T>();
+        }
+    }
+    LiteralExpr::Value get_literal() { return get_literal_value(in.get<std::uint8_t>()); }
+};
+
+constexpr std::uint64_t bit(NodeKind kind) { return 1ull << static_cast<unsigned>(kind); }
+
+constexpr std::uint64_t bits(NodeKind first, NodeKind last) {
+    std::uint64_t mask = 0;
+    for (auto k = static_cast<unsigned>(first); k <= static_cast<unsigned>(last); ++k) mask |= 1ull << k;
+    return mask;
+}
+
+// Допустимые виды детей: пустое ребро (None) разрешено везде, кроме полей структуры
+constexpr std::uint64_t expr_kinds = bit(NodeKind::None) | bits(NodeKind::Literal, NodeKind::ArrayInit) | bit(NodeKind::Cast);
+constexpr std::uint64_t stmt_kinds = bit(NodeKind::None) | bits(NodeKind::ExprStmt, NodeKind::Exit);
+constexpr std::uint64_t decl_kinds = bit(NodeKind::None) | bits(NodeKind::VarDecl, NodeKind::TypedefDecl);
+
+// Форма узла: обязательные первые дети и вид остальных (0 - других детей нет)
+struct Shape {
+    std::uint32_t fixed;
+    std::uint64_t child[4];
+    std::uint64_t rest;
+};
+
+Shape shape(NodeKind kind) {
+    constexpr std::uint64_t E = expr_kinds;
+    constexpr std::uint64_t S = stmt_kinds;
+    constexpr std::uint64_t D = decl_kinds;
+    switch (kind) {
+        case NodeKind::Binary: case NodeKind::Logical: case NodeKind::Assign: case NodeKind::Sizeof:
+        case NodeKind::MemberAccess: case NodeKind::ArrayAccess:
+        case NodeKind::Variable: case NodeKind::ArrayVariable:
+            return {2, {E, E}, 0};
+        case NodeKind::Unary: case NodeKind::Postfix: case NodeKind::Cast:
+        case NodeKind::Return: case NodeKind::Read: case NodeKind::Exit: case NodeKind::AssertDecl:
+            return {1, {E}, 0};
+        case NodeKind::Ternary: return {3, {E, E, E}, 0};
+        case NodeKind::Call: return {1, {E}, E};
+        case NodeKind::ArrayInit: case NodeKind::Print: return {0, {}, E};
+        case NodeKind::ExprStmt: return {1, {E | S | D}, 0};
+        case NodeKind::Block: return {0, {}, S};
+        case NodeKind::If: return {3, {E, S, S}, 0};
+        case NodeKind::While: return {2, {E, S}, 0};
+        case NodeKind::For: return {4, {D, E, E, S}, 0};
+        case NodeKind::VarDecl: return {0, {}, bit(NodeKind::Variable) | bit(NodeKind::ArrayVariable)};
+        case NodeKind::StructDecl: return {0, {}, bit(NodeKind::VarDecl)};
+        case NodeKind::FunctionDecl: return {1, {bit(NodeKind::None) | bit(NodeKind::Block)}, 0};
+        case NodeKind::TranslationUnit: return {0, {}, D};
+        default: return {0, {}, 0};
+    }
+}
+
+// Структура дерева и индексы в боковые таблицы: после проверки expand() и обходы
+// не выходят за массивы и не приводят узлы к чужим классам
+void validate(const FlatAST& flat, const ConstantPool& literals, const std::vector<std::uint32_t>& expr_types,
+              const std::vector<std::size_t>& tables) {
+    std::uint32_t size = static_cast<std::uint32_t>(flat.size());
+    if (size == 0 || flat.kind(0) != NodeKind::TranslationUnit || flat.end(0) != size) corrupted("bad root");
+
+    struct Open {
+        std::uint32_t node;
+        std::uint32_t children;
+    };
+    std::vector<Open> stack;
+    auto close = [&] {
+        Open top = stack.back();
+        stack.pop_back();
+        if (top.children < shape(flat.kind(top.node)).fixed) corrupted("missing child node");
+    };
+
+    for (std::uint32_t i = 0; i < size; ++i) {
+        NodeKind kind = flat.kind(i);
+        if (static_cast<unsigned>(kind) > static_cast<unsigned>(NodeKind::Cast)) corrupted("bad node kind");
+        if (flat.end(i) <= i || flat.end(i) > size) corrupted("bad subtree end");
+        if (kind == NodeKind::None && flat.end(i) != i + 1) corrupted("empty edge with children");
+
+        while (!stack.empty() && flat.end(stack.back().node) <= i) close();
+        if (i > 0) {
+            if (stack.empty()) corrupted("node outside of the root");
+            Open& parent = stack.back();
+            if (flat.end(i) > flat.end(parent.node)) corrupted("subtree crosses its parent");
+            Shape form = shape(flat.kind(parent.node));
+            std::uint64_t allowed = parent.children < form.fixed ? form.child[parent.children] : form.rest;
+            if (!(allowed & bit(kind))) corrupted("unexpected child node");
+            ++parent.children;
+        }
+        stack.push_back({i, 0});
+
+        std::uint32_t data = flat.data(i);
+        std::size_t limit = SIZE_MAX;
+        switch (kind) {
+            case NodeKind::Literal:
+                if (!literals.contains(ConstantPool::unpack(data))) corrupted("bad constant");
+                break;
+            case NodeKind::Binary: case NodeKind::Logical: case NodeKind::Assign:
+            case NodeKind::Unary: case NodeKind::Postfix: limit = tables[0]; break;
+            case NodeKind::Sizeof: if (data != FlatAST::no_data) limit = tables[1]; break;
+            case NodeKind::Cast: limit = tables[1]; break;
+            case NodeKind::VarDecl: limit = tables[2]; break;
+            case NodeKind::FunctionDecl: limit = tables[3]; break;
+            case NodeKind::TypedefDecl: limit = tables[4]; break;
+            case NodeKind::AssertDecl: limit = tables[5]; break;
+            default: break;
+        }
+        if (data >= limit) corrupted("bad table index");
+
+        if (!expr_types.empty() && expr_types[i] != FlatAST::no_data) {
+            if (kind == NodeKind::None || !is_kind_of<Expr>(kind)) corrupted("type of a non-expression");
+            if (expr_types[i] >= tables[1]) corrupted("bad expression type index");
+        }
+    }
+    while (!stack.empty()) close();
+}
+
+bool holds_symbol(NodeKind kind) {
+    return kind == NodeKind::Id || kind == NodeKind::Variable || kind == NodeKind::ArrayVariable ||
+           kind == NodeKind::StructDecl;
+}
+
+} // namespace
+
+AstCache::AstCache(std::string directory) : directory(std::move(directory)) {}
+
+std::uint64_t AstCache::hash(std::string_view bytes, std::uint64_t seed) {
+    constexpr std::uint64_t multiplier = 0x9e3779b97f4a7c15ull;
+    std::uint64_t h = seed ^ (bytes.size() * multiplier);
+    std::size_t i = 0;
+    for (; i + 8 <= bytes.size(); i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, bytes.data() + i, 8);
+        h = (h ^ mix(word)) * multiplier;
+    }
+    std::uint64_t tail = 0;
+    std::memcpy(&tail, bytes.data() + i, bytes.size() - i);
+    return mix(h ^ mix(tail));
+}
+
+std::uint64_t AstCache::key(std::string_view source) {
+    return hash(source, hash(interpreter_version) ^ format_version);
+}
+
+std::string AstCache::path(std::string_view source) const {
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << key(source) << ".ast";
+    return (std::filesystem::path(directory) / name.str()).string();
+}
+
+std::string AstCache::encode(const FlatAST& flat, std::string_view source) {
+    Encoder encoder;
+    Writer& out = encoder.out;
+
+    std::vector<std::uint32_t> datas = flat.datas;
+    for (std::uint32_t i = 0; i < datas.size(); ++i) {
+        if (holds_symbol(flat.kinds[i])) datas[i] = encoder.symbol(Symbol(datas[i]));
+    }
+    out.put(static_cast<std::uint32_t>(flat.size()));
+    out.put_array(flat.kinds);
+    out.put_array(flat.ends);
+    out.put_array(datas);
+
+    // Константы по видам и индексам: при чтении add выдаёт им те же ссылки
+    out.put(static_cast<std::uint32_t>(flat.literals.size()));
+    for (std::uint8_t type = 0; type < ConstantPool::type_count; ++type) {
+        for (std::uint32_t i = 0; i < flat.literals.count(type); ++i) encoder.put_literal(flat.literals.get({i, type}));
+    }
+    out.put(static_cast<std::uint32_t>(flat.operators.size()));
+    for (const auto& op : flat.operators) out.put_string(op);
+    out.put(static_cast<std::uint32_t>(flat.types.size()));
+    for (const auto& type : flat.types) encoder.put_type(type);
+    out.put(static_cast<std::uint32_t>(flat.var_types.size()));
+    for (const auto& info : flat.var_types) {
+        encoder.put_type(info.type);
+        encoder.put_modifiers(info.modifiers);
+    }
+    out.put(static_cast<std::uint32_t>(flat.functions.size()));
+    for (const auto& info : flat.functions) {
+        encoder.put_modifiers(info.return_mods);
+        encoder.put_type(info.return_type);
+        encoder.put_symbol(info.name);
+        out.put(static_cast<std::uint32_t>(info.params.size()));
+        for (const auto& param : info.params) encoder.put_member(param);
+    }
+    out.put(static_cast<std::uint32_t>(flat.typedefs.size()));
+    for (const auto& info : flat.typedefs) {
+        encoder.put_modifiers(info.modifiers);
+        encoder.put_type(info.type);
+        encoder.put_symbol(info.alias);
+    }
+    out.put(static_cast<std::uint32_t>(flat.messages.size()));
+    for (const auto& message : flat.messages) out.put_string(message);
+    // Типы выражений проверенного дерева: 0 или по одному на узел
+    out.put(static_cast<std::uint32_t>(flat.expr_types.size()));
+    out.put_array(flat.expr_types);
+
+    std::string payload = encoder.finish();
+    Writer file;
+    file.bytes.append(magic);
+    file.put(format_version);
+    file.put(abi_tag());
+    file.put(key(source));
+    file.put(static_cast<std::uint64_t>(source.size()));
+    file.put(static_cast<std::uint64_t>(payload.size()));
+    file.put(hash(payload));
+    return file.bytes + payload;
+}
+
+FlatAST AstCache::decode(std::string_view file, std::string_view source) {
+    Reader header(file);
+    if (header.take(magic.size()) != magic) throw std::runtime_error("Not an AST cache file");
+    if (header.get<std::uint32_t>() != format_version) throw std::runtime_error("AST cache format version differs");
+    if (header.get<std::uint32_t>() != abi_tag()) throw std::runtime_error("AST cache was written on another platform");
+    auto file_key = header.get<std::uint64_t>();
+    auto source_size = header.get<std::uint64_t>();
+    if (source_size != source.size() || file_key != key(source)) throw std::runtime_error("AST cache is for another source");
+    auto payload_size = header.get<std::uint64_t>();
+    auto checksum = header.get<std::uint64_t>();
+    std::string_view payload = file.substr(header.position());
+    if (payload.size() != payload_size) corrupted("file size does not match");
+    if (hash(payload) != checksum) corrupted("checksum mismatch");
+
+    Decoder decoder(payload);
+    Reader& in = decoder.in;
+    FlatAST flat;
+    std::uint32_t size = in.get_count(sizeof(NodeKind) + 2 * sizeof(std::uint32_t));
+    in.get_array(flat.kinds, size);
+    in.get_array(flat.ends, size);
+    in.get_array(flat.datas, size);
+
+    std::uint32_t count = in.get_count(1);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        LiteralExpr::Value value = decoder.get_literal();
+        auto type = static_cast<std::uint8_t>(value.index());
+        Constant expected{static_cast<std::uint32_t>(flat.literals.count(type)), type};
+        if (flat.literals.add(value) != expected) corrupted("duplicate constant");
+    }
+    count = in.get_count(sizeof(std::uint32_t));
+    for (std::uint32_t i = 0; i < count; ++i) flat.operators.push_back(in.get_string());
+    count = in.get_count(1);
+    for (std::uint32_t i = 0; i < count; ++i) flat.types.push_back(decoder.get_type());
+    count = in.get_count(2);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        TypePtr type = decoder.get_type();
+        flat.var_types.push_back({type, decoder.get_modifiers()});
+    }
+    count = in.get_count(2 + 2 * sizeof(std::uint32_t));
+    for (std::uint32_t i = 0; i < count; ++i) {
+        FlatAST::Function info;
+        info.return_mods = decoder.get_modifiers();
+        info.return_type = decoder.get_type();
+        info.name = decoder.get_symbol();
+        std::uint32_t params = in.get_count(2 + sizeof(std::uint32_t));
+        for (std::uint32_t p = 0; p < params; ++p) info.params.push_back(decoder.get_member());
+        flat.functions.push_back(std::move(info));
+    }
+    count = in.get_count(2 + sizeof(std::uint32_t));
+    for (std::uint32_t i = 0; i < count; ++i) {
+        Modifiers modifiers = decoder.get_modifiers();
+        TypePtr type = decoder.get_type();
+        flat.typedefs.push_back({modifiers, type, decoder.get_symbol()});
+    }
+    count = in.get_count(sizeof(std::uint32_t));
+    for (std::uint32_t i = 0; i < count; ++i) flat.messages.push_back(in.get_string());
+    count = in.get_count(sizeof(std::uint32_t));
+    if (count != 0 && count != size) corrupted("bad expression type count");
+    in.get_array(flat.expr_types, count);
+    if (!in.done()) corrupted("trailing data");
+
+    validate(flat, flat.literals, flat.expr_types, {flat.operators.size(), flat.types.size(), flat.var_types.size(),
+                    flat.functions.size(), flat.typedefs.size(), flat.messages.size()});
+    for (std::uint32_t i = 0; i < size; ++i) {
+        if (holds_symbol(flat.kinds[i])) flat.datas[i] = decoder.symbol(flat.datas[i]).id;
+    }
+    return flat;
+}
+
+bool AstCache::load(std::string_view source, FlatAST& flat) {
+    std::string file_path = path(source);
+    std::error_code error;
+    if (!std::filesystem::is_regular_file(file_path, error)) {
+        reason = "no cache file";
+        return false;
+    }
+    try {
+        SourceBuffer file = SourceBuffer::open(file_path);
+        flat = decode(file.view(), source);
+    } catch (const std::exception& e) {
+        reason = e.what();
+        return false;
+    }
+    reason.clear();
+    return true;
+}
+
+bool AstCache::store(std::string_view source, const FlatAST& flat) {
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) return false;
+
+    std::string target = path(source);
+    std::string temporary = target + "." + std::to_string(std::random_device{}()) + ".tmp";
+    std::string bytes = encode(flat, source);
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        if (!out) {
+            out.close();
+            std::filesystem::remove(temporary, error);
+            return false;
+        }
+    }
+    std::filesystem::rename(temporary, target, error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,101 @@
+#include "binder.hpp"
+#include <algorithm>
+
+namespace {
+
+const char* kind_name(BindingKind kind) {
+    switch (kind) {
+        case BindingKind::Global: return "global";
+        case BindingKind::Param: return "parameter";
+        case BindingKind::Local: return "local";
+        case BindingKind::Function: return "function";
+        case BindingKind::Unresolved: break;
+    }
+    return "unresolved";
+}
+
+} // namespace
+
+std::string Shadowing::message() const {
+    std::string text = std::string(kind_name(inner)) + " '" + name.str() + "'";
+    if (function.valid()) text += " in function '" + function.str() + "'";
+    return text + " shadows " + kind_name(outer) + " '" + name.str() + "'";
+}
+
+void Binder::exit() {
+    vars.unwind(marks.back().vars);
+    next_slot = marks.back().next_slot;
+    marks.pop_back();
+}
+
+Binding Binder::declare(Symbol name, BindingKind kind) {
+    if (auto same = vars.find_local(name, depth())) return *same;     // повторное объявление - та же ячейка
+    if (auto outer = vars.find(name)) {
+        shadowed.push_back({name, function ? function->name : Symbol(), kind, outer->kind});
+    }
+    Binding binding{kind, kind == BindingKind::Global ? global_count++ : next_slot++};
+    if (function) function->frame_size = std::max(function->frame_size, next_slot);
+    vars.declare(name, binding, depth());
+    return binding;
+}
+
+void Binder::visit(IdExpr& expr) {
+    if (auto binding = vars.find(expr.name)) {
+        expr.binding = *binding;
+        ++resolved_count;
+    } else {
+        ++unresolved_count;
+    }
+}
+
+void Binder::visit(CallExpr& expr) {
+    auto callee = node_cast<IdExpr>(expr.callee);
+    if (!callee) {
+        walk(expr.callee);
+    } else if (auto binding = funcs.find(callee->name)) {
+        callee->binding = *binding;
+        ++resolved_count;
+    } else {
+        ++unresolved_count;
+    }
+    for (auto arg : expr.args) walk(arg);
+}
+
+void Binder::visit(MemberAccessExpr& expr) {
+    walk(expr.object);      // member - имя поля, не переменная
+}
+
+void Binder::visit(BlockStmt& stmt) {
+    enter();
+    walk_children(stmt);
+    exit();
+}
+
+void Binder::visit(ForStmt& stmt) {
+    enter();
+    walk_children(stmt);
+    exit();
+}
+
+void Binder::visit(VarDecl& decl) {
+    for (auto& variable : decl.variables) {
+        walk(variable.size);
+        walk(variable.init);
+        variable.binding = declare(variable.name, function ? BindingKind::Local : BindingKind::Global);
+    }
+}
+
+void Binder::visit(FunctionDecl& decl) {
+    if (!funcs.find(decl.name)) funcs.declare(decl.name, {BindingKind::Function, function_count++}, 0);
+    BlockStmt* body = decl.get_body();
+    if (!body) return;
+
+    function = &decl;
+    next_slot = 0;
+    decl.frame_size = 0;
+    enter();
+    for (const auto& param : decl.params) declare(param.second, BindingKind::Param);
+    walk(body);
+    exit();
+    function = nullptr;
+}
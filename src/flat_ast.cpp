@@ -0,0 +1,349 @@
+#include "flat_ast.hpp"
+#include "visitor.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+// Запись дерева указателей в плоскую форму: каждый узел открывается, за ним пишутся
+// поддеревья детей, после чего узел закрывается (запоминается конец поддерева).
+// Класс узла выбирается по его виду (dispatch), visit вызываются без виртуальной диспетчеризации
+class FlatWriter {
+public:
+    explicit FlatWriter(FlatAST& flat) : flat(flat) {}
+
+    void write(ASTNode* node) {
+        if (!node) return leaf(NodeKind::None);
+        auto at = static_cast<std::uint32_t>(flat.size());
+        dispatch(*node, [this](auto& n) { visit(n); });
+        if (auto expr = node_cast<Expr>(node); expr && expr->type_id) annotate(at, expr->type_id);
+    }
+
+    void visit(LiteralExpr& expr) {
+        leaf(NodeKind::Literal, ConstantPool::pack(flat.literals.add(expr.value())));
+    }
+    void visit(IdExpr& expr) { leaf(NodeKind::Id, expr.name.id); }
+    void visit(BinaryExpr& expr) { binary(NodeKind::Binary, expr); }
+    void visit(LogicalExpr& expr) { binary(NodeKind::Logical, expr); }
+    void visit(AssignExpr& expr) { binary(NodeKind::Assign, expr); }
+    void visit(UnaryExpr& expr) { node(NodeKind::Unary, flat.intern_operator(expr.op), expr.operand); }
+    void visit(PostfixExpr& expr) { node(NodeKind::Postfix, flat.intern_operator(expr.op), expr.operand); }
+    void visit(SizeofExpr& expr) {
+        std::uint32_t data = FlatAST::no_data;
+        ExprPtr type_expr = nullptr;
+        if (auto type = std::get_if<TypePtr>(&expr.type)) {
+            flat.types.push_back(*type);
+            data = index(flat.types);
+        } else {
+            type_expr = std::get<ExprPtr>(expr.type);
+        }
+        node(NodeKind::Sizeof, data, expr.operand, type_expr);
+    }
+    void visit(TernaryExpr& expr) {
+        node(NodeKind::Ternary, FlatAST::no_data, expr.cond, expr.true_expr, expr.false_expr);
+    }
+    void visit(CallExpr& expr) {
+        std::uint32_t call = flat.open(NodeKind::Call);
+        write(expr.callee);
+        for (auto arg : expr.args) write(arg);
+        flat.close(call);
+    }
+    void visit(MemberAccessExpr& expr) {
+        node(NodeKind::MemberAccess, FlatAST::no_data, expr.object, expr.member);
+    }
+    void visit(ArrayAccessExpr& expr) {
+        node(NodeKind::ArrayAccess, FlatAST::no_data, expr.array, expr.index);
+    }
+    void visit(ArrayInitExpr& expr) { list(NodeKind::ArrayInit, expr.elements); }
+    void visit(CastExpr& expr) {
+        flat.types.push_back(expr.type);
+        node(NodeKind::Cast, index(flat.types), expr.operand);
+    }
+
+    void visit(ExprStmt& stmt) { node(NodeKind::ExprStmt, FlatAST::no_data, stmt.expr); }
+    void visit(BlockStmt& stmt) { list(NodeKind::Block, stmt.statements); }
+    void visit(IfStmt& stmt) {
+        node(NodeKind::If, FlatAST::no_data, stmt.condition, stmt.then_branch, stmt.else_branch);
+    }
+    void visit(WhileStmt& stmt) { node(NodeKind::While, FlatAST::no_data, stmt.condition, stmt.body); }
+    void visit(ForStmt& stmt) {
+        node(NodeKind::For, FlatAST::no_data, stmt.init, stmt.condition, stmt.increment, stmt.body);
+    }
+    void visit(ReturnStmt& stmt) { node(NodeKind::Return, FlatAST::no_data, stmt.expr); }
+    void visit(BreakStmt&) { leaf(NodeKind::Break); }
+    void visit(ContinueStmt&) { leaf(NodeKind::Continue); }
+    void visit(PrintStmt& stmt) { list(NodeKind::Print, stmt.expr); }
+    void visit(ReadStmt& stmt) { node(NodeKind::Read, FlatAST::no_data, stmt.expr); }
+    void visit(ExitStmt& stmt) { node(NodeKind::Exit, FlatAST::no_data, stmt.expr); }
+
+    void visit(VarDecl& decl) {
+        flat.var_types.push_back({decl.type, decl.modifiers});
+        std::uint32_t var_decl = flat.open(NodeKind::VarDecl, index(flat.var_types));
+        for (auto& variable : decl.variables) {
+            node(variable.is_array ? NodeKind::ArrayVariable : NodeKind::Variable, variable.name.id, variable.init,
+                 variable.size);
+        }
+        flat.close(var_decl);
+    }
+    void visit(StructDecl& decl) {
+        std::uint32_t struct_decl = flat.open(NodeKind::StructDecl, decl.name.id);
+        for (auto& field : decl.fields) visit(field);
+        flat.close(struct_decl);
+    }
+    void visit(FunctionDecl& decl) {
+        flat.functions.push_back({decl.return_mods, decl.return_type, decl.name, decl.params});
+        node(NodeKind::FunctionDecl, index(flat.functions), decl.get_body());
+    }
+    void visit(AssertDecl& decl) {
+        flat.messages.push_back(decl.message);
+        node(NodeKind::AssertDecl, index(flat.messages), decl.expr);
+    }
+    void visit(TypedefDecl& decl) {
+        flat.typedefs.push_back({decl.original_modifiers, decl.original_type, decl.alias_name});
+        leaf(NodeKind::TypedefDecl, index(flat.typedefs));
+    }
+
+    void visit(TranslationUnitNode& node) {
+        for (auto decl : node.decls) write(decl);
+    }
+
+private:
+    FlatAST& flat;
+    std::unordered_map<TypeId, std::uint32_t> type_index;   // тип выражения -> индекс в types
+
+    // Массив типов появляется с первым проверенным выражением, хвост добивается в append
+    void annotate(std::uint32_t node, TypeId id) {
+        auto [it, added] = type_index.try_emplace(id, static_cast<std::uint32_t>(flat.types.size()));
+        if (added) flat.types.push_back(type_context().type(id));
+        if (flat.expr_types.size() < flat.size()) flat.expr_types.resize(flat.size(), FlatAST::no_data);
+        flat.expr_types[node] = it->second;
+    }
+
+    template <typename Table>
+    static std::uint32_t index(const Table& table) { return static_cast<std::uint32_t>(table.size() - 1); }
+
+    void leaf(NodeKind kind, std::uint32_t data = FlatAST::no_data) { flat.close(flat.open(kind, data)); }
+
+    template <typename... Children>
+    void node(NodeKind kind, std::uint32_t data, Children... children) {
+        std::uint32_t node = flat.open(kind, data);
+        (write(children), ...);
+        flat.close(node);
+    }
+
+    template <typename List>
+    void list(NodeKind kind, const List& children) {
+        std::uint32_t node = flat.open(kind);
+        for (auto child : children) write(child);
+        flat.close(node);
+    }
+
+    void binary(NodeKind kind, BinaryExpr& expr) { node(kind, flat.intern_operator(expr.op), expr.left, expr.right); }
+};
+
+namespace {
+
+// Обратное преобразование: узлы дерева указателей создаются в арене корня
+class Expander {
+public:
+    Expander(const FlatAST& flat, TranslationUnitNode& root) : flat(flat), arena(root.arena), constants(*root.constants) {}
+
+    ASTNode* build(std::uint32_t i) {
+        ASTNode* node = make(i);
+        if (TypePtr type = flat.expr_type(i)) static_cast<Expr*>(node)->type_id = type->id();
+        return node;
+    }
+
+private:
+    const FlatAST& flat;
+    Arena& arena;
+    ConstantPool& constants;
+
+    ASTNode* make(std::uint32_t i) {
+        std::uint32_t c = flat.first_child(i);
+        switch (flat.kind(i)) {
+            case NodeKind::None: return nullptr;
+            case NodeKind::Literal: return arena.make<LiteralExpr>(constants, constants.add(flat.literal(i)));
+            case NodeKind::Id: return arena.make<IdExpr>(flat.symbol(i));
+            case NodeKind::Binary: return arena.make<BinaryExpr>(flat.op(i), expr(c), expr(flat.end(c)));
+            case NodeKind::Logical: return arena.make<LogicalExpr>(flat.op(i), expr(c), expr(flat.end(c)));
+            case NodeKind::Assign: return arena.make<AssignExpr>(flat.op(i), expr(c), expr(flat.end(c)));
+            case NodeKind::Unary: return arena.make<UnaryExpr>(flat.op(i), expr(c));
+            case NodeKind::Postfix: return arena.make<PostfixExpr>(expr(c), flat.op(i));
+            case NodeKind::Sizeof: {
+                std::variant<TypePtr, ExprPtr> type;
+                if (flat.data(i) != FlatAST::no_data) type = flat.type(i);
+                else type = expr(flat.end(c));
+                return arena.make<SizeofExpr>(expr(c), type);
+            }
+            case NodeKind::Ternary: {
+                std::uint32_t t = flat.end(c);
+                return arena.make<TernaryExpr>(expr(c), expr(t), expr(flat.end(t)));
+            }
+            case NodeKind::Call: return arena.make<CallExpr>(expr(c), list<ExprPtr>(flat.end(c), flat.end(i)));
+            case NodeKind::MemberAccess: return arena.make<MemberAccessExpr>(expr(c), expr(flat.end(c)));
+            case NodeKind::ArrayAccess: return arena.make<ArrayAccessExpr>(expr(c), expr(flat.end(c)));
+            case NodeKind::ArrayInit: return arena.make<ArrayInitExpr>(list<ExprPtr>(c, flat.end(i)));
+            case NodeKind::Cast: {
+                auto cast = arena.make<CastExpr>(flat.type(i), expr(c));
+                cast->type_id = flat.type(i)->id();
+                return cast;
+            }
+
+            case NodeKind::ExprStmt: return arena.make<ExprStmt>(build(c));
+            case NodeKind::Block: {
+                auto block = arena.make<BlockStmt>();
+                block->statements = list<StmtPtr>(c, flat.end(i));
+                return block;
+            }
+            case NodeKind::If: {
+                std::uint32_t t = flat.end(c);
+                return arena.make<IfStmt>(expr(c), as<Stmt>(t), as<Stmt>(flat.end(t)));
+            }
+            case NodeKind::While: return arena.make<WhileStmt>(expr(c), as<Stmt>(flat.end(c)));
+            case NodeKind::For: {
+                std::uint32_t cond = flat.end(c);
+                std::uint32_t inc = flat.end(cond);
+                return arena.make<ForStmt>(as<Decl>(c), expr(cond), expr(inc), as<Stmt>(flat.end(inc)));
+            }
+            case NodeKind::Return: return arena.make<ReturnStmt>(expr(c));
+            case NodeKind::Break: return arena.make<BreakStmt>();
+            case NodeKind::Continue: return arena.make<ContinueStmt>();
+            case NodeKind::Print: return arena.make<PrintStmt>(list<ExprPtr>(c, flat.end(i)));
+            case NodeKind::Read: return arena.make<ReadStmt>(expr(c));
+            case NodeKind::Exit: return arena.make<ExitStmt>(expr(c));
+
+            case NodeKind::VarDecl: {
+                std::vector<Variable> variables;
+                for (; c < flat.end(i); c = flat.next_sibling(c)) {
+                    std::uint32_t init = flat.first_child(c);
+                    variables.emplace_back(flat.symbol(c), expr(init), expr(flat.end(init)),
+                                           flat.kind(c) == NodeKind::ArrayVariable);
+                }
+                const auto& info = flat.var_type(i);
+                return arena.make<VarDecl>(info.type, std::move(variables), info.modifiers);
+            }
+            case NodeKind::StructDecl: {
+                std::vector<VarDecl> fields;
+                for (; c < flat.end(i); c = flat.next_sibling(c)) fields.push_back(*as<VarDecl>(c));
+                return arena.make<StructDecl>(flat.symbol(i), fields);
+            }
+            case NodeKind::FunctionDecl: {
+                const auto& info = flat.function(i);
+                return arena.make<FunctionDecl>(info.return_mods, info.return_type, info.name, info.params, as<BlockStmt>(c));
+            }
+            case NodeKind::AssertDecl: return arena.make<AssertDecl>(expr(c), flat.message(i));
+            case NodeKind::TypedefDecl: {
+                const auto& info = flat.typedef_info(i);
+                return arena.make<TypedefDecl>(info.modifiers, info.type, info.alias);
+            }
+            default: break;
+        }
+        throw std::runtime_error("Unexpected node kind in flat AST");
+    }
+
+    // Вид узла определяет его класс, поэтому приведение вниз без проверки
+    template <typename T>
+    T* as(std::uint32_t i) { return static_cast<T*>(build(i)); }
+    ExprPtr expr(std::uint32_t i) { return as<Expr>(i); }
+
+    template <typename Ptr>
+    std::vector<Ptr> list(std::uint32_t from, std::uint32_t to) {
+        std::vector<Ptr> nodes;
+        for (std::uint32_t c = from; c < to; c = flat.next_sibling(c)) {
+            nodes.push_back(static_cast<Ptr>(build(c)));
+        }
+        return nodes;
+    }
+};
+
+} // namespace
+
+FlatAST::FlatAST() {
+    open(NodeKind::TranslationUnit);
+    close(0);
+}
+
+FlatAST::FlatAST(const TranslationUnitNode& root) : FlatAST() {
+    for (auto decl : root.decls) append(decl);
+}
+
+void FlatAST::append(Decl* decl) {
+    FlatWriter(*this).write(decl);
+    if (analyzed()) expr_types.resize(size(), no_data);
+    close(0);
+}
+
+TypePtr FlatAST::expr_type(std::uint32_t i) const {
+    if (i >= expr_types.size() || expr_types[i] == no_data) return nullptr;
+    return types[expr_types[i]];
+}
+
+std::uint32_t FlatAST::child(std::uint32_t i, std::uint32_t n) const {
+    std::uint32_t c = first_child(i);
+    while (n--) c = next_sibling(c);
+    return c;
+}
+
+std::uint32_t FlatAST::open(NodeKind kind, std::uint32_t data) {
+    kinds.push_back(kind);
+    ends.push_back(0);
+    datas.push_back(data);
+    return static_cast<std::uint32_t>(kinds.size() - 1);
+}
+
+void FlatAST::wrap(std::uint32_t first, NodeKind kind, std::uint32_t data) {
+    kinds.insert(kinds.begin() + first, kind);
+    datas.insert(datas.begin() + first, data);
+    ends.insert(ends.begin() + first, 0);
+    for (std::uint32_t j = first + 1; j < ends.size(); ++j) ++ends[j];
+    close(first);
+}
+
+void FlatAST::rotate(std::uint32_t first, std::uint32_t middle) {
+    auto size = static_cast<std::uint32_t>(kinds.size());
+    for (std::uint32_t j = first; j < middle; ++j) ends[j] += size - middle;
+    for (std::uint32_t j = middle; j < size; ++j) ends[j] -= middle - first;
+    std::rotate(kinds.begin() + first, kinds.begin() + middle, kinds.end());
+    std::rotate(datas.begin() + first, datas.begin() + middle, datas.end());
+    std::rotate(ends.begin() + first, ends.begin() + middle, ends.end());
+}
+
+void FlatAST::truncate(std::uint32_t size) {
+    kinds.resize(size);
+    datas.resize(size);
+    ends.resize(size);
+}
+
+std::uint32_t FlatAST::intern_operator(const std::string& op) {
+    for (std::size_t i = 0; i < operators.size(); ++i) {
+        if (operators[i] == op) return static_cast<std::uint32_t>(i);
+    }
+    operators.push_back(op);
+    return static_cast<std::uint32_t>(operators.size() - 1);
+}
+
+std::size_t FlatAST::bytes() const {
+    return kinds.capacity() * sizeof(NodeKind) + ends.capacity() * sizeof(std::uint32_t) +
+           datas.capacity() * sizeof(std::uint32_t) + literals.bytes() +
+           types.capacity() * sizeof(TypePtr) + var_types.capacity() * sizeof(VarType) +
+           functions.capacity() * sizeof(Function) + typedefs.capacity() * sizeof(Typedef) +
+           operators.capacity() * sizeof(std::string) + messages.capacity() * sizeof(std::string) +
+           expr_types.capacity() * sizeof(std::uint32_t);
+}
+
+std::shared_ptr<TranslationUnitNode> FlatAST::expand() const {
+    auto root = std::make_shared<TranslationUnitNode>();
+    Expander expander(*this, *root);
+    for (std::uint32_t c = first_child(0); c < end(0); c = next_sibling(c)) {
+        root->decls.push_back(static_cast<Decl*>(expander.build(c)));
+    }
+    return root;
+}
+
+void FlatAST::accept(FlatVisitor& visitor) const { visitor.visit(FlatNode(*this, 0)); }
+
+std::uint32_t FlatNode::child_count() const {
+    std::uint32_t count = 0;
+    for (std::uint32_t c = flat->first_child(i); c < flat->end(i); c = flat->next_sibling(c)) ++count;
+    return count;
+}
@@ -0,0 +1,114 @@
+#include "incremental_lexer.hpp"
+#include "lexer.hpp"
+#include <stdexcept>
+
+namespace {
+
+void check_edits(const std::vector<TextEdit>& edits, std::size_t size) {
+    std::size_t covered = 0;
+    for (const auto& edit : edits) {
+        if (edit.offset < covered || edit.offset > size || edit.length > size - edit.offset) {
+            throw std::runtime_error("Edits must be sorted, disjoint and lie inside the text");
+        }
+        covered = edit.offset + edit.length;
+    }
+}
+
+// Первый токен из [from, tokens.size()), начинающийся не раньше position
+std::size_t lower_bound_start(const TokenBuffer& tokens, std::size_t from, std::size_t to, std::size_t position) {
+    while (from < to) {
+        std::size_t mid = from + (to - from) / 2;
+        if (tokens.start(mid) < position) from = mid + 1;
+        else to = mid;
+    }
+    return from;
+}
+
+} // namespace
+
+std::string apply_edits(std::string_view source, const std::vector<TextEdit>& edits) {
+    check_edits(edits, source.size());
+    std::string result;
+    result.reserve(source.size());
+    std::size_t copied = 0;
+    for (const auto& edit : edits) {
+        result.append(source.substr(copied, edit.offset - copied));
+        result += edit.text;
+        copied = edit.offset + edit.length;
+    }
+    result.append(source.substr(copied));
+    return result;
+}
+
+IncrementalLexer::IncrementalLexer(const TokenBuffer& previous, std::string_view source, const std::vector<TextEdit>& edits)
+    : previous(previous), source(source), edits(edits) {}
+
+TokenBuffer IncrementalLexer::tokenize() {
+    reused_count = 0;
+    relexed_count = 0;
+
+    std::size_t old_size = previous.source().size();
+    check_edits(edits, old_size);
+    std::size_t new_size = old_size;
+    for (const auto& edit : edits) new_size = new_size - edit.length + edit.text.size();
+    if (previous.empty() || new_size != source.size()) {
+        throw std::runtime_error("Edits do not match the previous token stream");
+    }
+
+    const std::size_t count = previous.size() - 1;   // без END
+    TokenBuffer tokens(source);
+    tokens.reserve(previous.size());
+
+    std::size_t next = 0;           // первый прежний токен, ещё не перенесённый и не отброшенный
+    std::size_t edit = 0;           // первая правка, которую разбор ещё не прошёл
+    std::ptrdiff_t shift = 0;       // сдвиг прежних координат в новые до правки edit
+    std::size_t resume = 0;         // позиция в новом тексте за последним выданным токеном
+
+    // Токен цел, если и он, и символ за ним (предпросмотр лексера) лежат до следующей правки
+    auto intact = [&](std::size_t i) { return edit == edits.size() || previous.end(i) < edits[edit].offset; };
+
+    while (true) {
+        // Перенос целых токенов: концы токенов возрастают, граница ищется делением пополам
+        std::size_t lo = next;
+        std::size_t hi = count;
+        while (lo < hi) {
+            std::size_t mid = lo + (hi - lo) / 2;
+            if (intact(mid)) lo = mid + 1;
+            else hi = mid;
+        }
+        if (lo > next) {
+            tokens.append(previous, next, lo, shift);
+            reused_count += lo - next;
+            resume = previous.end(lo - 1) + shift;
+            next = lo;
+        }
+        if (next == count && edit == edits.size()) break;
+
+        // Разбор повреждённого участка до синхронизации с прежним потоком
+        Lexer lexer(source, resume);
+        bool synced = false;
+        while (lexer.skip_trivia()) {
+            std::size_t position = lexer.position();
+            while (edit < edits.size() && position >= edits[edit].offset + shift + edits[edit].text.size()) {
+                shift += static_cast<std::ptrdiff_t>(edits[edit].text.size()) - static_cast<std::ptrdiff_t>(edits[edit].length);
+                ++edit;
+            }
+            if (edit == edits.size() || position < edits[edit].offset + shift) {
+                // позиция вне вставленного текста: ищем прежний токен, начинавшийся там же
+                std::size_t old_position = position - shift;
+                std::size_t k = lower_bound_start(previous, next, count, old_position);
+                if (k < count && previous.start(k) == old_position && intact(k)) {
+                    next = k;
+                    synced = true;
+                    break;
+                }
+                next = k;
+            }
+            lexer.next(tokens);
+            ++relexed_count;
+        }
+        if (!synced) break;     // разбор дошёл до конца текста
+    }
+    tokens.push(TokenType::END, source.size(), 0);
+    return tokens;
+}
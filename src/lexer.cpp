@@ -1,32 +1,80 @@
 #include "lexer.hpp"
-#include <stdexcept>
+#include "scan_kernels.hpp"
+#include "token_tables.hpp"
 #include <cctype>
+#include <stdexcept>
+
+Lexer::Lexer(std::string_view input) : input(input) {}
+
+Lexer::Lexer(std::string_view input, std::size_t start, Interner* local) : input(input), index(start), local(local) {}
 
-Lexer::Lexer(const std::string& input) : input(input) {}
+TokenBuffer Lexer::tokenize() {
+    TokenBuffer tokens(input);
+    out = &tokens;
+    while (skip_trivia()) {
+        extract();
+    }
+    out->push(TokenType::END, input.size(), 0);
+    return tokens;
+}
 
-std::vector<Token> Lexer::tokenize() {
-    std::vector<Token> tokens;
+TokenBuffer Lexer::tokenize_prefix(std::size_t& resume) {
+    TokenBuffer tokens(input);
+    out = &tokens;
     while (index < input.size()) {
-        Token token = extract();
-        tokens.push_back(token);
+        std::size_t start = index;
+        std::size_t count = tokens.size();
+        try {
+            if (skip_trivia()) extract();
+        } catch (const std::runtime_error&) {
+            if (index < input.size()) throw;   // ошибка не связана с концом окна
+            index = input.size();
+        }
+        if (index >= input.size()) {
+            // токен или комментарий упёрся в конец окна - разберём его в следующем окне
+            tokens.truncate(count);
+            index = start;
+            break;
+        }
+    }
+    resume = index;
+    return tokens;
+}
+
+TokenBuffer Lexer::tokenize_range(std::size_t end, std::size_t& resume) {
+    TokenBuffer tokens(input);
+    out = &tokens;
+    while (skip_trivia() && index < end) {
+        extract();
     }
-    tokens.push_back({TokenType::END, ""});
+    resume = index;
     return tokens;
 }
 
-Token Lexer::extract() {
-    while (index < input.size() && std::isspace(input[index])) ++index;
-    if (index >= input.size()) return {TokenType::END, ""};
-    if (input[index] == '/' && (input[index + 1] == '/' || input[index + 1] == '*')){
+bool Lexer::next(TokenBuffer& tokens) {
+    out = &tokens;
+    if (!skip_trivia()) return false;
+    extract();
+    return true;
+}
+
+bool Lexer::skip_trivia() {
+    const char* end = input.data() + input.size();
+    while (index < input.size()) {
+        index = scan::skip_whitespace(input.data() + index, end) - input.data();
+        if (index >= input.size() || input[index] != '/' || (at(index + 1) != '/' && at(index + 1) != '*')) break;
         extract_comment();
-        return extract();
     }
-    if (std::isdigit(input[index])) return extract_number();
-    if (std::isalpha(input[index]) || input[index] == '_') return extract_identifier();
+    return index < input.size();
+}
+
+void Lexer::extract() {
+    if (scan::is_digit(input[index])) return extract_number();
+    if (scan::is_ident_start(input[index])) return extract_identifier();
     if (input[index] == '"') return extract_string();
     if (input[index] == '\'') return extract_char();
     if (input[index] == '.') {
-        if (index + 1 < input.size() && std::isdigit(input[index + 1])) {      
+        if (scan::is_digit(at(index + 1))) {      
             return extract_number();
         }
         return extract_operator();
@@ -34,53 +82,85 @@ Token Lexer::extract() {
     return extract_operator();
 }
 
-Token Lexer::extract_number() {
+std::size_t Lexer::skip_digits(std::size_t i) const {
+    if (i >= input.size()) return i;
+    return scan::skip_digits(input.data() + i, input.data() + input.size()) - input.data();
+}
+
+void Lexer::extract_number() {
     std::size_t start = index;
-    std::string value;
-
-    if (input[index] == '.') {  
-        // Число начинается с точки
-        value = "0";    // .1  ->  0.1 
-        value += input[index++];
-        while (std::isdigit(input[index])) value += input[index++];
-        return {TokenType::NUM_DOUBLE , value};
+    std::size_t digits = index;     // цифры без префикса основания
+    int base = 10;
+    bool is_floating = false;
+
+    char prefix = static_cast<char>(at(index + 1) | 0x20);
+    if (input[index] == '0' && prefix == 'x') {
+        digits = index += 2;
+        while (std::isxdigit(static_cast<unsigned char>(at(index)))) ++index;
+        base = 16;
+    } else if (input[index] == '0' && prefix == 'b') {
+        digits = index += 2;
+        while (at(index) == '0' || at(index) == '1') ++index;
+        base = 2;
     } else {
-        // Число начинается с цифры 
-        while (std::isdigit(input[index])) value += input[index++];
-        if (input[index] == '.') {
-            value += input[index++];
-            while (std::isdigit(input[index])) value += input[index++];
-            return {TokenType::NUM_DOUBLE , value};
+        // Целая часть, дробная часть (число может начинаться или заканчиваться точкой: .1, 1.) и экспонента
+        index = skip_digits(index);
+        if (at(index) == '.') {
+            index = skip_digits(index + 1);
+            is_floating = true;
         }
-    }
-    // Если число заканчивается на .
-    if (value.back() == '.') {
-        value += "0";  // 1. ->  1.0
-        return {TokenType::NUM_DOUBLE , value};
+        char e = at(index);
+        char sign = at(index + 1);
+        if ((e == 'e' || e == 'E') &&
+            (scan::is_digit(sign) || ((sign == '+' || sign == '-') && scan::is_digit(at(index + 2))))) {
+            index = skip_digits(index + 2);
+            is_floating = true;
+        }
+        if (!is_floating && input[start] == '0' && index - start > 1) base = 8;
     }
 
-    return {TokenType::NUM_INT, value};
+    // Суффикс - все идущие следом символы идентификатора, как pp-number в C: 10ul, 1.5f, 12abc (ошибка)
+    std::size_t digits_end = index;
+    index = scan::skip_identifier(input.data() + index, input.data() + input.size()) - input.data();
+    std::string_view suffix = input.substr(digits_end, index - digits_end);
+
+    if (is_floating) {
+        out->push_number(TokenType::NUM_DOUBLE, start, index - start,
+                         decode_floating(input.substr(start, digits_end - start), suffix));
+    } else {
+        out->push_number(TokenType::NUM_INT, start, index - start,
+                         decode_integer(input.substr(digits, digits_end - digits), base, suffix));
+    }
 }
 
 
-Token Lexer::extract_identifier() {
+void Lexer::extract_identifier() {
     std::size_t start = index;
-    while (std::isalnum(input[index]) || input[index] == '_') ++index;
-    std::string name = input.substr(start, index - start);
-    if (auto it = keywords.find(name); it != keywords.end()) {
-        return {it->second, name};
-    }
-    if(name == "true") return {TokenType::BOOL, name};
-    if(name == "false") return {TokenType::BOOL, name};
-    return {TokenType::ID, name};
+    index = scan::skip_identifier(input.data() + index, input.data() + input.size()) - input.data();
+    std::string_view name = input.substr(start, index - start);
+    TokenType type = keyword_type(name);
+    if (type == TokenType::ID) out->push_symbol(start, name.size(), symbol_for(name));
+    else out->push(type, start, name.size());
+}
+
+Symbol Lexer::symbol_for(std::string_view name) {
+    if (local) return local->intern(name);
+    auto [it, inserted] = symbols.try_emplace(name);
+    if (inserted) it->second = intern(name);
+    return it->second;
 }
 
-Token Lexer::extract_string() {
+void Lexer::extract_string() {
     std::size_t start = ++index;
-    std::string value;
+    std::string value;      // заполняется только если встретилась escape-последовательность
+    bool escaped = false;
     
     while (index < input.size() && input[index] != '"') {
         if (input[index] == '\\') {
+            if (!escaped) {
+                value.assign(input.substr(start, index - start));
+                escaped = true;
+            }
             ++index;
             if (index >= input.size()) break;
             switch (input[index]) {
@@ -93,24 +173,27 @@ Token Lexer::extract_string() {
                 case '0': value += '\0'; break;
                 default: value += input[index]; break;
             }
-        } else {
+        } else if (escaped) {
             value += input[index];
         }
         ++index;
     }
+    std::size_t length = index - start;
     if (index < input.size() && input[index] == '"') ++index; // пропускаем закрывающую кавычку
     else throw std::runtime_error("Unterminated string literal");
 
-    return {TokenType::STRING, value};
+    if (escaped) out->push_decoded(TokenType::STRING, start, length, std::move(value));
+    else out->push(TokenType::STRING, start, length);
 }
 
 
-Token Lexer::extract_char() {
-    ++index; // пропускаем открывающую '
+void Lexer::extract_char() {
+    std::size_t start = ++index; // пропускаем открывающую '
     if (index >= input.size()) throw std::runtime_error("Unterminated char literal");
 
+    bool escaped = input[index] == '\\';
     char ch;
-    if (input[index] == '\\') {
+    if (escaped) {
         ++index;
         if (index >= input.size()) throw std::runtime_error("Unterminated escape sequence in char literal");
         switch (input[index]) {
@@ -128,71 +211,32 @@ Token Lexer::extract_char() {
     ++index;
 
     if (index >= input.size() || input[index] != '\'') throw std::runtime_error("Unterminated char literal");
+    std::size_t length = index - start;
     ++index; // пропускаем закрывающую '
 
-    return {TokenType::CHAR, std::string(1, ch)};
+    if (escaped) out->push_decoded(TokenType::CHAR, start, length, std::string(1, ch));
+    else out->push(TokenType::CHAR, start, length);
 }
 
 
-Token Lexer::extract_operator() {
-    std::string op;
-    // Собираем длинный оператор
-    while (operators.find(op + input[index]) != operators.end()) {
-        op += input[index++];
-    }
-    // Если нашли оператор в таблице
-    if (!op.empty() && operators.find(op) != operators.end()) {
-        return {operators.at(op), op};
+void Lexer::extract_operator() {
+    TokenType type;
+    // Самый длинный оператор из таблицы
+    std::size_t length = match_operator(input.data() + index, input.data() + input.size(), type);
+    if (length == 0) {
+        throw std::runtime_error("Unknown operator: " + std::string(1, input[index]));
     }
-    throw std::runtime_error("Unknown operator: " + std::string(1, input[index]));
+    out->push(type, index, length);
+    index += length;
 }
 
 void Lexer::extract_comment() {
-    if (input[index + 1] == '/') {  
-        while (index < input.size() && input[index] != '\n') ++index;
+    const char* end = input.data() + input.size();
+    if (at(index + 1) == '/') {  
+        index = scan::find_newline(input.data() + index, end) - input.data();
     } else {  
         index += 2;  
-        while (index + 1 < input.size() && !(input[index] == '*' && input[index + 1] == '/')) ++index;
+        index = scan::find_comment_end(input.data() + index, end) - input.data();
         index += 2;  
     }
 }
-
-const std::unordered_map<std::string, TokenType> Lexer::keywords = {
-    {"short", TokenType::TYPE_SHORT}, {"int", TokenType::TYPE_INT}, {"long", TokenType::TYPE_LONG},
-    {"char", TokenType::TYPE_CHAR}, {"bool", TokenType::TYPE_BOOL}, {"void", TokenType::TYPE_VOID},
-    {"ldouble", TokenType::TYPE_LONG_DOUBLE}, {"double", TokenType::TYPE_DOUBLE}, {"float", TokenType::TYPE_FLOAT},
-
-    {"const", TokenType::KW_CONST}, {"static", TokenType::KW_STATIC}, 
-    {"unsigned", TokenType::KW_UNSIGNED},
-
-    {"True", TokenType::BOOL}, {"False", TokenType::BOOL},
-
-    {"struct", TokenType::KW_STRUCT},
-    {"typedef", TokenType::KW_TYPEDEF}, // Добавлено ключевое слово typedef
-    {"if", TokenType::KW_IF}, {"else", TokenType::KW_ELSE}, {"while", TokenType::KW_WHILE}, 
-    {"for", TokenType::KW_FOR}, {"return", TokenType::KW_RETURN}, {"break", TokenType::KW_BREAK}, 
-    {"continue", TokenType::KW_CONTINUE},
-
-    {"sizeof", TokenType::KW_SIZEOF}, 
-    {"read", TokenType::KW_READ}, {"print", TokenType::KW_PRINT},
-    {"assert", TokenType::KW_ASSERT}, {"exit", TokenType::KW_EXIT},
-
-};
-
-const std::unordered_map<std::string, TokenType> Lexer::operators = {
-    {"+", TokenType::PLUS},   {"-", TokenType::MINUS}, {"*", TokenType::STAR},
-    {"/", TokenType::SLASH},  {"%", TokenType::MOD},   {"=", TokenType::ASSIGN},
-    {"++", TokenType::INC}, {"--", TokenType::DEC},
-    {"+=", TokenType::PLUS_ASSIGN}, {"-=", TokenType::MINUS_ASSIGN},
-    {"*=", TokenType::MULT_ASSIGN}, {"/=", TokenType::DIV_ASSIGN},
-    {"%=", TokenType::MOD_ASSIGN},
-    {"&&", TokenType::AND}, {"||", TokenType::OR}, {"!", TokenType::NOT},
-    {"==", TokenType::EQ}, {"!=", TokenType::NEQ}, {">", TokenType::GT},
-    {"<", TokenType::LT}, {">=", TokenType::GE}, {"<=", TokenType::LE},
-    {"?", TokenType::QUESTION}, {":", TokenType::COLON},
-    {";", TokenType::SEMICOLON}, {",", TokenType::COMMA}, {".", TokenType::DOT},
-    {"(", TokenType::LPAREN}, {")", TokenType::RPAREN},
-    {"{", TokenType::LBRACE},    {"}", TokenType::RBRACE}, 
-    {"[", TokenType::LBRACKET}, {"]", TokenType::RBRACKET},
-};
-
@@ -1,39 +1,329 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
+#include <optional>
+#include <string>
+#include <utility>
 #include "lexer.hpp"
 #include "parser.hpp"
 #include "vis_print.hpp"
+#include "source_buffer.hpp"
+#include "streaming_lexer.hpp"
+#include "perf_stats.hpp"
+#include "scan_kernels.hpp"
+#include "parallel_lexer.hpp"
+#include "token_pipeline.hpp"
+#include "parallel_parser.hpp"
+#include "ast_cache.hpp"
+#include "semantic_analyzer.hpp"
+#include "binder.hpp"
 
-std::string readFile(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file) {
-        throw std::runtime_error("Couldn't open the file: " + filename);
+struct Options {
+    std::string path = "code.txt";
+    bool stream = false;            // лексирование окнами, без разбора
+    std::size_t window_mb = 64;
+    bool stats = false;             // время этапов и пиковая память в stderr
+    bool quiet = false;             // не печатать токены и AST
+    std::string scan_level;         // принудительная реализация ядер лексера: scalar, sse2, avx2
+    bool verify_scan = false;       // сверить поток токенов с эталонным скалярным лексером
+    std::size_t lex_threads = 1;    // потоков лексера; больше 1 - параллельное лексирование кусками
+    bool pipeline = false;          // лексер в отдельном потоке, парсер разбирает токены по мере поступления
+    bool flat = false;              // AST в плоской форме (FlatAST)
+    bool lazy = false;              // тела функций разбираются при первом обращении
+    std::size_t parse_threads = 1;  // потоков парсера; больше 1 - объявления верхнего уровня разбираются параллельно
+    std::size_t max_depth = Parser::default_max_depth;   // предел вложенности при разборе
+    bool hash_cons = false;         // одинаковые выражения без побочных эффектов - общие узлы
+    bool check = false;             // семантические проверки после разбора
+    std::size_t check_threads = 1;  // потоков проверки; больше 1 - тела функций проверяются параллельно
+    bool bind = false;              // привязка имён к ячейкам, предупреждения о затенении
+    std::string cache_dir;          // каталог кэша разобранных программ; пусто - без кэша
+};
+
+Options parseArgs(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--stream") options.stream = true;
+        else if (arg == "--window" && i + 1 < argc) options.window_mb = std::stoul(argv[++i]);
+        else if (arg == "--stats") options.stats = true;
+        else if (arg == "--quiet") options.quiet = true;
+        else if (arg == "--scan" && i + 1 < argc) options.scan_level = argv[++i];
+        else if (arg == "--verify-scan") options.verify_scan = true;
+        else if (arg == "--lex-threads" && i + 1 < argc) options.lex_threads = std::stoul(argv[++i]);
+        else if (arg == "--pipeline") options.pipeline = true;
+        else if (arg == "--flat") options.flat = true;
+        else if (arg == "--lazy") options.lazy = true;
+        else if (arg == "--hash-cons") options.hash_cons = true;
+        else if (arg == "--check") options.check = true;
+        else if (arg == "--check-threads" && i + 1 < argc) options.check_threads = std::stoul(argv[++i]);
+        else if (arg == "--bind") options.bind = true;
+        else if (arg == "--max-depth" && i + 1 < argc) options.max_depth = std::stoul(argv[++i]);
+        else if (arg == "--cache" && i + 1 < argc) options.cache_dir = argv[++i];
+        else if (arg == "--parse-threads" && i + 1 < argc) options.parse_threads = std::stoul(argv[++i]);
+        else if (!arg.empty() && arg[0] == '-' && arg != "-") throw std::runtime_error("Unknown option: " + arg);
+        else options.path = arg;
+    }
+    if (options.check_threads > 1 && !options.check) throw std::runtime_error("--check-threads requires --check");
+    // Плоская форма пишется одним проходом парсера: тела функций в ней разобраны сразу
+    if (options.flat && options.parse_threads > 1) throw std::runtime_error("--flat can't be combined with --parse-threads");
+    if (options.flat && options.lazy) throw std::runtime_error("--flat can't be combined with --lazy");
+    if (options.pipeline) {
+        // конвейер отдаёт токены парсеру пачками и не хранит их: проверять, кэшировать и строить
+        // дерево иначе, чем обычным разбором, он не умеет
+        const std::pair<bool, const char*> unsupported[] = {
+            {options.check, "--check"},
+            {options.bind, "--bind"},
+            {!options.cache_dir.empty(), "--cache"},
+            {options.lazy, "--lazy"},
+            {options.flat, "--flat"},
+            {options.lex_threads > 1, "--lex-threads"},
+            {options.parse_threads > 1, "--parse-threads"},
+            {options.verify_scan, "--verify-scan"},
+        };
+        for (const auto& [set, name] : unsupported) {
+            if (set) throw std::runtime_error(std::string("--pipeline can't be combined with ") + name);
+        }
     }
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
+    return options;
 }
 
-int main() {
-    try{
-        //std::string code = "int main() { int x = 3; bool y = True; // bla bla bla\n if (x >= 15) { print(x); } }";
-        std::string code = readFile("C:\\MGU\\Proga\\GitHub\\interpreter\\code.txt");
-        Lexer lexer(code);
-        std::vector<Token> tokens = lexer.tokenize();
+void printStats(const char* stage, double ms, std::size_t bytes) {
+    double mb = bytes / (1024.0 * 1024.0);
+    std::cerr << stage << ": " << ms << " ms";
+    if (ms > 0 && bytes) std::cerr << " (" << mb / (ms / 1000.0) << " MB/s)";
+    std::cerr << '\n';
+}
 
-        for (const auto& token : tokens) {
-            std::cout << "Token: " << static_cast<int>(token.type) << ", Value: " << token.value << '\n';
+// Статистика hash-consing для подписи этапа разбора; table == nullptr - режим выключен
+std::string sharingStats(const ExprInterner* table) {
+    if (!table) return "";
+    return ", " + std::to_string(table->size()) + " shared expressions, " + std::to_string(table->hits()) + " reused";
+}
+
+void selectScanLevel(const std::string& name) {
+    for (auto level : {scan::Level::Scalar, scan::Level::SSE2, scan::Level::AVX2}) {
+        if (name == scan::level_name(level)) {
+            if (!scan::set_level(level)) throw std::runtime_error("Scan level is not supported by this CPU: " + name);
+            return;
         }
-        std::cout << "------------------------" << std::endl;
+    }
+    throw std::runtime_error("Unknown scan level: " + name);
+}
 
-        Parser parser(tokens);
-        parser.parse();
-        auto ast = parser.getAST();
+// Лексирует исходник скалярными ядрами и сравнивает с уже полученным потоком токенов
+void verifyScan(std::string_view source, const TokenBuffer& tokens) {
+    auto level = scan::active_level();
+    scan::set_level(scan::Level::Scalar);
+    TokenBuffer reference = Lexer(source).tokenize();
+    scan::set_level(level);
+    if (reference != tokens) {
+        throw std::runtime_error(std::string("Token stream of '") + scan::level_name(level) + "' scan differs from scalar");
+    }
+    std::cerr << "scan check: " << scan::level_name(level) << " matches scalar (" << tokens.size() << " tokens)" << std::endl;
+}
 
+int runStreaming(const Options& options) {
+    Stopwatch timer;
+    StreamingLexer lexer(options.path, options.window_mb << 20);
+    lexer.run([&](const TokenBuffer& tokens, std::size_t base) {
+        if (options.quiet) return;
+        for (std::size_t i = 0; i < tokens.size(); ++i) {
+            std::cout << "Token: " << static_cast<int>(tokens.type(i)) << ", Offset: " << base + tokens.offset(i)
+                      << ", Value: " << tokens.text(i) << '\n';
+        }
+    });
+    if (options.stats) {
+        printStats("stream lex", timer.elapsed_ms(), lexer.bytes());
+        std::cerr << "bytes: " << lexer.bytes() << ", tokens: " << lexer.tokens()
+                  << ", windows: " << lexer.windows() << ", max window: " << lexer.max_window() << '\n';
+        std::cerr << "peak RSS: " << peak_rss_bytes() / 1024 << " KB" << std::endl;
+    }
+    return 0;
+}
+
+// Лексирование и разбор одновременно; поток токенов целиком не хранится, поэтому не печатается
+int runPipelined(const Options& options) {
+    Stopwatch timer;
+    SourceBuffer source = SourceBuffer::open(options.path);
+    double load_ms = timer.elapsed_ms();
+
+    timer.reset();
+    TokenPipeline pipeline(source.view());
+    Parser parser(pipeline);
+    parser.set_max_depth(options.max_depth);
+    parser.set_hash_consing(options.hash_cons);
+    parser.parse();
+    auto ast = parser.getAST();
+    double front_ms = timer.elapsed_ms();
+
+    if (!options.quiet) {
         PrintVisitor visitor;
         ast->accept(visitor);
-        
+    }
+
+    if (options.stats) {
+        printStats(source.is_mapped() ? "load (mmap)" : "load (read)", load_ms, source.size());
+        printStats(("lex + parse (pipelined)" + sharingStats(parser.expr_table())).c_str(), front_ms, source.size());
+        std::cerr << "tokens: " << pipeline.tokens() << ", batches: " << pipeline.batches()
+                  << ", parser waits: " << pipeline.waits() << '\n';
+        std::cerr << "peak RSS: " << peak_rss_bytes() / 1024 << " KB" << std::endl;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    try{
+        Options options = parseArgs(argc, argv);
+        if (!options.scan_level.empty()) selectScanLevel(options.scan_level);
+        if (options.stream) return runStreaming(options);
+        if (options.pipeline) return runPipelined(options);
+
+        Stopwatch timer;
+        SourceBuffer source = SourceBuffer::open(options.path);
+        double load_ms = timer.elapsed_ms();
+
+        // Дерево из кэша: лексирование и разбор пропускаются, токены не печатаются. Записанное после
+        // --check дерево уже проверено: анализ пропускается, а печать показывает вставленные Cast
+        std::optional<AstCache> cache;
+        FlatAST cached;
+        bool cache_hit = false;
+        bool analyzed = false;
+        double cache_ms = 0;
+        if (!options.cache_dir.empty()) {
+            timer.reset();
+            cache.emplace(options.cache_dir);
+            cache_hit = cache->load(source.view(), cached);
+            analyzed = cache_hit && cached.analyzed();
+            cache_ms = timer.elapsed_ms();
+        }
+        auto store = [&](const FlatAST& tree) {
+            if (!cache->store(source.view(), tree)) {
+                std::cerr << "Warning: couldn't write AST cache to " << options.cache_dir << std::endl;
+            }
+        };
+
+        TokenBuffer tokens;
+        FlatAST flat;
+        std::shared_ptr<ASTNode> ast;
+        std::string lex_stage = std::string("lex, ") + scan::level_name(scan::active_level());
+        std::string parse_stage = options.lazy ? "parse, lazy bodies" : "parse";
+        double lex_ms = 0;
+        double parse_ms = 0;
+        if (cache_hit) {
+            if (options.flat) flat = std::move(cached);
+            else ast = cached.expand();
+        } else {
+            timer.reset();
+            if (options.lex_threads > 1) {
+                ThreadPool pool(options.lex_threads);
+                ParallelLexer lexer(source.view(), pool);
+                tokens = lexer.tokenize();
+                lex_stage += ", " + std::to_string(pool.size()) + " threads, " + std::to_string(lexer.chunks()) + " chunks, "
+                           + std::to_string(lexer.resynced()) + " resynced";
+            } else {
+                Lexer lexer(source.view());
+                tokens = lexer.tokenize();
+            }
+            lex_ms = timer.elapsed_ms();
+            if (options.verify_scan) verifyScan(source.view(), tokens);
+
+            if (!options.quiet) {
+                for (std::size_t i = 0; i < tokens.size(); ++i) {
+                    std::cout << "Token: " << static_cast<int>(tokens.type(i)) << ", Value: " << tokens.text(i) << '\n';
+                }
+                std::cout << "------------------------" << std::endl;
+            }
+
+            timer.reset();
+            Parser parser(tokens);
+            parser.set_lazy_bodies(options.lazy);
+            parser.set_max_depth(options.max_depth);
+            parser.set_hash_consing(options.hash_cons);
+            if (options.flat) flat = parser.parse_flat();
+            else if (options.parse_threads > 1) {
+                ThreadPool pool(options.parse_threads);
+                ParallelParser parallel(tokens, pool);
+                parallel.set_max_depth(options.max_depth);
+                parallel.set_hash_consing(options.hash_cons);
+                parallel.set_lazy_bodies(options.lazy);
+                ast = parallel.parse();
+                parse_stage += ", " + std::to_string(pool.size()) + " threads, " + std::to_string(parallel.declarations())
+                             + " declarations, " + std::to_string(parallel.groups()) + " groups"
+                             + (parallel.fell_back() ? ", sequential fallback" : "");
+            } else {
+                parser.parse();
+                ast = parser.getAST();
+                parse_stage += sharingStats(parser.expr_table());
+            }
+            parse_ms = timer.elapsed_ms();
+
+            // С --check в кэш пойдёт проверенное дерево, после анализа
+            if (cache && !options.check) {
+                if (options.flat) store(flat);
+                else store(FlatAST(*std::static_pointer_cast<TranslationUnitNode>(ast)));
+            }
+        }
+
+        if (!options.quiet) {
+            PrintVisitor visitor;
+            if (options.flat) flat.accept(visitor);
+            else ast->accept(visitor);
+        }
+
+        std::shared_ptr<TranslationUnitNode> root;
+        if (options.bind || options.check) {
+            root = options.flat ? flat.expand() : std::static_pointer_cast<TranslationUnitNode>(ast);
+        }
+
+        double bind_ms = 0;
+        Binder binder;
+        if (options.bind) {
+            timer.reset();
+            binder.bind(*root);
+            bind_ms = timer.elapsed_ms();
+            if (!options.quiet) {
+                for (const auto& shadowing : binder.shadowings()) std::cerr << "Warning: " << shadowing.message() << '\n';
+            }
+        }
+
+        double check_ms = 0;
+        std::string check_stage = "semantic check";
+        if (options.check && analyzed) {
+            check_stage += ", from AST cache";
+        } else if (options.check) {
+            timer.reset();
+            if (options.check_threads > 1) {
+                ThreadPool pool(options.check_threads);
+                SemanticAnalyzer analyzer;
+                analyzer.analyze(root, pool);
+                check_stage += ", " + std::to_string(pool.size()) + " threads, " + std::to_string(analyzer.functions())
+                             + " function bodies, " + std::to_string(analyzer.steals()) + " steals";
+            } else {
+                SemanticAnalyzer().analyze(root);
+            }
+            check_ms = timer.elapsed_ms();
+            if (cache) store(FlatAST(*root));
+        }
+
+        if (options.stats) {
+            printStats(source.is_mapped() ? "load (mmap)" : "load (read)", load_ms, source.size());
+            if (cache) {
+                printStats(cache_hit ? "AST cache load" : "AST cache miss", cache_ms, 0);
+                if (!cache_hit) std::cerr << "cache: " << cache->miss_reason() << '\n';
+            }
+            if (!cache_hit) {
+                printStats(lex_stage.c_str(), lex_ms, source.size());
+                printStats(parse_stage.c_str(), parse_ms, 0);
+                std::cerr << "tokens: " << tokens.size() << '\n';
+            }
+            if (options.bind) {
+                printStats("binding", bind_ms, 0);
+                std::cerr << "bindings: " << binder.resolved() << " resolved, " << binder.unresolved() << " unresolved, "
+                          << binder.globals() << " globals, " << binder.functions() << " functions, "
+                          << binder.shadowings().size() << " shadowed\n";
+            }
+            if (options.check) printStats(check_stage.c_str(), check_ms, 0);
+            if (options.flat) std::cerr << "flat AST: " << flat.size() << " nodes, " << flat.bytes() << " bytes\n";
+            std::cerr << "peak RSS: " << peak_rss_bytes() / 1024 << " KB" << std::endl;
+        }
 
         return 0;
     } catch (const std::exception& e) {
@@ -41,4 +331,5 @@ int main() {
     } catch (...) {
         std::cerr << "Unknown error occurred!" << std::endl;
     }
+    return 1;
 }
@@ -0,0 +1,81 @@
+#include "numeric_literal.hpp"
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// Суффикс целого: u/U и l/L (ll) в любом порядке
+bool parse_integer_suffix(std::string_view suffix, bool& is_unsigned, bool& is_long) {
+    is_unsigned = false;
+    is_long = false;
+    std::size_t i = 0;
+    while (i < suffix.size()) {
+        char c = suffix[i];
+        if ((c == 'u' || c == 'U') && !is_unsigned) {
+            is_unsigned = true;
+            ++i;
+        } else if ((c == 'l' || c == 'L') && !is_long) {
+            is_long = true;
+            ++i;
+            if (i < suffix.size() && suffix[i] == c) ++i;   // ll - тоже long
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename T>
+bool fits(std::uint64_t value) {
+    return value <= static_cast<std::uint64_t>(std::numeric_limits<T>::max());
+}
+
+template <typename T>
+T parse_floating(std::string_view text) {
+    T value{};
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error == std::errc::result_out_of_range) {
+        throw std::runtime_error("Floating literal is out of range: " + std::string(text));
+    }
+    if (error != std::errc() || end != text.data() + text.size()) {
+        throw std::runtime_error("Invalid floating literal: " + std::string(text));
+    }
+    return value;
+}
+
+} // namespace
+
+NumericValue decode_integer(std::string_view digits, int base, std::string_view suffix) {
+    bool is_unsigned, is_long;
+    if (!parse_integer_suffix(suffix, is_unsigned, is_long)) {
+        throw std::runtime_error("Invalid suffix '" + std::string(suffix) + "' on integer literal");
+    }
+    if (digits.empty()) throw std::runtime_error("Integer literal has no digits");
+
+    std::uint64_t value = 0;
+    auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), value, base);
+    if (error == std::errc::result_out_of_range) {
+        throw std::runtime_error("Integer literal is too large: " + std::string(digits));
+    }
+    if (error != std::errc() || end != digits.data() + digits.size()) {
+        throw std::runtime_error("Invalid digit in integer literal: " + std::string(digits));
+    }
+
+    // Первый подходящий тип; восьмеричные, шестнадцатеричные и двоичные могут стать беззнаковыми
+    bool may_be_unsigned = is_unsigned || base != 10;
+    if (!is_unsigned && !is_long && fits<int>(value)) return static_cast<int>(value);
+    if (may_be_unsigned && !is_long && fits<unsigned>(value)) return static_cast<unsigned>(value);
+    if (!is_unsigned && fits<long>(value)) return static_cast<long>(value);
+    if (may_be_unsigned && fits<unsigned long>(value)) return static_cast<unsigned long>(value);
+    throw std::runtime_error("Integer literal is too large: " + std::string(digits));
+}
+
+NumericValue decode_floating(std::string_view text, std::string_view suffix) {
+    if (suffix.empty()) return parse_floating<double>(text);
+    if (suffix == "f" || suffix == "F") return parse_floating<float>(text);
+    if (suffix == "l" || suffix == "L") return parse_floating<long double>(text);
+    throw std::runtime_error("Invalid suffix '" + std::string(suffix) + "' on floating literal");
+}
@@ -0,0 +1,112 @@
+#include "parallel_lexer.hpp"
+#include "lexer.hpp"
+#include "scan_kernels.hpp"
+#include <algorithm>
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+struct Chunk {
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    TokenBuffer tokens;
+    Interner names;             // id идентификаторов куска - локальные до склейки
+    std::size_t resume = 0;     // начало первого токена за концом куска
+    bool ok = false;            // разбор "на удачу" прошёл без ошибок
+};
+
+// Индекс токена, начинающегося ровно в position, или tokens.size()
+std::size_t find_token_start(const TokenBuffer& tokens, std::size_t position) {
+    std::size_t lo = 0;
+    std::size_t hi = tokens.size();
+    while (lo < hi) {
+        std::size_t mid = lo + (hi - lo) / 2;
+        if (tokens.start(mid) < position) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo < tokens.size() && tokens.start(lo) == position ? lo : tokens.size();
+}
+
+} // namespace
+
+ParallelLexer::ParallelLexer(std::string_view input, ThreadPool& pool, std::size_t chunks)
+    : input(input), pool(pool), requested_chunks(chunks) {}
+
+TokenBuffer ParallelLexer::tokenize() {
+    chunk_count = 1;
+    resynced_count = 0;
+    relexed_count = 0;
+
+    std::size_t wanted = std::min(requested_chunks ? requested_chunks : pool.size(), input.size() / min_chunk_size);
+    if (wanted <= 1) return Lexer(input).tokenize();
+
+    // Куски начинаются сразу за переводом строки: там реже всего продолжается литерал или комментарий
+    const char* end = input.data() + input.size();
+    std::vector<Chunk> chunks;
+    std::size_t begin = 0;
+    for (std::size_t i = 1; i <= wanted; ++i) {
+        std::size_t chunk_end = input.size();
+        if (i < wanted) {
+            chunk_end = scan::find_newline(input.data() + input.size() / wanted * i, end) - input.data();
+            chunk_end = std::min(chunk_end + 1, input.size());
+        }
+        if (chunk_end <= begin) continue;
+        Chunk chunk;
+        chunk.begin = begin;
+        chunk.end = chunk_end;
+        chunks.push_back(std::move(chunk));
+        begin = chunk_end;
+    }
+    chunk_count = chunks.size();
+
+    std::vector<std::future<void>> done;
+    done.reserve(chunks.size());
+    for (auto& chunk : chunks) {
+        done.push_back(pool.submit([this, &chunk] {
+            try {
+                chunk.tokens = Lexer(input, chunk.begin, &chunk.names).tokenize_range(chunk.end, chunk.resume);
+                chunk.ok = true;
+            } catch (const std::runtime_error&) {
+                // начало куска оказалось внутри литерала или комментария - разберём при склейке
+                chunk.ok = false;
+            }
+        }));
+    }
+    for (auto& chunk_done : done) chunk_done.get();
+
+    // Склейка: position - истинное начало следующего токена
+    TokenBuffer tokens(input);
+    Lexer head(input);
+    head.skip_trivia();
+    std::size_t position = head.position();
+    for (auto& chunk : chunks) {
+        if (position >= chunk.end) continue;    // кусок целиком покрыт токеном или комментарием слева
+        std::size_t first = chunk.ok ? find_token_start(chunk.tokens, position) : chunk.tokens.size();
+        if (first == chunk.tokens.size()) {
+            // Последовательный разбор до первого токена, совпавшего с разбором куска.
+            // Ошибки лексирования здесь настоящие и выходят наружу, как у Lexer::tokenize
+            ++resynced_count;
+            std::size_t from = position;
+            Lexer lexer(input, position);
+            while (position < chunk.end && first == chunk.tokens.size()) {
+                lexer.next(tokens);
+                lexer.skip_trivia();
+                position = lexer.position();
+                if (chunk.ok) first = find_token_start(chunk.tokens, position);
+            }
+            relexed_count += std::min(position, chunk.end) - from;
+            if (first == chunk.tokens.size()) continue;
+        }
+        // Локальные id переводятся в глобальные по порядку токенов - как при последовательном разборе
+        std::size_t appended = tokens.size();
+        if (tokens.empty() && first == 0) tokens = std::move(chunk.tokens);
+        else tokens.append(chunk.tokens, first);
+        SymbolRemap remap(chunk.names);
+        tokens.remap_symbols(appended, remap);
+        position = chunk.resume;
+    }
+    tokens.push(TokenType::END, input.size(), 0);
+    return tokens;
+}
@@ -0,0 +1,130 @@
+#include "parallel_parser.hpp"
+#include "parser.hpp"
+#include <algorithm>
+#include <future>
+#include <vector>
+
+namespace {
+
+// Токены, с которых Parser::declaration начинает объявление переменной или функции
+bool starts_declarator(TokenType type) {
+    switch (type) {
+    case TokenType::TYPE_SHORT: case TokenType::TYPE_INT: case TokenType::TYPE_LONG:
+    case TokenType::TYPE_DOUBLE: case TokenType::TYPE_LONG_DOUBLE: case TokenType::TYPE_FLOAT:
+    case TokenType::TYPE_CHAR: case TokenType::TYPE_BOOL: case TokenType::TYPE_VOID:
+    case TokenType::KW_CONST: case TokenType::KW_STATIC: case TokenType::KW_UNSIGNED:
+    case TokenType::ID:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Начала объявлений верхнего уровня и, последним элементом, индекс END.
+// Пустой результат - вход не похож на корректную программу, его разбирает последовательный парсер
+std::vector<std::size_t> find_declarations(const TokenBuffer& tokens) {
+    std::vector<std::size_t> bounds;
+    std::size_t end = tokens.size() - 1;
+    auto type = [&](std::size_t i) { return tokens.type(std::min(i, end)); };
+
+    std::size_t i = 0;
+    while (i < end) {
+        bounds.push_back(i);
+        TokenType first = tokens.type(i);
+        bool function = starts_declarator(first) && type(i + 2) == TokenType::LPAREN;
+        if (!starts_declarator(first) && first != TokenType::KW_STRUCT && first != TokenType::KW_TYPEDEF &&
+            first != TokenType::KW_ASSERT) {
+            return {};
+        }
+
+        int depth = 0;
+        for (;; ++i) {
+            if (i == end) return {};
+            TokenType t = tokens.type(i);
+            if (t == TokenType::LPAREN || t == TokenType::LBRACE || t == TokenType::LBRACKET) {
+                ++depth;
+            } else if (t == TokenType::RPAREN || t == TokenType::RBRACE || t == TokenType::RBRACKET) {
+                if (--depth < 0) return {};
+                if (depth == 0 && function && t == TokenType::RBRACE) break;
+            } else if (t == TokenType::SEMICOLON && depth == 0) {
+                break;
+            }
+        }
+        ++i;
+    }
+    bounds.push_back(end);
+    return bounds;
+}
+
+} // namespace
+
+ParallelParser::ParallelParser(const TokenBuffer& tokens, ThreadPool& pool, std::size_t groups)
+    : tokens(tokens), pool(pool), requested_groups(groups) {}
+
+std::shared_ptr<TranslationUnitNode> ParallelParser::parse() {
+    declaration_count = 0;
+    group_count = 1;
+    fallback = false;
+
+    std::vector<std::size_t> bounds = find_declarations(tokens);
+    if (bounds.empty()) return parse_serial();
+    declaration_count = bounds.size() - 1;
+
+    // Границы групп - по началам объявлений, примерно поровну токенов на группу
+    std::size_t wanted = requested_groups ? requested_groups : pool.size() * 4;
+    wanted = std::max<std::size_t>(1, std::min(wanted, tokens.size() / min_group_tokens));
+    std::size_t per_group = tokens.size() / wanted + 1;
+    std::vector<std::size_t> group_bounds{0};
+    for (std::size_t d = 1; d < bounds.size(); ++d) {
+        if (bounds[d] - group_bounds.back() >= per_group || d + 1 == bounds.size()) group_bounds.push_back(bounds[d]);
+    }
+    group_count = group_bounds.size() - 1;
+
+    std::vector<std::future<std::shared_ptr<TranslationUnitNode>>> results;
+    results.reserve(group_count);
+    for (std::size_t g = 0; g < group_count; ++g) {
+        std::size_t begin = group_bounds[g];
+        std::size_t end = group_bounds[g + 1];
+        results.push_back(pool.submit([this, begin, end]() -> std::shared_ptr<TranslationUnitNode> {
+            Parser parser(tokens, begin);
+            parser.set_max_depth(max_depth);
+            parser.set_hash_consing(hash_consing);
+            parser.set_lazy_bodies(lazy_bodies);
+            try {
+                if (!parser.parse_range(end)) return nullptr;
+            } catch (const std::exception&) {
+                return nullptr;    // ошибку с правильной диагностикой выдаст последовательный разбор
+            }
+            return std::static_pointer_cast<TranslationUnitNode>(parser.getAST());
+        }));
+    }
+
+    auto root = std::make_shared<TranslationUnitNode>();
+    root->decls.reserve(declaration_count);
+    bool ok = true;
+    for (auto& result : results) {
+        auto part = result.get();    // дождаться всех задач: они ссылаются на tokens
+        if (!part) ok = false;
+        if (!ok) continue;
+        root->arena.absorb(part->arena);
+        for (Decl* decl : part->decls) {
+            auto function = node_cast<FunctionDecl>(decl);
+            if (function && function->deferred) function->deferred->move_to(root->arena);
+        }
+        root->decls.insert(root->decls.end(), part->decls.begin(), part->decls.end());
+    }
+    if (!ok) return parse_serial();
+    return root;
+}
+
+std::shared_ptr<TranslationUnitNode> ParallelParser::parse_serial() {
+    fallback = true;
+    Parser parser(tokens);
+    parser.set_max_depth(max_depth);
+    parser.set_hash_consing(hash_consing);
+    parser.set_lazy_bodies(lazy_bodies);
+    parser.parse();
+    auto root = std::static_pointer_cast<TranslationUnitNode>(parser.getAST());
+    declaration_count = root->decls.size();
+    return root;
+}
@@ -1,3 +1,5 @@
+#include <array>
+#include <cstdint>
 #include <iostream>
 #include <stdexcept>
 #include <unordered_map>
@@ -11,13 +13,517 @@ const std::unordered_map<TokenType, Modifier> token_to_modifier = {
     {TokenType::KW_UNSIGNED, Modifier::Unsigned},
 };
 
-Parser::Parser(const std::vector<Token>& tokens) : tokens(tokens) {}
+// ---------------- приоритеты бинарных операторов ----------------
 
-Token Parser::peek() const { return tokens[pos]; }
+namespace {
 
-Token Parser::advance() { return pos < tokens.size() ? tokens[pos++] : tokens.back(); }
+enum class OperatorKind : std::uint8_t { Binary, Logical, Assign, Ternary };
 
-bool Parser::check(TokenType type) const { return pos < tokens.size() && tokens[pos].type == type; }
+struct BinaryOperator {
+    int precedence = 0;     // 0 - токен не бинарный оператор
+    OperatorKind kind = OperatorKind::Binary;
+};
+
+constexpr int comma_precedence = 1;
+constexpr int assign_precedence = 2;
+
+constexpr std::array<BinaryOperator, static_cast<std::size_t>(TokenType::END) + 1> make_binary_operators() {
+    std::array<BinaryOperator, static_cast<std::size_t>(TokenType::END) + 1> table{};
+    auto set = [&table](TokenType type, int precedence, OperatorKind kind) {
+        table[static_cast<std::size_t>(type)] = {precedence, kind};
+    };
+    set(TokenType::COMMA, comma_precedence, OperatorKind::Binary);
+    for (auto type : {TokenType::ASSIGN, TokenType::PLUS_ASSIGN, TokenType::MINUS_ASSIGN,
+                      TokenType::MULT_ASSIGN, TokenType::DIV_ASSIGN, TokenType::MOD_ASSIGN}) {
+        set(type, assign_precedence, OperatorKind::Assign);
+    }
+    set(TokenType::QUESTION, 3, OperatorKind::Ternary);
+    set(TokenType::OR, 4, OperatorKind::Logical);
+    set(TokenType::AND, 5, OperatorKind::Logical);
+    for (auto type : {TokenType::EQ, TokenType::NEQ}) set(type, 6, OperatorKind::Binary);
+    for (auto type : {TokenType::LT, TokenType::GT, TokenType::LE, TokenType::GE}) set(type, 7, OperatorKind::Binary);
+    for (auto type : {TokenType::PLUS, TokenType::MINUS}) set(type, 8, OperatorKind::Binary);
+    for (auto type : {TokenType::STAR, TokenType::SLASH, TokenType::MOD}) set(type, 9, OperatorKind::Binary);
+    return table;
+}
+
+constexpr auto binary_operators = make_binary_operators();
+
+} // namespace
+
+// Отложенное тело функции: разбирается отдельным Parser с позиции '{' в арену, где лежит FunctionDecl
+class DeferredFunctionBody : public DeferredBody {
+public:
+    DeferredFunctionBody(const TokenBuffer& tokens, std::size_t begin, Arena& arena, ConstantPool& constants,
+                         std::size_t max_depth, bool hash_consing)
+        : tokens(tokens), begin(begin), arena(&arena), constants(constants), max_depth(max_depth),
+          hash_consing(hash_consing) {}
+
+    BlockStmt* parse() override {
+        Parser parser(tokens, begin);
+        parser.arena = arena;
+        parser.constants = &constants;
+        parser.max_depth = max_depth;
+        parser.set_hash_consing(hash_consing);
+        return static_cast<BlockStmt*>(parser.block_statement());
+    }
+    void move_to(Arena& target) override { arena = &target; }
+
+private:
+    const TokenBuffer& tokens;
+    std::size_t begin;
+    Arena* arena;
+    ConstantPool& constants;
+    std::size_t max_depth;
+    bool hash_consing;
+};
+
+// ---------------- разбор в плоскую форму ----------------
+
+// Та же грамматика, что у Parser, но узлы пишутся прямо в массивы FlatAST в прямом порядке.
+// Вид бинарного, постфиксного и тернарного узла становится известен после первого операнда:
+// такой узел вставляется перед уже записанным операндом (FlatAST::wrap). Там, где порядок
+// токенов расходится с порядком детей (do-while, размер и инициализатор массива), записанные
+// куски переставляются (FlatAST::rotate). Токены, диагностика и предел вложенности - общие с Parser
+class FlatParser {
+public:
+    FlatParser(Parser& parser, FlatAST& flat) : parser(parser), flat(flat) {}
+
+    void translation_unit() {
+        while (!parser.check(TokenType::END)) {
+            declaration();
+            flat.close(0);
+        }
+    }
+
+private:
+    Parser& parser;
+    FlatAST& flat;
+
+    std::uint32_t size() const { return static_cast<std::uint32_t>(flat.size()); }
+    template <typename Table>
+    static std::uint32_t last(const Table& table) { return static_cast<std::uint32_t>(table.size() - 1); }
+
+    void leaf(NodeKind kind, std::uint32_t data = FlatAST::no_data) { flat.close(flat.open(kind, data)); }
+    void none() { leaf(NodeKind::None); }
+    template <typename T>
+    void literal(const T& value) { leaf(NodeKind::Literal, ConstantPool::pack(flat.literals.add(value))); }
+    // Узел sizeof, выражение-тип которого - тип (в том числе пустой), а не имя
+    void set_type(std::uint32_t node, TypePtr type) {
+        flat.types.push_back(std::move(type));
+        flat.datas[node] = last(flat.types);
+    }
+
+    void declaration() {
+        if (parser.match(TokenType::KW_STRUCT)) return struct_decl();
+        if (parser.match(TokenType::KW_TYPEDEF)) return typedef_decl();
+        if (parser.token_is_type() || parser.token_is_modifier() || parser.check(TokenType::ID)) {
+            if (parser.cursor.peek_type(2) == TokenType::LPAREN) return func_decl();
+            return var_decl();
+        }
+        if (parser.match(TokenType::KW_ASSERT)) return assert_decl();
+        throw std::runtime_error("Unexpected token in declaration: " + std::string(parser.peek().value));
+    }
+
+    void typedef_decl() {
+        auto mods = parser.parse_modifiers();
+        if (!(parser.token_is_type() || parser.check(TokenType::ID))) {
+            parser.report("Error: type or id expected after typedef");
+        }
+        std::string_view original_type = parser.advance().value;
+        if (!parser.check(TokenType::ID)) {
+            parser.report("Error: alias(id) expected after typedef");
+        }
+        Symbol alias_name = parser.advance_symbol();
+        parser.expect(TokenType::SEMICOLON, "';' after typedef declaration");
+        flat.typedefs.push_back({mods, make_type(original_type, mods.has(Modifier::Const)), alias_name});
+        leaf(NodeKind::TypedefDecl, last(flat.typedefs));
+    }
+
+    void var_decl() {
+        if (parser.match(TokenType::SEMICOLON)) return none(); // пустая декларация
+
+        Modifiers modifiers = parser.parse_modifiers();
+        if (parser.check(TokenType::TYPE_VOID)) {
+            parser.report("Error: 'void' type cannot be used for variable declaration");
+        }
+        flat.var_types.push_back({make_type(parser.advance().value, modifiers.has(Modifier::Const)), modifiers});
+        std::uint32_t decl = flat.open(NodeKind::VarDecl, last(flat.var_types));
+        do {
+            std::uint32_t variable = flat.open(NodeKind::Variable, parser.advance_symbol().id);
+            std::uint32_t array_size = size();
+            bool is_array = parser.match(TokenType::LBRACKET);
+            if (is_array) {
+                flat.kinds[variable] = NodeKind::ArrayVariable;
+                if (!parser.check(TokenType::RBRACKET)) expression(false);
+                else none();
+                parser.expect(TokenType::RBRACKET, "']' after array size");
+            }
+            std::uint32_t init = size();
+            if (parser.match(TokenType::ASSIGN) || parser.check(TokenType::LBRACE)) {
+                if (parser.check(TokenType::LBRACE)) array_initializer();
+                else expression(false);
+            } else {
+                none();
+            }
+            if (is_array) flat.rotate(array_size, init);   // дети: инициализатор, затем размер
+            else none();
+            flat.close(variable);
+        } while (parser.match(TokenType::COMMA));
+
+        parser.expect(TokenType::SEMICOLON, "';' after variable declaration");
+        flat.close(decl);
+    }
+
+    void array_initializer() {
+        parser.expect(TokenType::LBRACE, "'{' to start array initializer");
+        std::uint32_t node = flat.open(NodeKind::ArrayInit);
+        while (!parser.check(TokenType::RBRACE)) {
+            expression(false);
+            if (!parser.check(TokenType::RBRACE)) parser.expect(TokenType::COMMA, "',' between array elements");
+        }
+        parser.expect(TokenType::RBRACE, "'}' to end array initializer");
+        flat.close(node);
+    }
+
+    void struct_decl() {
+        Symbol name = parser.advance_symbol();
+        parser.expect(TokenType::LBRACE, "'{' to start struct body");
+        std::uint32_t node = flat.open(NodeKind::StructDecl, name.id);
+        while (!parser.check(TokenType::RBRACE)) {
+            if (parser.match(TokenType::SEMICOLON)) continue;   // пустое поле - не VarDecl
+            var_decl();
+        }
+        parser.expect(TokenType::RBRACE, "'}' to end struct body");
+        parser.match(TokenType::ID);
+        parser.expect(TokenType::SEMICOLON, "';' after struct declaration");
+        flat.close(node);
+    }
+
+    void func_decl() {
+        auto return_mods = parser.parse_modifiers();
+        auto return_type = make_type(parser.advance().value, return_mods.has(Modifier::Const));
+        Symbol name = parser.advance_symbol();
+        auto params = parser.parameters();
+        flat.functions.push_back({return_mods, return_type, name, std::move(params)});
+        std::uint32_t node = flat.open(NodeKind::FunctionDecl, last(flat.functions));
+        if (parser.match(TokenType::SEMICOLON)) none();
+        else block_statement();
+        flat.close(node);
+    }
+
+    void assert_decl() {
+        parser.expect(TokenType::LPAREN, "'(' after assert");
+        flat.messages.emplace_back();
+        std::uint32_t node = flat.open(NodeKind::AssertDecl, last(flat.messages));
+        expression();
+        if (parser.match(TokenType::COMMA)) {
+            if (!parser.check(TokenType::STRING)) {
+                throw std::runtime_error("Expected string after ',' in assert statement");
+            }
+            parser.advance();   // как и в Parser::assert_decl, текст в узел не попадает
+        }
+        parser.expect(TokenType::RPAREN, "')' after assert");
+        parser.expect(TokenType::SEMICOLON, "';' after assert");
+        flat.close(node);
+    }
+
+    void block_statement() {
+        parser.expect(TokenType::LBRACE, "'{' to start block");
+        std::uint32_t node = flat.open(NodeKind::Block);
+        while (!parser.check(TokenType::RBRACE) && !parser.check(TokenType::END)) statement();
+        parser.expect(TokenType::RBRACE, "'}' to close block");
+        flat.close(node);
+    }
+
+    void statement() {
+        Parser::DepthGuard guard(parser);
+        if (parser.match(TokenType::KW_IF)) return conditional_statement();
+        if (parser.match(TokenType::KW_WHILE)) return while_statement();
+        if (parser.match(TokenType::KW_DO)) return do_while_statement();
+        if (parser.match(TokenType::KW_FOR)) return for_statement();
+        if (parser.match(TokenType::KW_RETURN)) return return_statement();
+        if (parser.match(TokenType::KW_BREAK)) return jump_statement(NodeKind::Break, "';' after break");
+        if (parser.match(TokenType::KW_CONTINUE)) return jump_statement(NodeKind::Continue, "';' after continue");
+        if (parser.match(TokenType::KW_PRINT) || parser.match(TokenType::KW_READ)) return io_statement();
+        if (parser.match(TokenType::KW_EXIT)) return exit_statement();
+        if (parser.check(TokenType::LBRACE)) return block_statement();
+        if ((parser.token_is_type() || parser.check(TokenType::ID)) && parser.cursor.peek_type(1) == TokenType::ID) {
+            std::uint32_t node = flat.open(NodeKind::ExprStmt);
+            var_decl();
+            return flat.close(node);
+        }
+        expr_statement();
+    }
+
+    void while_statement() {
+        parser.expect(TokenType::LPAREN, "'(' after while");
+        std::uint32_t node = flat.open(NodeKind::While);
+        expression();
+        parser.expect(TokenType::RPAREN, "')' after condition");
+        statement();
+        flat.close(node);
+    }
+
+    void do_while_statement() {
+        std::uint32_t node = flat.open(NodeKind::While);
+        statement();
+        parser.expect(TokenType::KW_WHILE, "'while' after do");
+        parser.expect(TokenType::LPAREN, "'(' after while");
+        std::uint32_t condition = size();
+        expression();
+        parser.expect(TokenType::RPAREN, "')' after condition");
+        parser.expect(TokenType::SEMICOLON, "';' after do-while");
+        flat.rotate(node + 1, condition);   // дети While: условие, затем тело
+        flat.close(node);
+    }
+
+    void for_statement() {
+        parser.expect(TokenType::LPAREN, "'(' after for");
+        std::uint32_t node = flat.open(NodeKind::For);
+        if (parser.check(TokenType::SEMICOLON)) {
+            none();
+        } else if (parser.token_is_type() || parser.check(TokenType::ID) || parser.token_is_modifier()) {
+            var_decl();
+        } else {
+            // выражение на месте объявления Parser::for_statement отбрасывает (node_cast<Decl>)
+            std::uint32_t init = size();
+            expression();
+            flat.truncate(init);
+            none();
+            parser.expect(TokenType::SEMICOLON, "';' after for initializer");
+        }
+        if (parser.check(TokenType::SEMICOLON)) none();
+        else expression();
+        parser.expect(TokenType::SEMICOLON, "';' after for condition");
+        if (parser.check(TokenType::RPAREN)) none();
+        else expression();
+        parser.expect(TokenType::RPAREN, "')' after for increment");
+        statement();
+        flat.close(node);
+    }
+
+    void jump_statement(NodeKind kind, const char* error_msg) {
+        parser.expect(TokenType::SEMICOLON, error_msg);
+        leaf(kind);
+    }
+
+    void expr_statement() {
+        if (parser.check(TokenType::SEMICOLON)) {
+            parser.advance();
+            return none();
+        }
+        std::uint32_t node = flat.open(NodeKind::ExprStmt);
+        expression();
+        parser.expect(TokenType::SEMICOLON, "';' after expression");
+        flat.close(node);
+    }
+
+    void conditional_statement() {
+        parser.expect(TokenType::LPAREN, "'(' after if");
+        std::uint32_t node = flat.open(NodeKind::If);
+        expression();
+        parser.expect(TokenType::RPAREN, "')' after condition");
+        statement();
+        if (parser.match(TokenType::KW_ELSE)) statement();
+        else none();
+        flat.close(node);
+    }
+
+    void return_statement() {
+        std::uint32_t node = flat.open(NodeKind::Return);
+        if (!parser.check(TokenType::SEMICOLON)) expression();
+        else none();
+        parser.expect(TokenType::SEMICOLON, "';' after return");
+        flat.close(node);
+    }
+
+    void io_statement() {
+        bool print = parser.previous().type == TokenType::KW_PRINT;
+        parser.expect(TokenType::LPAREN, "'(' after IO");
+        std::uint32_t node = flat.open(print ? NodeKind::Print : NodeKind::Read);
+        if (print) {
+            do {
+                expression(false);
+            } while (parser.match(TokenType::COMMA));
+        } else {
+            parser.expect(TokenType::ID, "variable name for read()");
+            leaf(NodeKind::Id, parser.advance_symbol().id);
+        }
+        parser.expect(TokenType::RPAREN, "')' after IO");
+        parser.expect(TokenType::SEMICOLON, "';' after IO");
+        flat.close(node);
+    }
+
+    void exit_statement() {
+        parser.expect(TokenType::LPAREN, "'(' after exit");
+        std::uint32_t node = flat.open(NodeKind::Exit);
+        expression();
+        parser.expect(TokenType::RPAREN, "')' after exit");
+        parser.expect(TokenType::SEMICOLON, "';' after exit");
+        flat.close(node);
+    }
+
+    void expression(bool allow_comma = true) {
+        binary_expression(allow_comma ? comma_precedence : assign_precedence);
+    }
+
+    // Как Parser::binary_expression: левый операнд уже записан с first, оператор оборачивает его
+    void binary_expression(int min_precedence) {
+        Parser::DepthGuard guard(parser);
+        std::uint32_t first = size();
+        unary();
+        while (true) {
+            TokenType type = parser.cursor.peek_type();
+            const BinaryOperator& op = binary_operators[static_cast<std::size_t>(type)];
+            if (op.precedence < min_precedence) break;
+            std::string spelling(parser.advance().value);
+            switch (op.kind) {
+                case OperatorKind::Ternary:
+                    flat.wrap(first, NodeKind::Ternary);
+                    expression();
+                    parser.expect(TokenType::COLON, "':' in ternary expression");
+                    expression();
+                    break;
+                case OperatorKind::Assign:
+                    flat.wrap(first, NodeKind::Assign, flat.intern_operator(spelling));
+                    binary_expression(op.precedence);
+                    break;
+                case OperatorKind::Logical:
+                    flat.wrap(first, NodeKind::Logical, flat.intern_operator(spelling));
+                    binary_expression(op.precedence + 1);
+                    break;
+                default:
+                    flat.wrap(first, NodeKind::Binary, flat.intern_operator(spelling));
+                    binary_expression(op.precedence + 1);
+                    break;
+            }
+            flat.close(first);
+        }
+    }
+
+    void unary() {
+        if (parser.match(TokenType::PLUS) || parser.match(TokenType::MINUS) || parser.match(TokenType::NOT)) {
+            Parser::DepthGuard guard(parser);
+            std::uint32_t node = flat.open(NodeKind::Unary, flat.intern_operator(std::string(parser.previous().value)));
+            unary();
+            return flat.close(node);
+        }
+        if (parser.match(TokenType::KW_SIZEOF)) {
+            // Дети: операнд и выражение-тип; у sizeof(тип) и sizeof выражение - индекс типа в данных
+            std::uint32_t node = flat.open(NodeKind::Sizeof);
+            if (parser.match(TokenType::LPAREN)) {
+                none();
+                if (parser.token_is_type()) {
+                    set_type(node, make_type(parser.advance().value));
+                    none();
+                } else if (parser.check(TokenType::ID)) {
+                    leaf(NodeKind::Id, parser.advance_symbol().id);
+                } else {
+                    set_type(node, nullptr);
+                    none();
+                }
+                parser.expect(TokenType::RPAREN, "')' after sizeof type");
+            } else {
+                expression();
+                set_type(node, nullptr);
+                none();
+            }
+            return flat.close(node);
+        }
+        postfix();
+    }
+
+    void postfix() {
+        std::uint32_t first = size();
+        primary();
+        while (true) {
+            if (parser.match(TokenType::INC) || parser.match(TokenType::DEC)) {
+                flat.wrap(first, NodeKind::Postfix, flat.intern_operator(std::string(parser.previous().value)));
+            } else if (parser.match(TokenType::LBRACKET)) {
+                flat.wrap(first, NodeKind::ArrayAccess);
+                expression();
+                parser.expect(TokenType::RBRACKET, "']' after array index");
+            } else if (parser.previous().type == TokenType::ID && parser.match(TokenType::LPAREN)) {
+                flat.wrap(first, NodeKind::Call);
+                if (!parser.check(TokenType::RPAREN)) {
+                    do {
+                        expression();
+                    } while (parser.match(TokenType::COMMA));
+                }
+                parser.expect(TokenType::RPAREN, "')' after function arguments");
+            } else if (parser.match(TokenType::DOT)) {
+                flat.wrap(first, NodeKind::MemberAccess);
+                std::uint32_t member = size();
+                expression();
+                if (flat.kind(member) != NodeKind::Id) {
+                    throw std::runtime_error("Expected member name after '.' in member access");
+                }
+            } else {
+                break;
+            }
+            flat.close(first);
+        }
+    }
+
+    void primary() {
+        if (parser.match(TokenType::NUM_INT) || parser.match(TokenType::NUM_DOUBLE)) {
+            const NumericValue& number = parser.cursor.previous_number();
+            return std::visit([this](auto value) { literal(value); }, number);
+        } else if (parser.match(TokenType::STRING)) {
+            return literal(parser.previous().value);
+        } else if (parser.match(TokenType::CHAR)) {
+            return literal(parser.previous().value[0]);
+        } else if (parser.match(TokenType::BOOL)) {
+            if (parser.previous().value == "true") return literal(true);
+            if (parser.previous().value == "false") return literal(false);
+        } else if (parser.match(TokenType::ID)) {
+            return leaf(NodeKind::Id, parser.cursor.previous_symbol().id);
+        } else if (parser.match(TokenType::LPAREN)) {
+            expression();
+            parser.expect(TokenType::RPAREN, "')' after expression");
+            return;
+        }
+        throw std::runtime_error("Unexpected token in primary expression: " + std::string(parser.peek().value));
+    }
+};
+
+Parser::Parser(const TokenBuffer& tokens) : cursor(tokens), tokens(&tokens) {}
+
+Parser::Parser(TokenPipeline& tokens) : cursor(tokens) {}
+
+Parser::Parser(const TokenBuffer& tokens, std::size_t begin) : cursor(tokens, begin), tokens(&tokens) {}
+
+Parser::DepthGuard::DepthGuard(Parser& parser) : parser(parser) {
+    if (parser.depth >= parser.max_depth) {
+        throw std::runtime_error("Nesting is too deep (more than " + std::to_string(parser.max_depth) +
+                                 " levels) at: " + std::string(parser.peek().value));
+    }
+    ++parser.depth;
+}
+
+void Parser::set_root(std::shared_ptr<TranslationUnitNode> node) {
+    root = std::move(node);
+    arena = &root->arena;
+    constants = root->constants;
+}
+
+Token Parser::peek() const { return cursor.peek(); }
+
+Token Parser::previous() const { return cursor.previous(); }
+
+Token Parser::advance() { return cursor.advance(); }
+
+Symbol Parser::advance_symbol() {
+    Token token = advance();
+    // id идентификатора уже выдан лексером; прочие токены на месте имени - ошибочный ввод
+    if (token.type == TokenType::ID) return cursor.previous_symbol();
+    // Новые id выдаются в порядке интернирования, а он у параллельных кусков не определён
+    if (speculative) ++error_count;
+    return intern(token.value);
+}
+
+bool Parser::check(TokenType type) const { return cursor.peek_type() == type; }
 
 bool Parser::token_is_type() const {
     return check(TokenType::TYPE_SHORT) || check(TokenType::TYPE_INT) || check(TokenType::TYPE_LONG) ||
@@ -39,14 +545,36 @@ bool Parser::match(TokenType type) {
 
 void Parser::expect(TokenType type, const std::string& error_msg) {
     if (!match(type)) //throw std::runtime_error("Expected " + error_msg + ", got: " + peek().value);
-        std::cout << "!Expected " + error_msg + ", got: " + peek().value << "(" + tokens[pos-1].value +" "+ peek().value +" " + (pos < tokens.size() ? tokens[pos+1].value : "" )+ ")" << std::endl ;
+        report("!Expected " + error_msg + ", got: " + std::string(peek().value) + "(" + std::string(previous().value) + " " +
+               std::string(peek().value) + " " + std::string(cursor.peek(1).value) + ")");
+}
+
+void Parser::report(const std::string& message) {
+    ++error_count;
+    if (!speculative) std::cout << message << std::endl;
 }
 
 void Parser::parse() {
-    root = std::make_shared<TranslationUnitNode>(); // Создаем корень AST
+    set_root(std::make_shared<TranslationUnitNode>()); // Создаем корень AST, он же владелец всех узлов
     translation_unit(); // Запускаем парсинг
 }
 
+FlatAST Parser::parse_flat() {
+    FlatAST flat;
+    FlatParser(*this, flat).translation_unit();
+    return flat;
+}
+
+bool Parser::parse_range(std::size_t end) {
+    set_root(std::make_shared<TranslationUnitNode>());
+    speculative = true;
+    error_count = 0;
+    while (cursor.position() < end && !check(TokenType::END)) {
+        root->decls.push_back(declaration());
+    }
+    return cursor.position() == end && error_count == 0;
+}
+
 std::shared_ptr<ASTNode> Parser::getAST() const {
     return root; // Возвращаем корень AST
 }
@@ -57,36 +585,38 @@ void Parser::translation_unit() {
     }
 }
 
-std::shared_ptr<Decl> Parser::declaration() {
+Decl* Parser::declaration() {
+    ++decl_epoch;
     if (match(TokenType::KW_STRUCT)) {
         return struct_decl();
     } else if (match(TokenType::KW_TYPEDEF)) {
         return typedef_decl();
     } else if (token_is_type() || token_is_modifier() || check(TokenType::ID)) {
-        if (tokens[pos + 2].type == TokenType::LPAREN) { // заменить !!!!!!!!!!!!!!!!!!!!!!!!!!!!!1
+        if (cursor.peek_type(2) == TokenType::LPAREN) { // заменить !!!!!!!!!!!!!!!!!!!!!!!!!!!!!1
             return func_decl();
         } else {
             return var_decl();
         }
     } else if (match(TokenType::KW_ASSERT)) return assert_decl();
 
-    throw std::runtime_error("Unexpected token in declaration: " + peek().value);
+    throw std::runtime_error("Unexpected token in declaration: " + std::string(peek().value));
 }
 
-std::shared_ptr<Decl> Parser::typedef_decl() {
+Decl* Parser::typedef_decl() {
     auto mods = parse_modifiers();          // Пропускаем модификаторы
     if (!(token_is_type() || check(TokenType::ID))) {
-        std::cout << "Error: type or id expected after typedef" << std::endl;
+        report("Error: type or id expected after typedef");
     }
-    auto original_type = advance().value;   // Пропускаем исходный тип
+    std::string_view original_type = advance().value;   // Пропускаем исходный тип
     if (!check(TokenType::ID)) {
-        std::cout << "Error: alias(id) expected after typedef" << std::endl;
+        report("Error: alias(id) expected after typedef");
     }
-    auto alias_name = advance().value;      // Пропускаем имя псевдонима
+    Symbol alias_name = advance_symbol();     // Пропускаем имя псевдонима
+    ++scope_epoch;
 
     expect(TokenType::SEMICOLON, "';' after typedef declaration");
 
-    return std::make_shared<TypedefDecl>(mods, make_type(original_type, mods.has(Modifier::Const)), alias_name);
+    return make<TypedefDecl>(mods, make_type(original_type, mods.has(Modifier::Const)), alias_name);
 }
 
 Modifiers Parser::parse_modifiers() {
@@ -105,20 +635,20 @@ Modifiers Parser::parse_modifiers() {
     return modifiers;
 }
 
-std::shared_ptr<Decl> Parser::var_decl() {
+Decl* Parser::var_decl() {
     if(match(TokenType::SEMICOLON)) return nullptr; // пустая декларация
 
     Modifiers modifiers = parse_modifiers();
 
     if (check(TokenType::TYPE_VOID)) {
-        std::cout << "Error: 'void' type cannot be used for variable declaration" << std::endl;
+        report("Error: 'void' type cannot be used for variable declaration");
     }
     auto type = make_type(advance().value, modifiers.has(Modifier::Const)); // пропуск type
 
     std::vector<Variable> variables;
 
     do {
-        auto name = advance().value;
+        Symbol name = advance_symbol();
         ExprPtr size = nullptr;
         ExprPtr init = nullptr;
         bool is_array = false;
@@ -137,14 +667,15 @@ std::shared_ptr<Decl> Parser::var_decl() {
                 init = expression(false);
             }
         }
+        ++scope_epoch;      // имя видно только после своего инициализатора
         variables.emplace_back(name, init, size, is_array); // ф-ция создает объект сразу в списке
     } while (match(TokenType::COMMA));
 
     expect(TokenType::SEMICOLON, "';' after variable declaration");
-    return std::make_shared<VarDecl>(type, variables, modifiers);
+    return make<VarDecl>(type, variables, modifiers);
 }
 
-std::shared_ptr<Expr> Parser::array_initializer() {
+Expr* Parser::array_initializer() {
     expect(TokenType::LBRACE, "'{' to start array initializer");
     std::vector<ExprPtr> elements;
     while (!check(TokenType::RBRACE)) {
@@ -152,15 +683,16 @@ std::shared_ptr<Expr> Parser::array_initializer() {
         if (!check(TokenType::RBRACE)) expect(TokenType::COMMA, "',' between array elements");
     }
     expect(TokenType::RBRACE, "'}' to end array initializer");
-    return std::make_shared<ArrayInitExpr>(elements);
+    return make<ArrayInitExpr>(elements);
 }
 
-std::shared_ptr<Decl> Parser::struct_decl() {
-    auto name = advance().value; // пропуск struct name
+Decl* Parser::struct_decl() {
+    Symbol name = advance_symbol(); // пропуск struct name
+    ++scope_epoch;
     expect(TokenType::LBRACE, "'{' to start struct body");
     std::vector<VarDecl> fields;
     while (!check(TokenType::RBRACE)) {
-        fields.push_back(*std::dynamic_pointer_cast<VarDecl>(var_decl()));
+        fields.push_back(*node_cast<VarDecl>(var_decl()));
     }
     expect(TokenType::RBRACE, "'}' to end struct body");
     
@@ -168,43 +700,70 @@ std::shared_ptr<Decl> Parser::struct_decl() {
     match(TokenType::ID);
       
     expect(TokenType::SEMICOLON, "';' after struct declaration");
-    return std::make_shared<StructDecl>(name, fields);
+    return make<StructDecl>(name, fields);
 }
 
-std::shared_ptr<FunctionDecl> Parser::func_decl() {
+FunctionDecl* Parser::func_decl() {
     auto return_mods = parse_modifiers();
     auto return_type = make_type(advance().value, return_mods.has(Modifier::Const)); // пропуск return type
-    auto name = advance().value; // пропуск function name
-    expect(TokenType::LPAREN, "'(' after function name");
+    Symbol name = advance_symbol(); // пропуск function name
+    ++scope_epoch;
+    auto params = parameters();
+
+    if (match(TokenType::SEMICOLON)) {
+        return make<FunctionDecl>(return_mods, return_type, name, params);
+    }
+    if (lazy_bodies && tokens && check(TokenType::LBRACE)) {
+        std::size_t begin = cursor.position();
+        if (std::size_t end = body_end(begin)) {
+            cursor.seek(end);
+            auto deferred = make<DeferredFunctionBody>(*tokens, begin, *arena, *constants, max_depth, interner != nullptr);
+            return make<FunctionDecl>(return_mods, return_type, name, params, deferred);
+        }
+        // несбалансированное тело разбирается сразу, чтобы ошибка была выдана на своём месте
+    }
+    auto body = static_cast<BlockStmt*>(block_statement());
+    return make<FunctionDecl>(return_mods, return_type, name, params, body);
+}
 
-    std::vector<std::pair<std::pair<Modifiers, TypePtr>, std::string>> params;
+std::vector<std::pair<std::pair<Modifiers, TypePtr>, Symbol>> Parser::parameters() {
+    expect(TokenType::LPAREN, "'(' after function name");
+    std::vector<std::pair<std::pair<Modifiers, TypePtr>, Symbol>> params;
     while (!check(TokenType::RPAREN)) {
         auto param_mods = parse_modifiers();
         auto param_type = make_type(advance().value, param_mods.has(Modifier::Const)); // param type
-        auto param_name = advance().value; // param name
+        Symbol param_name = advance_symbol(); // param name
+        ++scope_epoch;
         params.emplace_back(std::make_pair(param_mods, param_type), param_name);
         if (!check(TokenType::RPAREN)) expect(TokenType::COMMA, "',' between parameters");
     }
     expect(TokenType::RPAREN, "')' after parameters");
+    return params;
+}
 
-    if (match(TokenType::SEMICOLON)) {
-        return std::make_shared<FunctionDecl>(return_mods, return_type, name, params, nullptr);
+std::size_t Parser::body_end(std::size_t begin) const {
+    std::size_t depth = 0;
+    for (std::size_t i = begin; i + 1 < tokens->size(); ++i) {
+        TokenType type = tokens->type(i);
+        if (type == TokenType::LBRACE) ++depth;
+        else if (type == TokenType::RBRACE && --depth == 0) return i + 1;
     }
-    auto body = std::dynamic_pointer_cast<BlockStmt>(block_statement());
-    return std::make_shared<FunctionDecl>(return_mods, return_type, name, params, body);
+    return 0;
 }
 
-std::shared_ptr<Stmt> Parser::block_statement() {
+Stmt* Parser::block_statement() {
     expect(TokenType::LBRACE, "'{' to start block");
-    auto block = std::make_shared<BlockStmt>();
+    auto block = make<BlockStmt>();
     while (!check(TokenType::RBRACE) && !check(TokenType::END)) {
         block->statements.push_back(statement());
     }
     expect(TokenType::RBRACE, "'}' to close block");
+    ++scope_epoch;      // объявления блока больше не видны
     return block;
 }
 
-std::shared_ptr<Stmt> Parser::statement() {
+Stmt* Parser::statement() {
+    DepthGuard guard(*this);
     if (match(TokenType::KW_IF)) return conditional_statement();
     if (match(TokenType::KW_WHILE)) return while_statement();
     if (match(TokenType::KW_DO)) return do_while_statement();
@@ -215,38 +774,38 @@ std::shared_ptr<Stmt> Parser::statement() {
     if (match(TokenType::KW_PRINT) || match(TokenType::KW_READ)) return io_statement();
     if (match(TokenType::KW_EXIT)) return exit_statement();
     if (check(TokenType::LBRACE)) return block_statement();
-    if ((token_is_type() || check(TokenType::ID)) && tokens[pos + 1].type == TokenType::ID) {
-        return std::make_shared<ExprStmt>(var_decl());
+    if ((token_is_type() || check(TokenType::ID)) && cursor.peek_type(1) == TokenType::ID) {
+        return make<ExprStmt>(var_decl());
     }
     return expr_statement();
 }
 
-std::shared_ptr<Stmt> Parser::while_statement() {
+Stmt* Parser::while_statement() {
     expect(TokenType::LPAREN, "'(' after while");
     auto condition = expression();
     expect(TokenType::RPAREN, "')' after condition");
     auto body = statement();
-    return std::make_shared<WhileStmt>(condition, body);
+    return make<WhileStmt>(condition, body);
 }
 
-std::shared_ptr<Stmt> Parser::do_while_statement() {
+Stmt* Parser::do_while_statement() {
     auto body = statement();
     expect(TokenType::KW_WHILE, "'while' after do");
     expect(TokenType::LPAREN, "'(' after while");
     auto condition = expression();
     expect(TokenType::RPAREN, "')' after condition");
     expect(TokenType::SEMICOLON, "';' after do-while");
-    return std::make_shared<WhileStmt>(condition, body);
+    return make<WhileStmt>(condition, body);
 }
 
-std::shared_ptr<Stmt> Parser::for_statement() {
+Stmt* Parser::for_statement() {
     expect(TokenType::LPAREN, "'(' after for");
-    std::shared_ptr<Decl> init = nullptr;
+    Decl* init = nullptr;
     if (!check(TokenType::SEMICOLON)) {
         if (token_is_type() || check(TokenType::ID) || token_is_modifier()) {
             init = var_decl();
         } else {
-            init = std::dynamic_pointer_cast<Decl>(expression());
+            init = node_cast<Decl>(expression());
             expect(TokenType::SEMICOLON, "';' after for initializer");
         }
     }
@@ -255,48 +814,49 @@ std::shared_ptr<Stmt> Parser::for_statement() {
     auto increment = check(TokenType::RPAREN) ? nullptr : expression();
     expect(TokenType::RPAREN, "')' after for increment");
     auto body = statement();
-    return std::make_shared<ForStmt>(init, condition, increment, body);
+    ++scope_epoch;
+    return make<ForStmt>(init, condition, increment, body);
 }
 
-std::shared_ptr<Stmt> Parser::break_statement() {
+Stmt* Parser::break_statement() {
     expect(TokenType::SEMICOLON, "';' after break");
-    return std::make_shared<BreakStmt>();
+    return make<BreakStmt>();
 }
 
-std::shared_ptr<Stmt> Parser::continue_statement() {
+Stmt* Parser::continue_statement() {
     expect(TokenType::SEMICOLON, "';' after continue");
-    return std::make_shared<ContinueStmt>();
+    return make<ContinueStmt>();
 }
 
-std::shared_ptr<Stmt> Parser::expr_statement() {
+Stmt* Parser::expr_statement() {
     if (check(TokenType::SEMICOLON)) {
         advance(); // пропуск ';'
         return nullptr;
     }
     auto expr = expression();
     expect(TokenType::SEMICOLON, "';' after expression");
-    return std::make_shared<ExprStmt>(expr);
+    return make<ExprStmt>(expr);
 }
 
-std::shared_ptr<Stmt> Parser::conditional_statement() {
+Stmt* Parser::conditional_statement() {
     expect(TokenType::LPAREN, "'(' after if");
     auto condition = expression();
     expect(TokenType::RPAREN, "')' after condition");
     auto then_branch = statement();
-    std::shared_ptr<Stmt> else_branch = nullptr;
+    Stmt* else_branch = nullptr;
     if (match(TokenType::KW_ELSE)) else_branch = statement();
-    return std::make_shared<IfStmt>(condition, then_branch, else_branch);
+    return make<IfStmt>(condition, then_branch, else_branch);
 }
 
-std::shared_ptr<Stmt> Parser::return_statement() {
-    std::shared_ptr<Expr> value = nullptr;
+Stmt* Parser::return_statement() {
+    Expr* value = nullptr;
     if (!check(TokenType::SEMICOLON)) value = expression();
     expect(TokenType::SEMICOLON, "';' after return");
-    return std::make_shared<ReturnStmt>(value);
+    return make<ReturnStmt>(value);
 }
 
-std::shared_ptr<Stmt> Parser::io_statement() {
-    auto type = tokens[pos - 1].type;
+Stmt* Parser::io_statement() {
+    auto type = previous().type;
     expect(TokenType::LPAREN, "'(' after IO");
     ExprPtr expr = nullptr; 
     std::vector<ExprPtr> args;
@@ -307,19 +867,19 @@ std::shared_ptr<Stmt> Parser::io_statement() {
         } while (match(TokenType::COMMA));
     } else {
         expect(TokenType::ID, "variable name for read()");
-        expr = std::make_shared<IdExpr>(advance().value);
+        expr = make<IdExpr>(advance_symbol());
     }
     expect(TokenType::RPAREN, "')' after IO");
     expect(TokenType::SEMICOLON, "';' after IO");
     if (type == TokenType::KW_PRINT) {
-        return std::make_shared<PrintStmt>(args);
+        return make<PrintStmt>(args);
     } else if(type == TokenType::KW_READ){
-        return std::make_shared<ReadStmt>(expr);
+        return make<ReadStmt>(expr);
     }
-    throw std::runtime_error("Unexpected token in IO statement: " + peek().value);
+    throw std::runtime_error("Unexpected token in IO statement: " + std::string(peek().value));
 }
 
-std::shared_ptr<Decl> Parser::assert_decl() {
+Decl* Parser::assert_decl() {
     expect(TokenType::LPAREN, "'(' after assert");
     auto expr = expression();
     std::string message = "";
@@ -327,147 +887,95 @@ std::shared_ptr<Decl> Parser::assert_decl() {
         if(!check(TokenType::STRING)) {
             throw std::runtime_error("Expected string after ',' in assert statement");
         }
-        auto message = advance().value;
+        std::string message(advance().value);
         }
     expect(TokenType::RPAREN, "')' after assert");  // опц строка 
     expect(TokenType::SEMICOLON, "';' after assert");
-    return std::make_shared<AssertDecl>(expr, message);
+    return make<AssertDecl>(expr, message);
 }
 
-std::shared_ptr<Stmt> Parser::exit_statement() {
+Stmt* Parser::exit_statement() {
     expect(TokenType::LPAREN, "'(' after exit");
     auto expr = expression();
     expect(TokenType::RPAREN, "')' after exit");
     expect(TokenType::SEMICOLON, "';' after exit");
-    return std::make_shared<ExitStmt>(expr);
+    return make<ExitStmt>(expr);
 }
 
-std::shared_ptr<Expr> Parser::expression(bool allow_comma) {
-    auto expr = assignment();
-    if(allow_comma){
-        while (match(TokenType::COMMA)) {
-            auto right = assignment();
-            expr = std::make_shared<BinaryExpr>(",", expr, right);
-        }
-    }
-    return expr;
+Expr* Parser::expression(bool allow_comma) {
+    return binary_expression(allow_comma ? comma_precedence : assign_precedence);
 }
 
-std::shared_ptr<Expr> Parser::assignment() {
-    auto expr = ternary_expression();
-    if (match(TokenType::ASSIGN) || match(TokenType::PLUS_ASSIGN) || match(TokenType::MINUS_ASSIGN) ||
-    match(TokenType::MULT_ASSIGN) || match(TokenType::DIV_ASSIGN) || match(TokenType::MOD_ASSIGN)) {
-        auto op = tokens[pos - 1].value;
-        auto value = assignment(); // правоассоциативность
-        return std::make_shared<AssignExpr>(op, expr, value);
-    }
-    return expr;
-}
-
-std::shared_ptr<Expr> Parser::ternary_expression() {
-    auto condition = logical_or();
-    if (match(TokenType::QUESTION)) {
-        auto true_expr = expression();
-        expect(TokenType::COLON, "':' in ternary expression");
-        auto false_expr = expression();
-        return std::make_shared<TernaryExpr>(condition, true_expr, false_expr);
-    }
-    return condition;
-}
-
-std::shared_ptr<Expr> Parser::logical_or() {
-    auto expr = logical_and();
-    while (match(TokenType::OR)) {
-        auto right = logical_and();
-        expr = std::make_shared<LogicalExpr>(tokens[pos - 1].value, expr, right);
-    }
-    return expr;
-}
-
-std::shared_ptr<Expr> Parser::logical_and() {
-    auto expr = equality();
-    while (match(TokenType::AND)) {
-        auto right = equality();
-        expr = std::make_shared<LogicalExpr>(tokens[pos - 1].value, expr, right);
-    }
-    return expr;
-}
-
-std::shared_ptr<Expr> Parser::equality() {
-    auto expr = comparison();
-    while (match(TokenType::EQ) || match(TokenType::NEQ)) {
-        auto op = tokens[pos - 1].value;
-        auto right = comparison();
-        expr = std::make_shared<BinaryExpr>(op, expr, right);
-    }
-    return expr;
-}
-
-std::shared_ptr<Expr> Parser::comparison() {
-    auto expr = term();
-    while (match(TokenType::LT) || match(TokenType::GT) || match(TokenType::LE) || match(TokenType::GE)) {
-        auto op = tokens[pos - 1].value;
-        auto right = term();
-        expr = std::make_shared<BinaryExpr>(op, expr, right);
-    }
-    return expr;
-}
-
-std::shared_ptr<Expr> Parser::term() {
-    auto expr = factor();
-    while (match(TokenType::PLUS) || match(TokenType::MINUS)) {
-        auto op = tokens[pos - 1].value;
-        auto right = factor();
-        expr = std::make_shared<BinaryExpr>(op, expr, right);
-    }
-    return expr;
-}
-
-std::shared_ptr<Expr> Parser::factor() {
-    auto expr = unary();
-    while (match(TokenType::STAR) || match(TokenType::SLASH) || match(TokenType::MOD)) {
-        auto op = tokens[pos - 1].value;
-        auto right = unary();
-        expr = std::make_shared<BinaryExpr>(op, expr, right);
+// Разбор по приоритетам (precedence climbing). Левоассоциативные операторы разбирают правый
+// операнд с приоритетом на единицу выше, присваивание - с тем же (правая ассоциативность).
+// Ветви тернарного оператора - полные выражения, как и прежде
+Expr* Parser::binary_expression(int min_precedence) {
+    DepthGuard guard(*this);
+    Expr* expr = unary();
+    while (true) {
+        TokenType type = cursor.peek_type();
+        const BinaryOperator& op = binary_operators[static_cast<std::size_t>(type)];
+        if (op.precedence < min_precedence) break;     // у не-операторов приоритет 0
+        std::string spelling(advance().value);
+        switch (op.kind) {
+            case OperatorKind::Ternary: {
+                auto true_expr = expression();
+                expect(TokenType::COLON, "':' in ternary expression");
+                auto false_expr = expression();
+                expr = make_expr<TernaryExpr>(0, {expr, true_expr, false_expr}, expr, true_expr, false_expr);
+                break;
+            }
+            case OperatorKind::Assign:
+                expr = make<AssignExpr>(spelling, expr, binary_expression(op.precedence));
+                break;
+            case OperatorKind::Logical:
+                expr = binary<LogicalExpr>(type, spelling, expr, binary_expression(op.precedence + 1));
+                break;
+            default:
+                expr = binary<BinaryExpr>(type, spelling, expr, binary_expression(op.precedence + 1));
+                break;
+        }
     }
     return expr;
 }
 
-std::shared_ptr<Expr> Parser::unary() {
+Expr* Parser::unary() {
     if (match(TokenType::PLUS) || match(TokenType::MINUS) || match(TokenType::NOT)) {
-        auto op = tokens[pos - 1].value;
+        DepthGuard guard(*this);
+        TokenType type = previous().type;
+        std::string op(previous().value);
         auto operand = unary();
-        return std::make_shared<UnaryExpr>(op, operand);
+        return make_expr<UnaryExpr>(static_cast<std::uint32_t>(type), {operand}, op, operand);
     }else if(match(TokenType::KW_SIZEOF)){
         if(match(TokenType::LPAREN)){
             std::variant<TypePtr, ExprPtr> type;
             if(token_is_type()){
                 type = make_type(advance().value);
             }else if(check(TokenType::ID)){
-                type = std::make_shared<IdExpr>(advance().value);
+                type = make<IdExpr>(advance_symbol());
             }
             expect(TokenType::RPAREN, "')' after sizeof type");
-            return std::make_shared<SizeofExpr>(nullptr, type);
+            return make<SizeofExpr>(nullptr, type);
         }else{
             auto operand = expression();
-            return std::make_shared<SizeofExpr>(operand, nullptr);
+            return make<SizeofExpr>(operand, TypePtr(nullptr));
         }
 
     }
     return postfix();
 }
 
-std::shared_ptr<Expr> Parser::postfix() {
+Expr* Parser::postfix() {
     auto expr = primary();
     while (true) {
         if (match(TokenType::INC) || match(TokenType::DEC)) {
-            auto op = tokens[pos - 1].value;
-            expr = std::make_shared<PostfixExpr>(expr, op);
+            std::string op(previous().value);
+            expr = make<PostfixExpr>(expr, op);
         } else if (match(TokenType::LBRACKET)) {
             auto index = expression();
             expect(TokenType::RBRACKET, "']' after array index");
-            expr = std::make_shared<ArrayAccessExpr>(expr, index);
-        } else if (tokens[pos-1].type == TokenType::ID && match(TokenType::LPAREN)) {
+            expr = make_expr<ArrayAccessExpr>(0, {expr, index}, expr, index);
+        } else if (previous().type == TokenType::ID && match(TokenType::LPAREN)) {
             std::vector<ExprPtr> args;
             if (!check(TokenType::RPAREN)) {
                 do {
@@ -475,13 +983,13 @@ std::shared_ptr<Expr> Parser::postfix() {
                 } while (match(TokenType::COMMA));
             }
             expect(TokenType::RPAREN, "')' after function arguments");
-            expr = std::make_shared<CallExpr>(expr, args);
+            expr = make<CallExpr>(expr, args);
         } else if (match(TokenType::DOT)) {
             auto member = expression();
-            if(!std::dynamic_pointer_cast<IdExpr>(member)) {
+            if(!node_cast<IdExpr>(member)) {
                 throw std::runtime_error("Expected member name after '.' in member access");
             }
-            expr = std::make_shared<MemberAccessExpr>(expr, member);
+            expr = make_expr<MemberAccessExpr>(0, {expr, member}, expr, member);
         } else {
             break;
         }
@@ -489,30 +997,31 @@ std::shared_ptr<Expr> Parser::postfix() {
     return expr;
 }
 
-std::shared_ptr<Expr> Parser::primary() {
-    if (match(TokenType::NUM_INT)){
-        return std::make_shared<LiteralExpr>( std::stoi(tokens[pos - 1].value));
-    } else if (match(TokenType::NUM_DOUBLE)){
-        return std::make_shared<LiteralExpr>( std::stod(tokens[pos - 1].value));
+Expr* Parser::primary() {
+    if (match(TokenType::NUM_INT) || match(TokenType::NUM_DOUBLE)){
+        // Значение уже декодировано лексером
+        const NumericValue& number = cursor.previous_number();
+        return std::visit([this](auto value) { return literal(value); }, number);
     } else if (match(TokenType::STRING)){
-        return std::make_shared<LiteralExpr>(tokens[pos - 1].value);
+        return literal(previous().value);
     } else if(match(TokenType::CHAR)){
-        return std::make_shared<LiteralExpr>(tokens[pos - 1].value[0]);
+        return literal(previous().value[0]);
     } else if(match(TokenType::BOOL)) {
-        if (tokens[pos - 1].value == "true") {
-            return std::make_shared<LiteralExpr>(true);
-        } else if (tokens[pos - 1].value == "false") {
-            return std::make_shared<LiteralExpr>(false);
+        if (previous().value == "true") {
+            return literal(true);
+        } else if (previous().value == "false") {
+            return literal(false);
         }
     } else if (match(TokenType::ID)) {
-        return std::make_shared<IdExpr>(tokens[pos - 1].value);
+        Symbol name = cursor.previous_symbol();
+        return make_expr<IdExpr>(name.id, {}, name);
     } else if (match(TokenType::LPAREN)) {
         auto expr = expression();
         expect(TokenType::RPAREN, "')' after expression");
         return expr;
     }
 
-    throw std::runtime_error("Unexpected token in primary expression: " + peek().value);
+    throw std::runtime_error("Unexpected token in primary expression: " + std::string(peek().value));
 }
 
 
@@ -0,0 +1,26 @@
+#include "perf_stats.hpp"
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+std::size_t peak_rss_bytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.PeakWorkingSetSize;
+    }
+    return 0;
+#else
+    struct rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+    return static_cast<std::size_t>(usage.ru_maxrss);           // macOS: байты
+#else
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;    // Linux: килобайты
+#endif
+#endif
+}
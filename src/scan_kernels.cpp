@@ -0,0 +1,268 @@
+#include "scan_kernels.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SCAN_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define SCAN_TARGET_AVX2
+#else
+#define SCAN_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace scan {
+
+namespace {
+
+constexpr std::array<std::uint8_t, 256> make_char_class() {
+    std::array<std::uint8_t, 256> table{};
+    for (int c = 0; c < 256; ++c) {
+        std::uint8_t cls = 0;
+        if (c == ' ' || (c >= '\t' && c <= '\r')) cls |= Space;
+        if (c >= '0' && c <= '9') cls |= Digit;
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_') cls |= Alpha;
+        table[c] = cls;
+    }
+    return table;
+}
+
+// ---------------- скалярная реализация ----------------
+
+const char* skip_whitespace_scalar(const char* p, const char* end) {
+    while (p < end && is_space(*p)) ++p;
+    return p;
+}
+
+const char* skip_identifier_scalar(const char* p, const char* end) {
+    while (p < end && is_ident(*p)) ++p;
+    return p;
+}
+
+const char* skip_digits_scalar(const char* p, const char* end) {
+    while (p < end && is_digit(*p)) ++p;
+    return p;
+}
+
+const char* find_newline_scalar(const char* p, const char* end) {
+    while (p < end && *p != '\n') ++p;
+    return p;
+}
+
+const char* find_comment_end_scalar(const char* p, const char* end) {
+    while (p + 1 < end && !(p[0] == '*' && p[1] == '/')) ++p;
+    return p + 1 < end ? p : end;
+}
+
+#if defined(SCAN_X86)
+
+inline unsigned first_bit(unsigned mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+// ---------------- SSE2: 16 байт за шаг ----------------
+// Сравнения знаковые: байты >= 0x80 отрицательны и не попадают ни в один класс
+
+inline __m128i in_range_sse2(__m128i x, char lo, char hi) {
+    return _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8(static_cast<char>(lo - 1))),
+                         _mm_cmplt_epi8(x, _mm_set1_epi8(static_cast<char>(hi + 1))));
+}
+
+const char* skip_whitespace_sse2(const char* p, const char* end) {
+    for (; end - p >= 16; p += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(' ')), in_range_sse2(x, '\t', '\r'));
+        unsigned stop = ~static_cast<unsigned>(_mm_movemask_epi8(hit)) & 0xFFFFu;
+        if (stop) return p + first_bit(stop);
+    }
+    return skip_whitespace_scalar(p, end);
+}
+
+const char* skip_identifier_sse2(const char* p, const char* end) {
+    for (; end - p >= 16; p += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i lower = _mm_or_si128(x, _mm_set1_epi8(0x20));
+        __m128i hit = _mm_or_si128(_mm_or_si128(in_range_sse2(lower, 'a', 'z'), in_range_sse2(x, '0', '9')),
+                                   _mm_cmpeq_epi8(x, _mm_set1_epi8('_')));
+        unsigned stop = ~static_cast<unsigned>(_mm_movemask_epi8(hit)) & 0xFFFFu;
+        if (stop) return p + first_bit(stop);
+    }
+    return skip_identifier_scalar(p, end);
+}
+
+const char* skip_digits_sse2(const char* p, const char* end) {
+    for (; end - p >= 16; p += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        unsigned stop = ~static_cast<unsigned>(_mm_movemask_epi8(in_range_sse2(x, '0', '9'))) & 0xFFFFu;
+        if (stop) return p + first_bit(stop);
+    }
+    return skip_digits_scalar(p, end);
+}
+
+const char* find_newline_sse2(const char* p, const char* end) {
+    for (; end - p >= 16; p += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        unsigned found = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_set1_epi8('\n'))));
+        if (found) return p + first_bit(found);
+    }
+    return find_newline_scalar(p, end);
+}
+
+const char* find_comment_end_sse2(const char* p, const char* end) {
+    // '*' в позиции i и '/' в позиции i + 1: второй вектор загружается со сдвигом на байт
+    for (; end - p >= 17; p += 16) {
+        __m128i star = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), _mm_set1_epi8('*'));
+        __m128i slash = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 1)), _mm_set1_epi8('/'));
+        unsigned found = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(star, slash)));
+        if (found) return p + first_bit(found);
+    }
+    return find_comment_end_scalar(p, end);
+}
+
+// ---------------- AVX2: 32 байта за шаг ----------------
+
+SCAN_TARGET_AVX2 inline __m256i in_range_avx2(__m256i x, char lo, char hi) {
+    return _mm256_and_si256(_mm256_cmpgt_epi8(x, _mm256_set1_epi8(static_cast<char>(lo - 1))),
+                            _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(hi + 1)), x));
+}
+
+SCAN_TARGET_AVX2 const char* skip_whitespace_avx2(const char* p, const char* end) {
+    for (; end - p >= 32; p += 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i hit = _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')), in_range_avx2(x, '\t', '\r'));
+        unsigned stop = ~static_cast<unsigned>(_mm256_movemask_epi8(hit));
+        if (stop) return p + first_bit(stop);
+    }
+    return skip_whitespace_sse2(p, end);
+}
+
+SCAN_TARGET_AVX2 const char* skip_identifier_avx2(const char* p, const char* end) {
+    for (; end - p >= 32; p += 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i lower = _mm256_or_si256(x, _mm256_set1_epi8(0x20));
+        __m256i hit = _mm256_or_si256(_mm256_or_si256(in_range_avx2(lower, 'a', 'z'), in_range_avx2(x, '0', '9')),
+                                      _mm256_cmpeq_epi8(x, _mm256_set1_epi8('_')));
+        unsigned stop = ~static_cast<unsigned>(_mm256_movemask_epi8(hit));
+        if (stop) return p + first_bit(stop);
+    }
+    return skip_identifier_sse2(p, end);
+}
+
+SCAN_TARGET_AVX2 const char* skip_digits_avx2(const char* p, const char* end) {
+    for (; end - p >= 32; p += 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        unsigned stop = ~static_cast<unsigned>(_mm256_movemask_epi8(in_range_avx2(x, '0', '9')));
+        if (stop) return p + first_bit(stop);
+    }
+    return skip_digits_sse2(p, end);
+}
+
+SCAN_TARGET_AVX2 const char* find_newline_avx2(const char* p, const char* end) {
+    for (; end - p >= 32; p += 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        unsigned found = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('\n'))));
+        if (found) return p + first_bit(found);
+    }
+    return find_newline_sse2(p, end);
+}
+
+SCAN_TARGET_AVX2 const char* find_comment_end_avx2(const char* p, const char* end) {
+    for (; end - p >= 33; p += 32) {
+        __m256i star = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), _mm256_set1_epi8('*'));
+        __m256i slash = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 1)), _mm256_set1_epi8('/'));
+        unsigned found = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_and_si256(star, slash)));
+        if (found) return p + first_bit(found);
+    }
+    return find_comment_end_sse2(p, end);
+}
+
+bool cpu_has_avx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = info[2] & (1 << 27);
+    bool avx = info[2] & (1 << 28);
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;
+    __cpuidex(info, 7, 0);
+    return info[1] & (1 << 5);
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // SCAN_X86
+
+constexpr Kernels scalar_kernels = {
+    skip_whitespace_scalar, skip_identifier_scalar, skip_digits_scalar,
+    find_newline_scalar, find_comment_end_scalar,
+};
+
+#if defined(SCAN_X86)
+constexpr Kernels sse2_kernels = {
+    skip_whitespace_sse2, skip_identifier_sse2, skip_digits_sse2,
+    find_newline_sse2, find_comment_end_sse2,
+};
+
+constexpr Kernels avx2_kernels = {
+    skip_whitespace_avx2, skip_identifier_avx2, skip_digits_avx2,
+    find_newline_avx2, find_comment_end_avx2,
+};
+#endif
+
+Level detect_level() {
+#if defined(SCAN_X86)
+    return cpu_has_avx2() ? Level::AVX2 : Level::SSE2;  // SSE2 входит в базовый x86-64
+#else
+    return Level::Scalar;
+#endif
+}
+
+const Level detected_level = detect_level();
+Level current_level = detected_level;
+
+Kernels kernels_for(Level level) {
+    switch (level) {
+#if defined(SCAN_X86)
+        case Level::AVX2: return avx2_kernels;
+        case Level::SSE2: return sse2_kernels;
+#endif
+        default: return scalar_kernels;
+    }
+}
+
+} // namespace
+
+const std::array<std::uint8_t, 256> char_class = make_char_class();
+
+Kernels active_kernels = kernels_for(detected_level);
+
+Level active_level() { return current_level; }
+
+Level best_level() { return detected_level; }
+
+bool set_level(Level level) {
+    if (static_cast<int>(level) > static_cast<int>(detected_level)) return false;
+    current_level = level;
+    active_kernels = kernels_for(level);
+    return true;
+}
+
+const char* level_name(Level level) {
+    switch (level) {
+        case Level::Scalar: return "scalar";
+        case Level::SSE2: return "sse2";
+        case Level::AVX2: return "avx2";
+    }
+    return "unknown";
+}
+
+} // namespace scan
@@ -1,15 +1,180 @@
 #include "semantic_analyzer.hpp"
 #include "semantic_visitor.hpp"
-#include "symbol_table.hpp"
-#include "ast.hpp"
+#include <algorithm>
+#include <atomic>
+#include <future>
 #include <iostream>
+#include <mutex>
+#include <stdexcept>
 
-SemanticAnalyzer::SemanticAnalyzer() : symbolTable(std::make_shared<SymbolTable>()) {}
+namespace {
+
+// Этапы проверки одного объявления в порядке последовательного обхода
+enum class Stage { Declare, Body, Main };
+
+// Предупреждения и ошибка одного этапа одного объявления. Ошибка прерывает этап,
+// поэтому в последовательном обходе она идёт после его предупреждений
+struct Outcome {
+    std::size_t decl;
+    Stage stage;
+    std::vector<std::string> warnings;
+    std::string error;      // пусто - этап прошёл
+};
+
+// Тело функции для второй фазы и то, что было видно в глобальной области при её объявлении
+struct Body {
+    std::size_t decl;
+    FunctionDecl* function;
+    Scope::Mark visible;
+};
+
+// Тела, оставшиеся у одной задачи: [begin, end) в порядке исходника. Хозяйка берёт с начала,
+// задача без работы забирает у другой вторую половину
+struct BodyRange {
+    std::mutex mutex;
+    std::size_t begin = 0;
+    std::size_t end = 0;
+
+    bool pop(std::size_t& body) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (begin == end) return false;
+        body = begin++;
+        return true;
+    }
+    // Отдать вторую половину (не меньше одного тела); false - отдавать нечего
+    bool split(std::size_t& from, std::size_t& to) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (begin == end) return false;
+        from = begin + (end - begin) / 2;
+        to = end;
+        end = from;
+        return true;
+    }
+    void assign(std::size_t from, std::size_t to) {
+        std::lock_guard<std::mutex> lock(mutex);
+        begin = from;
+        end = to;
+    }
+};
+
+void print_warnings(const std::vector<std::string>& warnings) {
+    for (const auto& warning : warnings) std::cout << warning << '\n';
+    std::cout.flush();
+}
+
+} // namespace
 
 void SemanticAnalyzer::analyze(std::shared_ptr<TranslationUnitNode> root) {
-    ScopeVisitor scopeVisitor(symbolTable);
-    root->accept(scopeVisitor); // Create scopes and populate symbol table
+    SemanticVisitor semanticVisitor;
+    try {
+        root->accept(semanticVisitor); // Perform semantic checks
+    } catch (const std::exception&) {
+        print_warnings(semanticVisitor.take_warnings());
+        throw;
+    }
+    print_warnings(semanticVisitor.take_warnings());
+}
+
+void SemanticAnalyzer::analyze(std::shared_ptr<TranslationUnitNode> root, ThreadPool& pool) {
+    errors.clear();
+    std::vector<Outcome> outcomes;
+    std::vector<Body> bodies;
+
+    // Фаза 1: глобальная область. После первой ошибки последовательный обход дальше бы не пошёл
+    SemanticVisitor globals(root->arena);
+    bool has_main = false;
+    std::size_t index = 0;
+    for (; index < root->decls.size(); ++index) {
+        Decl* decl = root->decls[index];
+        std::string error;
+        try {
+            if (auto function = node_cast<FunctionDecl>(decl)) {
+                globals.declare_function(*function);
+                if (function->get_body()) bodies.push_back({index, function, globals.globals().mark()});
+                if (function->name == intern("main")) {
+                    has_main = true;
+                    try {
+                        SemanticVisitor::check_main(*function);
+                    } catch (const std::exception& e) {
+                        outcomes.push_back({index, Stage::Main, {}, e.what()});
+                    }
+                }
+            } else {
+                decl->accept(globals);
+            }
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        auto warnings = globals.take_warnings();
+        if (!warnings.empty() || !error.empty()) outcomes.push_back({index, Stage::Declare, std::move(warnings), error});
+        if (!error.empty()) break;
+    }
+    if (index == root->decls.size() && !has_main) {
+        outcomes.push_back({index, Stage::Declare, {}, "Function 'main' is not declared."});
+    }
+
+    // Фаза 2: тела функций. Каждая задача начинает со своего отрезка подряд идущих тел
+    // (соседние функции лежат в арене рядом), закончив - крадёт половину чужого
+    function_count = bodies.size();
+    std::size_t tasks = std::min(pool.size(), bodies.size());
+    std::vector<BodyRange> ranges(tasks);
+    for (std::size_t t = 0; t < tasks; ++t) ranges[t].assign(bodies.size() * t / tasks, bodies.size() * (t + 1) / tasks);
+    std::atomic<std::size_t> steals{0};
+    std::vector<std::unique_ptr<Arena>> arenas;
+    std::vector<std::future<void>> results;
+    std::mutex outcomes_mutex;
+    for (std::size_t t = 0; t < tasks; ++t) arenas.push_back(std::make_unique<Arena>());
+    auto task = [&](std::size_t t) {
+        Arena& arena = *arenas[t];
+        // Следующее тело: своё или украденное; false - работы не осталось ни у кого
+        auto next = [&](std::size_t& body) {
+            if (ranges[t].pop(body)) return true;
+            for (std::size_t k = 1; k < tasks; ++k) {
+                std::size_t from, to;
+                if (!ranges[(t + k) % tasks].split(from, to)) continue;
+                steals.fetch_add(1, std::memory_order_relaxed);
+                ranges[t].assign(from + 1, to);
+                body = from;
+                return true;
+            }
+            return false;
+        };
+        auto visitor = std::make_unique<SemanticVisitor>(arena, &globals.globals());
+        for (std::size_t b; next(b);) {
+            const Body& body = bodies[b];
+            std::string error;
+            try {
+                visitor->check_body(*body.function, body.visible);
+            } catch (const std::exception& e) {
+                error = e.what();
+            }
+            auto warnings = visitor->take_warnings();
+            if (!error.empty()) {
+                // области прерванной проверки остались открытыми
+                visitor = std::make_unique<SemanticVisitor>(arena, &globals.globals());
+            }
+            if (warnings.empty() && error.empty()) continue;
+            std::lock_guard<std::mutex> lock(outcomes_mutex);
+            outcomes.push_back({body.decl, Stage::Body, std::move(warnings), std::move(error)});
+        }
+    };
+    // Вызывающий поток не ждёт впустую: задачу 0 он выполняет сам
+    for (std::size_t t = 1; t < tasks; ++t) results.push_back(pool.submit([&task, t] { task(t); }));
+    if (tasks) task(0);
+    for (auto& result : results) result.get();
+    for (auto& arena : arenas) root->arena.absorb(*arena);
+    steal_count = steals;
 
-    SemanticVisitor semanticVisitor(symbolTable);
-    root->accept(semanticVisitor); // Perform semantic checks
+    // Порядок последовательного обхода: предупреждения до первой ошибки, затем она сама
+    std::sort(outcomes.begin(), outcomes.end(), [](const Outcome& a, const Outcome& b) {
+        return a.decl != b.decl ? a.decl < b.decl : a.stage < b.stage;
+    });
+    bool failed = false;
+    for (auto& outcome : outcomes) {
+        if (!failed) print_warnings(outcome.warnings);
+        if (outcome.error.empty()) continue;
+        failed = true;
+        errors.push_back({outcome.decl, std::move(outcome.error)});
+    }
+    if (!errors.empty()) throw std::runtime_error(errors.front().message);
 }
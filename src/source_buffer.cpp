@@ -0,0 +1,98 @@
+#include "source_buffer.hpp"
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SourceBuffer::~SourceBuffer() { release(); }
+
+SourceBuffer::SourceBuffer(SourceBuffer&& other) noexcept { *this = std::move(other); }
+
+SourceBuffer& SourceBuffer::operator=(SourceBuffer&& other) noexcept {
+    if (this == &other) return *this;
+    release();
+    mapped = other.mapped;
+    length = other.length;
+    storage = std::move(other.storage);
+    data = mapped ? other.data : storage.data();
+    other.data = "";
+    other.length = 0;
+    other.mapped = false;
+    return *this;
+}
+
+void SourceBuffer::release() {
+#if !defined(_WIN32)
+    if (mapped) munmap(const_cast<char*>(data), length);
+#endif
+    data = "";
+    length = 0;
+    mapped = false;
+    storage.clear();
+}
+
+#if defined(_WIN32)
+
+SourceBuffer SourceBuffer::open(const std::string& path) {
+    SourceBuffer buffer;
+    if (path == "-") {
+        buffer.storage.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+    } else {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) throw std::runtime_error("Couldn't open the file: " + path);
+        buffer.storage.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    buffer.data = buffer.storage.data();
+    buffer.length = buffer.storage.size();
+    return buffer;
+}
+
+#else
+
+SourceBuffer SourceBuffer::open(const std::string& path) {
+    int fd = path == "-" ? STDIN_FILENO : ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Couldn't open the file: " + path);
+
+    SourceBuffer buffer;
+    struct stat info {};
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void* addr = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            madvise(addr, static_cast<std::size_t>(info.st_size), MADV_SEQUENTIAL);
+            buffer.data = static_cast<const char*>(addr);
+            buffer.length = static_cast<std::size_t>(info.st_size);
+            buffer.mapped = true;
+            if (fd != STDIN_FILENO) ::close(fd);
+            return buffer;
+        }
+    }
+
+    // Канал, пустой файл или отказ mmap - читаем блоками
+    char chunk[1 << 16];
+    while (true) {
+        ssize_t n = ::read(fd, chunk, sizeof(chunk));
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) {
+            if (fd != STDIN_FILENO) ::close(fd);
+            throw std::runtime_error("Couldn't read the file: " + path);
+        }
+        if (n == 0) break;
+        buffer.storage.append(chunk, static_cast<std::size_t>(n));
+    }
+    if (fd != STDIN_FILENO) ::close(fd);
+    buffer.data = buffer.storage.data();
+    buffer.length = buffer.storage.size();
+    return buffer;
+}
+
+#endif
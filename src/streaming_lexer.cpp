@@ -0,0 +1,61 @@
+#include "streaming_lexer.hpp"
+#include "lexer.hpp"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+StreamingLexer::StreamingLexer(const std::string& path, std::size_t window_size)
+    : path(path), window_capacity(window_size ? window_size : 1) {}
+
+void StreamingLexer::run(const Sink& sink) {
+    std::ifstream file;
+    std::istream* in = &std::cin;
+    if (path != "-") {
+        file.open(path, std::ios::binary);
+        if (!file) throw std::runtime_error("Couldn't open the file: " + path);
+        in = &file;
+    }
+
+    // Буфер окна не инициализируется: страницы затрагиваются только прочитанными данными
+    std::unique_ptr<char[]> window(new char[window_capacity]);
+    std::size_t filled = 0;
+    std::size_t base = 0;
+    bool eof = false;
+    while (true) {
+        // Дочитываем окно: в начале лежит хвост предыдущего окна
+        if (!eof && filled < window_capacity) {
+            in->read(window.get() + filled, static_cast<std::streamsize>(window_capacity - filled));
+            std::size_t got = static_cast<std::size_t>(in->gcount());
+            filled += got;
+            total_bytes += got;
+            eof = in->eof();
+        }
+
+        Lexer lexer(std::string_view(window.get(), filled));
+        ++window_count;
+        if (eof) {
+            TokenBuffer tokens = lexer.tokenize();
+            total_tokens += tokens.size() - 1;     // без END
+            sink(tokens, base);
+            return;
+        }
+
+        std::size_t resume = 0;
+        TokenBuffer tokens = lexer.tokenize_prefix(resume);
+        if (resume == 0) {
+            // один токен длиннее окна - увеличиваем окно
+            std::unique_ptr<char[]> grown(new char[window_capacity * 2]);
+            std::memcpy(grown.get(), window.get(), filled);
+            window = std::move(grown);
+            window_capacity *= 2;
+            continue;
+        }
+        total_tokens += tokens.size();
+        sink(tokens, base);
+        std::memmove(window.get(), window.get() + resume, filled - resume);
+        filled -= resume;
+        base += resume;
+    }
+}
@@ -0,0 +1,60 @@
+#include "symbol.hpp"
+#include <mutex>
+#include <shared_mutex>
+
+namespace {
+
+struct GlobalTable {
+    Interner names;
+    std::shared_mutex mutex;
+};
+
+GlobalTable& global_table() {
+    static GlobalTable table;
+    return table;
+}
+
+} // namespace
+
+Symbol Interner::intern(std::string_view name) {
+    if (auto it = ids.find(name); it != ids.end()) return Symbol(it->second);
+    auto id = static_cast<std::uint32_t>(spellings.size());
+    const std::string& stored = spellings.emplace_back(name);
+    ids.emplace(stored, id);
+    return Symbol(id);
+}
+
+Symbol Interner::find(std::string_view name) const {
+    auto it = ids.find(name);
+    return it != ids.end() ? Symbol(it->second) : Symbol();
+}
+
+Symbol intern(std::string_view name) {
+    auto& table = global_table();
+    {
+        std::shared_lock<std::shared_mutex> lock(table.mutex);
+        if (auto symbol = table.names.find(name); symbol.valid()) return symbol;
+    }
+    std::unique_lock<std::shared_mutex> lock(table.mutex);
+    return table.names.intern(name);
+}
+
+std::size_t interned_count() {
+    auto& table = global_table();
+    std::shared_lock<std::shared_mutex> lock(table.mutex);
+    return table.names.size();
+}
+
+const std::string& Symbol::str() const {
+    static const std::string invalid = "<no symbol>";
+    if (!valid()) return invalid;
+    auto& table = global_table();
+    std::shared_lock<std::shared_mutex> lock(table.mutex);
+    return table.names.spelling(*this);
+}
+
+Symbol SymbolRemap::operator()(Symbol symbol) {
+    Symbol& mapped = global[symbol.id];
+    if (!mapped.valid()) mapped = intern(local.spelling(symbol));
+    return mapped;
+}
@@ -0,0 +1,87 @@
+#include "token_buffer.hpp"
+#include <algorithm>
+
+void TokenBuffer::reserve(std::size_t count) {
+    types.reserve(count);
+    offsets.reserve(count);
+    lengths.reserve(count);
+    payloads.reserve(count);
+}
+
+void TokenBuffer::push(TokenType type, std::size_t offset, std::size_t length) {
+    types.push_back(type);
+    offsets.push_back(offset);
+    lengths.push_back(static_cast<std::uint32_t>(length));
+    payloads.push_back(no_payload);
+}
+
+void TokenBuffer::push_decoded(TokenType type, std::size_t offset, std::size_t length, std::string value) {
+    push(type, offset, length);
+    payloads.back() = static_cast<std::uint32_t>(decoded.size());
+    decoded.push_back(std::move(value));
+}
+
+void TokenBuffer::push_number(TokenType type, std::size_t offset, std::size_t length, NumericValue value) {
+    push(type, offset, length);
+    payloads.back() = static_cast<std::uint32_t>(numbers.size());
+    numbers.push_back(value);
+}
+
+void TokenBuffer::push_symbol(std::size_t offset, std::size_t length, Symbol symbol) {
+    push(TokenType::ID, offset, length);
+    payloads.back() = symbol.id;
+}
+
+void TokenBuffer::remap_symbols(std::size_t from, SymbolRemap& remap) {
+    for (std::size_t i = from; i < size(); ++i) {
+        if (types[i] == TokenType::ID) payloads[i] = remap(Symbol(payloads[i])).id;
+    }
+}
+
+void TokenBuffer::truncate(std::size_t count) {
+    if (count >= size()) return;
+    std::size_t kept_decoded = decoded.size();
+    std::size_t kept_numbers = numbers.size();
+    for (std::size_t i = count; i < size(); ++i) {
+        if (payloads[i] == no_payload || types[i] == TokenType::ID) continue;
+        auto& kept = is_text_payload(types[i]) ? kept_decoded : kept_numbers;
+        kept = std::min<std::size_t>(kept, payloads[i]);
+    }
+    types.resize(count);
+    offsets.resize(count);
+    lengths.resize(count);
+    payloads.resize(count);
+    decoded.resize(kept_decoded);
+    numbers.resize(kept_numbers);
+}
+
+void TokenBuffer::append(const TokenBuffer& other, std::size_t from, std::size_t to, std::ptrdiff_t shift) {
+    to = std::min(to, other.size());
+    if (from >= to) return;
+    types.insert(types.end(), other.types.begin() + from, other.types.begin() + to);
+    if (shift == 0) {
+        offsets.insert(offsets.end(), other.offsets.begin() + from, other.offsets.begin() + to);
+    } else {
+        for (std::size_t i = from; i < to; ++i) offsets.push_back(other.offsets[i] + shift);
+    }
+    lengths.insert(lengths.end(), other.lengths.begin() + from, other.lengths.begin() + to);
+    for (std::size_t i = from; i < to; ++i) {
+        if (other.payloads[i] == no_payload || other.types[i] == TokenType::ID) {
+            payloads.push_back(other.payloads[i]);
+        } else if (is_text_payload(other.types[i])) {
+            payloads.push_back(static_cast<std::uint32_t>(decoded.size()));
+            decoded.push_back(other.decoded[other.payloads[i]]);
+        } else {
+            payloads.push_back(static_cast<std::uint32_t>(numbers.size()));
+            numbers.push_back(other.numbers[other.payloads[i]]);
+        }
+    }
+}
+
+bool TokenBuffer::operator==(const TokenBuffer& other) const {
+    if (types != other.types || offsets != other.offsets || lengths != other.lengths) return false;
+    for (std::size_t i = 0; i < size(); ++i) {
+        if (text(i) != other.text(i)) return false;
+    }
+    return true;
+}
@@ -0,0 +1,29 @@
+#include "token_cursor.hpp"
+#include "token_pipeline.hpp"
+#include <stdexcept>
+
+TokenCursor::TokenCursor(TokenPipeline& pipeline) : current(&current_batch), pipeline(&pipeline) {
+    if (!pipeline.next(current_batch)) throw std::runtime_error("Token pipeline is already drained");
+}
+
+TokenCursor::Slot TokenCursor::locate_ahead(std::size_t i) const {
+    if (!has_ahead && !fetch()) return {current, current->size() - 1};
+    if (i < ahead_batch.size()) return {&ahead_batch, i};
+    return {&ahead_batch, ahead_batch.size() - 1};
+}
+
+bool TokenCursor::fetch() const {
+    if (!pipeline) return false;
+    has_ahead = pipeline->next(ahead_batch);
+    return has_ahead;
+}
+
+void TokenCursor::step() {
+    if (!has_ahead && !fetch()) return;
+    // Перемещение буфера не трогает строки декодированных литералов: выданные Token остаются валидными
+    before_batch = std::move(current_batch);
+    current_batch = std::move(ahead_batch);
+    has_ahead = false;
+    has_before = true;
+    index = 0;
+}
@@ -0,0 +1,70 @@
+#include "token_pipeline.hpp"
+#include "lexer.hpp"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+// Ожидание соседнего потока: сначала уступаем квант, потом засыпаем, чтобы не занимать ядро
+void backoff(unsigned& attempt) {
+    if (++attempt < 64) std::this_thread::yield();
+    else std::this_thread::sleep_for(std::chrono::microseconds(20));
+}
+
+} // namespace
+
+TokenPipeline::TokenPipeline(std::string_view input, std::size_t batch_tokens, std::size_t depth)
+    : input(input), batch_tokens(std::max(batch_tokens, min_batch)), ring(std::max<std::size_t>(depth, 1)) {
+    producer = std::thread([this] { produce(); });
+}
+
+TokenPipeline::~TokenPipeline() {
+    stopping.store(true, std::memory_order_relaxed);
+    producer.join();
+}
+
+bool TokenPipeline::next(TokenBuffer& batch) {
+    if (finished) return false;
+    unsigned attempt = 0;
+    while (!ring.try_pop(batch)) {
+        if (attempt == 0) ++wait_count;
+        backoff(attempt);
+    }
+    if (batch.empty()) {
+        // пустая пачка - маркер ошибки лексера
+        finished = true;
+        std::rethrow_exception(error);
+    }
+    finished = batch.type(batch.size() - 1) == TokenType::END;
+    ++batch_count;
+    token_count += batch.size();
+    return true;
+}
+
+bool TokenPipeline::publish(TokenBuffer& batch) {
+    unsigned attempt = 0;
+    while (!ring.try_push(batch)) {
+        if (stopping.load(std::memory_order_relaxed)) return false;
+        backoff(attempt);
+    }
+    return true;
+}
+
+void TokenPipeline::produce() {
+    TokenBuffer batch(input);
+    try {
+        Lexer lexer(input);
+        while (true) {
+            batch.reserve(batch_tokens + 1);
+            while (batch.size() < batch_tokens && lexer.skip_trivia()) lexer.next(batch);
+            bool last = batch.size() < batch_tokens;
+            if (last) batch.push(TokenType::END, input.size(), 0);
+            if (!publish(batch) || last) return;
+            batch = TokenBuffer(input);
+        }
+    } catch (...) {
+        error = std::current_exception();
+        batch = TokenBuffer(input);
+        publish(batch);
+    }
+}
@@ -1,60 +1,204 @@
 #include "types.hpp"
-#include <iostream>
 #include <memory>
+#include <mutex>
 #include <string>
 
+namespace {
 
-std::shared_ptr<Type> make_type(const std::string& type_name, bool is_const){
-    if (type_name == "short") return std::make_shared<ShortIntType>(is_const);
-    if (type_name == "int") return std::make_shared<IntType>(is_const);
-    if (type_name == "long") return std::make_shared<LongIntType>(is_const);
-    if (type_name == "char") return std::make_shared<CharType>(is_const);
-    if (type_name == "bool") return std::make_shared<BoolType>(is_const);
-    if (type_name == "double") return std::make_shared<DoubleType>(is_const);
-    if (type_name == "ldouble") return std::make_shared<LongDoubleType>(is_const);
-    if (type_name == "float") return std::make_shared<FloatType>(is_const);
-    if (type_name == "void") return std::make_shared<VoidType>();
-    return std::make_shared<StructType>(type_name, is_const);
+constexpr std::size_t rank_count = 8;
+
+constexpr const char* rank_names[rank_count] = {"bool", "char", "short", "int", "long", "float", "double", "ldouble"};
+
+constexpr bool integral(std::size_t rank) { return rank <= static_cast<std::size_t>(TypeRank::Long); }
+
+// Класс типа в таблицах: void, арифметические по рангу, массив, структура
+constexpr std::size_t void_class = 0;
+constexpr std::size_t array_class = 1 + rank_count;
+constexpr std::size_t struct_class = array_class + 1;
+constexpr std::size_t class_count = struct_class + 1;
+
+std::size_t type_class(const Type& type) {
+    switch (type.kind()) {
+        case TypeKind::Void: return void_class;
+        case TypeKind::Arithmetic: return 1 + static_cast<std::size_t>(type.rank());
+        case TypeKind::Array: return array_class;
+        case TypeKind::Struct: return struct_class;
+    }
+    return void_class;
+}
+
+// [из][в]. Для структур Identity означает "сравнить сами типы", для массивов Elements - "сравнить элементы"
+constexpr auto make_conversions() {
+    std::array<std::array<Conversion, class_count>, class_count> table{};
+    table[void_class][void_class] = Conversion::Identity;
+    for (std::size_t from = 0; from < rank_count; ++from) {
+        for (std::size_t to = 0; to < rank_count; ++to) {
+            Conversion conversion = Conversion::Arithmetic;
+            if (from == to) conversion = Conversion::Identity;
+            else if (from < to && integral(from) == integral(to)) conversion = Conversion::Promotion;
+            table[1 + from][1 + to] = conversion;
+        }
+    }
+    table[array_class][array_class] = Conversion::Elements;
+    table[struct_class][struct_class] = Conversion::Identity;
+    return table;
 }
 
-std::shared_ptr<Type> make_type_arr(const std::string& type_name, bool is_const){
-    return std::make_shared<ArrayType>(make_type(type_name, is_const));
+// Обычные арифметические преобразования: [ранг][ранг] -> ранг результата
+constexpr auto make_common_ranks() {
+    std::array<std::array<TypeRank, rank_count>, rank_count> table{};
+    constexpr std::size_t int_rank = static_cast<std::size_t>(TypeRank::Int);
+    for (std::size_t a = 0; a < rank_count; ++a) {
+        for (std::size_t b = 0; b < rank_count; ++b) {
+            std::size_t promoted_a = a < int_rank ? int_rank : a;
+            std::size_t promoted_b = b < int_rank ? int_rank : b;
+            table[a][b] = static_cast<TypeRank>(promoted_a > promoted_b ? promoted_a : promoted_b);
+        }
+    }
+    return table;
 }
 
-std::shared_ptr<Type> make_type_struct(const std::string& type_name, const std::vector<std::pair<std::pair<Modifiers, TypePtr>, std::string>>& members){
-    return std::make_shared<StructType>(type_name, members);
+constexpr auto conversions = make_conversions();
+constexpr auto common_ranks = make_common_ranks();
+
+} // namespace
+
+TypeContext::TypeContext() : _void(std::make_shared<VoidType>()), ids(1) {
+    number(_void);
+    for (std::size_t rank = 0; rank < rank_count; ++rank) {
+        auto plain = std::make_shared<ArithmeticType>(static_cast<TypeRank>(rank), false);
+        auto constant = std::make_shared<ArithmeticType>(static_cast<TypeRank>(rank), true);
+        constant->_unqualified = plain.get();
+        number(plain);
+        number(constant);
+        _arithmetic[0][rank] = plain;
+        _arithmetic[1][rank] = constant;
+    }
 }
 
-bool VoidType::is_compatible_with(const TypePtr other) const {
-    return std::dynamic_pointer_cast<VoidType>(other) != nullptr;
+// Вызывается при создании типа: в конструкторе или под исключительной блокировкой
+void TypeContext::number(const TypePtr& type) {
+    type->_id = static_cast<TypeId>(ids.size());
+    ids.push_back(type);
 }
-bool ArithmeticType::is_compatible_with(const TypePtr other) const {
-    return std::dynamic_pointer_cast<ArithmeticType>(other) != nullptr;
+
+const TypePtr& TypeContext::type(TypeId id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return ids[id];
 }
 
-bool StructType::is_compatible_with(const TypePtr other) const {
-    auto other_ptr = std::dynamic_pointer_cast<StructType>(other);
-    if (other_ptr) {
-        return this->name == other_ptr->name;
+TypePtr TypeContext::fundamental(std::string_view name, bool is_const) const {
+    if (name == "void") return _void;
+    for (std::size_t rank = 0; rank < rank_count; ++rank) {
+        if (name == rank_names[rank]) return _arithmetic[is_const][rank];
     }
-    return false;
+    return nullptr;
 }
 
-bool ArrayType::is_compatible_with(const TypePtr other) const {
-    auto other_ptr = std::dynamic_pointer_cast<ArrayType>(other);
-    if(other_ptr != nullptr){
-        return this->element_type->is_compatible_with(other_ptr->element_type);
+TypePtr TypeContext::named(std::string_view name, bool is_const) {
+    if (auto type = fundamental(name, is_const)) return type;
+    return struct_type(intern(name), is_const);
+}
+
+// Пара вариантов типа по ключу; создаётся под исключительной блокировкой, если её ещё нет
+template <typename T, typename Key, typename... Args>
+TypePtr TypeContext::canonical(std::unordered_map<Key, std::array<TypePtr, 2>>& table, const Key& key, bool is_const,
+                              Args&&... args) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        if (auto it = table.find(key); it != table.end()) return it->second[is_const];
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    auto [it, added] = table.try_emplace(key);
+    if (added) {
+        auto plain = std::make_shared<T>(args..., false);
+        auto constant = std::make_shared<T>(args..., true);
+        constant->_unqualified = plain.get();
+        number(plain);
+        number(constant);
+        it->second = {plain, constant};
     }
+    return it->second[is_const];
 }
 
+TypePtr TypeContext::array_of(const TypePtr& element, bool is_const) {
+    return canonical<ArrayType>(arrays, static_cast<const Type*>(element.get()), is_const, element);
+}
+
+TypePtr TypeContext::struct_type(Symbol name, bool is_const) {
+    return canonical<StructType>(structs, name, is_const, name);
+}
 
-std::optional<std::pair<std::pair<Modifiers, TypePtr>, std::string>> StructType::lookup_member(const std::string& member_name) const {
-    for (const auto& member : members) {
+TypePtr TypeContext::define_struct(Symbol name, std::vector<StructType::Member> members) {
+    TypePtr type = struct_type(name);
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    static_cast<StructType&>(*type).fields = std::move(members);
+    return type;
+}
+
+TypePtr TypeContext::qualified(const TypePtr& type, bool is_const) {
+    if (!type || type->is_const() == is_const) return type;
+    switch (type->kind()) {
+        case TypeKind::Void: return _void;
+        case TypeKind::Arithmetic: return arithmetic(type->rank(), is_const);
+        case TypeKind::Array: return array_of(static_cast<const ArrayType&>(*type).element_type, is_const);
+        case TypeKind::Struct: return struct_type(static_cast<const StructType&>(*type).name, is_const);
+    }
+    return type;
+}
+
+Conversion TypeContext::conversion(const Type& from, const Type& to) {
+    Conversion result = conversions[type_class(from)][type_class(to)];
+    if (result == Conversion::Elements) {
+        const auto& from_element = *static_cast<const ArrayType&>(from).element_type;
+        const auto& to_element = *static_cast<const ArrayType&>(to).element_type;
+        if (from_element.unqualified() == to_element.unqualified()) return Conversion::Identity;
+        return conversion(from_element, to_element) != Conversion::None ? Conversion::Elements : Conversion::None;
+    }
+    if (result == Conversion::Identity && from.is_struct() && from.unqualified() != to.unqualified()) return Conversion::None;
+    return result;
+}
+
+TypePtr TypeContext::common_type(const Type& a, const Type& b) const {
+    if (!a.is_arithmetic() || !b.is_arithmetic()) return nullptr;
+    return arithmetic(common_ranks[static_cast<std::size_t>(a.rank())][static_cast<std::size_t>(b.rank())]);
+}
+
+std::size_t TypeContext::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return ids.size() - 1;
+}
+
+TypeContext& type_context() {
+    static TypeContext context;
+    return context;
+}
+
+std::shared_ptr<Type> make_type(std::string_view type_name, bool is_const){
+    return type_context().named(type_name, is_const);
+}
+
+std::shared_ptr<Type> make_type_arr(std::string_view type_name, bool is_const){
+    return type_context().array_of(make_type(type_name, is_const), is_const);
+}
+
+std::shared_ptr<Type> make_type_struct(const std::string& type_name, std::vector<StructType::Member> members){
+    return type_context().define_struct(intern(type_name), std::move(members));
+}
+
+bool Type::is_compatible_with(const TypePtr& other) const {
+    return other && TypeContext::compatible(*this, *other);
+}
+
+std::string ArithmeticType::get_name() const {
+    return rank_names[static_cast<std::size_t>(rank())];
+}
+
+std::optional<StructType::Member> StructType::lookup_member(Symbol member_name) const {
+    for (const auto& member : members()) {
         if (member.second == member_name) {
             return member; // Возвращаем тип члена
         }
     }
     return std::nullopt; // Член не найден
 }
-
-
@@ -2,73 +2,91 @@
 #include <iostream>
 #include <memory>
 
-void PrintVisitor::visit(LiteralExpr& expr)  { 
+namespace {
+
+void print_literal(const LiteralExpr::Value& value) {
     std::cout << "Literal(";
-    if(std::holds_alternative<int>(expr.value)) {
-        std::cout << std::get<int>(expr.value) << ")";
-    } else if (std::holds_alternative<double>(expr.value)) {
-        std::cout << std::get<double>(expr.value) << ")";
-    } else if (std::holds_alternative<bool>(expr.value)) {
-        std::cout << (std::get<bool>(expr.value) ? "true" : "false") << ")";
-    } else if (std::holds_alternative<char>(expr.value)) {
-        std::cout << "'" << std::get<char>(expr.value) << "')";
-    } else if (std::holds_alternative<std::string>(expr.value)) {
-        std::cout << "\"" << std::get<std::string>(expr.value) << "\")";
+    if(std::holds_alternative<int>(value)) {
+        std::cout << std::get<int>(value) << ")";
+    } else if (std::holds_alternative<double>(value)) {
+        std::cout << std::get<double>(value) << ")";
+    } else if (std::holds_alternative<long>(value)) {
+        std::cout << std::get<long>(value) << "l)";
+    } else if (std::holds_alternative<unsigned>(value)) {
+        std::cout << std::get<unsigned>(value) << "u)";
+    } else if (std::holds_alternative<unsigned long>(value)) {
+        std::cout << std::get<unsigned long>(value) << "ul)";
+    } else if (std::holds_alternative<float>(value)) {
+        std::cout << std::get<float>(value) << "f)";
+    } else if (std::holds_alternative<long double>(value)) {
+        std::cout << std::get<long double>(value) << "l)";
+    } else if (std::holds_alternative<bool>(value)) {
+        std::cout << (std::get<bool>(value) ? "true" : "false") << ")";
+    } else if (std::holds_alternative<char>(value)) {
+        std::cout << "'" << std::get<char>(value) << "')";
+    } else if (std::holds_alternative<std::string>(value)) {
+        std::cout << "\"" << std::get<std::string>(value) << "\")";
     } else {
         std::cout << "Unknown type)";
     }
 }
 
+} // namespace
+
+void PrintVisitor::visit(LiteralExpr& expr)  { 
+    print_literal(expr.value());
+}
+
 void PrintVisitor::visit(IdExpr& expr)  { 
-    std::cout << "ID(" << expr.name << ")";
+    std::cout << "ID(" << expr.name.str() << ")";
 }
 
 void PrintVisitor::visit(BinaryExpr& expr)  { 
     std::cout << "Binary(" << expr.op << ", ";
-    expr.left.get()->accept(*this); 
+    expr.left->accept(*this); 
     std::cout << ", ";
-    expr.right.get()->accept(*this); 
+    expr.right->accept(*this); 
     std::cout << ")";
 }
 
 void PrintVisitor::visit(UnaryExpr& expr)  { 
     std::cout << "Unary(" << expr.op << ", ";
-    expr.operand.get()->accept(*this); 
+    expr.operand->accept(*this); 
     std::cout << ")";
 }
 
 void PrintVisitor::visit(SizeofExpr& expr)  { 
     std::cout << "Sizeof(";
     if(expr.operand) {
-        expr.operand.get()->accept(*this); 
+        expr.operand->accept(*this); 
         std::cout << ")";
     } else {
         if(auto type = std::get_if<TypePtr>(&expr.type)) {
             std::cout << (*type)->get_name() << ")";
         } else if (auto expr_ptr = std::get_if<ExprPtr>(&expr.type)) {
-            (*expr_ptr).get()->accept(*this);
+            (*expr_ptr)->accept(*this);
         }
     }
 }
 
 void PrintVisitor::visit(TernaryExpr& expr)  { 
     std::cout << "Ternary(";
-    expr.cond.get()->accept(*this); 
+    expr.cond->accept(*this); 
     std::cout << " ? ";
-    expr.true_expr.get()->accept(*this); 
+    expr.true_expr->accept(*this); 
     std::cout << " : ";
-    expr.false_expr.get()->accept(*this); 
+    expr.false_expr->accept(*this); 
     std::cout << ")";
 }
 
 void PrintVisitor::visit(CallExpr& expr)  { 
-    if (auto callee = dynamic_cast<IdExpr*>(expr.callee.get())) {
-        std::cout << "Call(" << callee->name << ", [";
+    if (auto callee = node_cast<IdExpr>(expr.callee)) {
+        std::cout << "Call(" << callee->name.str() << ", [";
     } else {
         std::cout << "Call(" << "!null" << ", [";
     }
     for (auto& arg : expr.args) {
-        arg.get()->accept(*this);
+        arg->accept(*this);
         if (&arg != &expr.args.back()) std::cout << ", ";
     }
     std::cout << "])";
@@ -76,50 +94,50 @@ void PrintVisitor::visit(CallExpr& expr)  {
 
 void PrintVisitor::visit(MemberAccessExpr& expr)  { 
     std::cout << "Access(";
-    expr.object.get()->accept(*this); 
+    expr.object->accept(*this); 
     std::cout << "." << expr.member << ")";
 }
 
 void PrintVisitor::visit(ArrayAccessExpr& expr)  { 
     std::cout << "Array(";
-    expr.array.get()->accept(*this); 
+    expr.array->accept(*this); 
     std::cout << "[";
-    expr.index.get()->accept(*this); 
+    expr.index->accept(*this); 
     std::cout << "])";
 }
 
 void PrintVisitor::visit(LogicalExpr& expr)  { 
     std::cout << "Logical(" << expr.op << ", ";
-    expr.left.get()->accept(*this); 
+    expr.left->accept(*this); 
     std::cout << ", ";
-    expr.right.get()->accept(*this); 
+    expr.right->accept(*this); 
     std::cout << ")";
 }
 
 void PrintVisitor::visit(PostfixExpr& expr)  { 
     std::cout << "Postfix(";
-    expr.operand.get()->accept(*this); 
+    expr.operand->accept(*this); 
     std::cout << expr.op << ")";
 }
 
 void PrintVisitor::visit(AssignExpr& expr)  { 
     std::cout << "Assign(";
-    expr.left.get()->accept(*this); 
+    expr.left->accept(*this); 
     std::cout << " = ";
-    expr.right.get()->accept(*this); 
+    expr.right->accept(*this); 
     std::cout << ")";
 }
 
 void PrintVisitor::visit(ExprStmt& stmt)  { 
     std::cout << "Expr(";
-    stmt.expr.get()->accept(*this); 
+    stmt.expr->accept(*this); 
     std::cout << ")";
 }
 
 void PrintVisitor::visit(BlockStmt& stmt)  { 
     std::cout << "Block([";
     for (auto& statement : stmt.statements) {
-        statement.get()->accept(*this);
+        statement->accept(*this);
         if (&statement != &stmt.statements.back()) std::cout << ", ";
     }
     std::cout << "])";
@@ -127,39 +145,39 @@ void PrintVisitor::visit(BlockStmt& stmt)  {
 
 void PrintVisitor::visit(IfStmt& stmt)  { 
     std::cout << "If(";
-    stmt.condition.get()->accept(*this); 
+    stmt.condition->accept(*this); 
     std::cout << ", ";
-    stmt.then_branch.get()->accept(*this); 
+    stmt.then_branch->accept(*this); 
     if (stmt.else_branch) {
         std::cout << " else ";
-        stmt.else_branch.get()->accept(*this); 
+        stmt.else_branch->accept(*this); 
     }
     std::cout << ")";
 }
 
 void PrintVisitor::visit(WhileStmt& stmt)  { 
     std::cout << "While(";
-    stmt.condition.get()->accept(*this); 
+    stmt.condition->accept(*this); 
     std::cout << ", ";
-    stmt.body.get()->accept(*this); 
+    stmt.body->accept(*this); 
     std::cout << ")";
 }
 
 void PrintVisitor::visit(ForStmt& stmt)  { 
     std::cout << "For(";
-    stmt.init.get()->accept(*this); 
+    stmt.init->accept(*this); 
     std::cout << "; ";
-    stmt.condition.get()->accept(*this); 
+    stmt.condition->accept(*this); 
     std::cout << "; ";
-    stmt.increment.get()->accept(*this); 
+    stmt.increment->accept(*this); 
     std::cout << ", ";
-    stmt.body.get()->accept(*this); 
+    stmt.body->accept(*this); 
     std::cout << ")";
 }
 
 void PrintVisitor::visit(ReturnStmt& stmt)  { 
     std::cout << "Return(";
-    if (stmt.expr) stmt.expr.get()->accept(*this); 
+    if (stmt.expr) stmt.expr->accept(*this); 
     std::cout << ")";
 }
 
@@ -175,7 +193,7 @@ void PrintVisitor::visit(PrintStmt& stmt)  {
     std::cout << "Print(";
     for(auto& expr : stmt.expr) {
         std::cout << ", ";
-        expr.get()->accept(*this);
+        expr->accept(*this);
     }
     std::cout << ")";
 }
@@ -186,7 +204,7 @@ void PrintVisitor::visit(ReadStmt& stmt)  {
 
 void PrintVisitor::visit(ExitStmt& stmt)  { 
     std::cout << "Exit(";
-    if (stmt.expr) stmt.expr.get()->accept(*this); 
+    if (stmt.expr) stmt.expr->accept(*this); 
     std::cout << ")";
 }
 
@@ -195,7 +213,7 @@ void PrintVisitor::visit(VarDecl& decl) {
     std::cout << decl.modifiers.get_str();
     std::cout << decl.type->get_name() << ", [";
     for (const auto& variable : decl.variables) {
-        std::cout << variable.name;
+        std::cout << variable.name.str();
         if (variable.size) {
             std::cout << "[";
             variable.size->accept(*this);
@@ -211,7 +229,7 @@ void PrintVisitor::visit(VarDecl& decl) {
 }
 
 void PrintVisitor::visit(StructDecl& decl)  { 
-    std::cout << "Struct(" << decl.name << ", [";
+    std::cout << "Struct(" << decl.name.str() << ", [";
     for (auto& field : decl.fields) {
         visit(field);
         if (&field != &decl.fields.back()) std::cout << ", ";
@@ -221,20 +239,20 @@ void PrintVisitor::visit(StructDecl& decl)  {
 
 void PrintVisitor::visit(FunctionDecl& decl)  { 
     std::cout << "Func(";
-    std::cout << decl.return_mods.get_str() << decl.return_type->get_name() << " " << decl.name << ", [";
+    std::cout << decl.return_mods.get_str() << decl.return_type->get_name() << " " << decl.name.str() << ", [";
     for (auto& param : decl.params) {
-        std::cout << param.first.first.get_str() << param.first.second->get_name() << " " << param.second; // модификаторы, тип и имя параметра
+        std::cout << param.first.first.get_str() << param.first.second->get_name() << " " << param.second.str(); // модификаторы, тип и имя параметра
         if (&param != &decl.params.back()) std::cout << ", ";
     }
     std::cout << "], ";
-    decl.body.get()->accept(*this);
+    decl.get_body()->accept(*this);
     std::cout << ")";
 }
 
 void PrintVisitor::visit(TranslationUnitNode& node)  {
     std::cout << "Program([" << std::endl;
     for (auto& decl : node.decls) {
-        decl.get()->accept(*this);
+        decl->accept(*this);
         std::cout << std::endl;
     }
     std::cout << "])" << std::endl;
@@ -249,6 +267,12 @@ void PrintVisitor::visit(ArrayInitExpr& expr) {
     std::cout << "])";
 }
 
+void PrintVisitor::visit(CastExpr& expr) {
+    std::cout << "Cast(" << expr.type->get_name() << ", ";
+    expr.operand->accept(*this);
+    std::cout << ")";
+}
+
 void PrintVisitor::visit(AssertDecl& decl) {
     std::cout << "Assert(";
     decl.expr->accept(*this);
@@ -259,7 +283,216 @@ void PrintVisitor::visit(AssertDecl& decl) {
 }
 
 void PrintVisitor::visit(TypedefDecl& decl) {
-    std::cout << "Typedef(" << decl.original_type << " as " << decl.alias_name << ")";
+    std::cout << "Typedef(" << decl.original_type << " as " << decl.alias_name.str() << ")";
+}
+
+// Плоская форма: тот же вывод, что у дерева указателей. Пустые рёбра (None) не печатаются;
+// поле структуры, имя в read() и тип typedef печатаются по имени, а не адресом узла
+void PrintVisitor::visit(FlatNode node) {
+    switch (node.kind()) {
+        case NodeKind::None: break;
+        case NodeKind::Literal: print_literal(node.literal()); break;
+        case NodeKind::Id: std::cout << "ID(" << node.symbol().str() << ")"; break;
+        case NodeKind::Binary:
+        case NodeKind::Logical:
+            std::cout << (node.kind() == NodeKind::Binary ? "Binary(" : "Logical(") << node.op() << ", ";
+            visit_children(node, ", ");
+            std::cout << ")";
+            break;
+        case NodeKind::Assign:
+            std::cout << "Assign(";
+            visit_children(node, " = ");
+            std::cout << ")";
+            break;
+        case NodeKind::Unary:
+            std::cout << "Unary(" << node.op() << ", ";
+            visit(node.child(0));
+            std::cout << ")";
+            break;
+        case NodeKind::Postfix:
+            std::cout << "Postfix(";
+            visit(node.child(0));
+            std::cout << node.op() << ")";
+            break;
+        case NodeKind::Sizeof:
+            std::cout << "Sizeof(";
+            if (!node.child(0).empty()) {
+                visit(node.child(0));
+                std::cout << ")";
+            } else if (node.has_type()) {
+                if (node.type()) std::cout << node.type()->get_name();
+                std::cout << ")";
+            } else {
+                visit(node.child(1));
+            }
+            break;
+        case NodeKind::Ternary:
+            std::cout << "Ternary(";
+            visit(node.child(0));
+            std::cout << " ? ";
+            visit(node.child(1));
+            std::cout << " : ";
+            visit(node.child(2));
+            std::cout << ")";
+            break;
+        case NodeKind::Call: {
+            FlatNode callee = node.child(0);
+            std::cout << "Call(" << (callee.kind() == NodeKind::Id ? callee.symbol().str() : "!null") << ", [";
+            for (FlatNode arg : node.children()) {
+                if (arg.index() == callee.index()) continue;
+                visit(arg);
+                if (!node.is_last(arg)) std::cout << ", ";
+            }
+            std::cout << "])";
+            break;
+        }
+        case NodeKind::MemberAccess:
+            std::cout << "Access(";
+            visit(node.child(0));
+            std::cout << "." << node.child(1).symbol().str() << ")";
+            break;
+        case NodeKind::ArrayAccess:
+            std::cout << "Array(";
+            visit(node.child(0));
+            std::cout << "[";
+            visit(node.child(1));
+            std::cout << "])";
+            break;
+        case NodeKind::ArrayInit:
+            std::cout << "ArrayInit([";
+            visit_children(node, ", ");
+            std::cout << "])";
+            break;
+        case NodeKind::Cast:
+            std::cout << "Cast(" << node.type()->get_name() << ", ";
+            visit(node.child(0));
+            std::cout << ")";
+            break;
+
+        case NodeKind::ExprStmt:
+            std::cout << "Expr(";
+            visit(node.child(0));
+            std::cout << ")";
+            break;
+        case NodeKind::Block:
+            std::cout << "Block([";
+            visit_children(node, ", ");
+            std::cout << "])";
+            break;
+        case NodeKind::If:
+            std::cout << "If(";
+            visit(node.child(0));
+            std::cout << ", ";
+            visit(node.child(1));
+            if (!node.child(2).empty()) {
+                std::cout << " else ";
+                visit(node.child(2));
+            }
+            std::cout << ")";
+            break;
+        case NodeKind::While:
+            std::cout << "While(";
+            visit_children(node, ", ");
+            std::cout << ")";
+            break;
+        case NodeKind::For:
+            std::cout << "For(";
+            visit(node.child(0));
+            std::cout << "; ";
+            visit(node.child(1));
+            std::cout << "; ";
+            visit(node.child(2));
+            std::cout << ", ";
+            visit(node.child(3));
+            std::cout << ")";
+            break;
+        case NodeKind::Return:
+        case NodeKind::Exit:
+            std::cout << (node.kind() == NodeKind::Return ? "Return(" : "Exit(");
+            visit(node.child(0));
+            std::cout << ")";
+            break;
+        case NodeKind::Break: std::cout << "Break"; break;
+        case NodeKind::Continue: std::cout << "Continue"; break;
+        case NodeKind::Print:
+            std::cout << "Print(";
+            for (FlatNode expr : node.children()) {
+                std::cout << ", ";
+                visit(expr);
+            }
+            std::cout << ")";
+            break;
+        case NodeKind::Read:
+            std::cout << "Read(";
+            visit(node.child(0));
+            std::cout << ")";
+            break;
+
+        case NodeKind::VarDecl: {
+            const auto& info = node.var_type();
+            std::cout << "VarDecl(" << info.modifiers.get_str() << info.type->get_name() << ", [";
+            for (FlatNode variable : node.children()) {
+                std::cout << variable.symbol().str();
+                if (FlatNode size = variable.child(1); !size.empty()) {
+                    std::cout << "[";
+                    visit(size);
+                    std::cout << "]";
+                }
+                if (FlatNode init = variable.child(0); !init.empty()) {
+                    std::cout << " = ";
+                    visit(init);
+                }
+                if (!node.is_last(variable)) std::cout << ", ";
+            }
+            std::cout << "])";
+            break;
+        }
+        case NodeKind::StructDecl:
+            std::cout << "Struct(" << node.symbol().str() << ", [";
+            visit_children(node, ", ");
+            std::cout << "])";
+            break;
+        case NodeKind::FunctionDecl: {
+            const auto& info = node.function();
+            std::cout << "Func(" << info.return_mods.get_str() << info.return_type->get_name() << " " << info.name.str()
+                      << ", [";
+            for (auto& param : info.params) {
+                std::cout << param.first.first.get_str() << param.first.second->get_name() << " " << param.second.str();
+                if (&param != &info.params.back()) std::cout << ", ";
+            }
+            std::cout << "], ";
+            visit(node.child(0));
+            std::cout << ")";
+            break;
+        }
+        case NodeKind::AssertDecl:
+            std::cout << "Assert(";
+            visit(node.child(0));
+            if (!node.message().empty()) std::cout << ", \"" << node.message() << "\"";
+            std::cout << ")";
+            break;
+        case NodeKind::TypedefDecl: {
+            const auto& info = node.typedef_info();
+            std::cout << "Typedef(" << (info.type ? info.type->get_name() : "") << " as " << info.alias.str() << ")";
+            break;
+        }
+        case NodeKind::TranslationUnit:
+            std::cout << "Program([" << std::endl;
+            for (FlatNode decl : node.children()) {
+                visit(decl);
+                std::cout << std::endl;
+            }
+            std::cout << "])" << std::endl;
+            break;
+        default: break;
+    }
+}
+
+void PrintVisitor::visit_children(FlatNode node, const char* separator) {
+    for (FlatNode child : node.children()) {
+        visit(child);
+        if (!node.is_last(child)) std::cout << separator;
+    }
 }
 
 #include "ast.hpp"
@@ -294,5 +527,6 @@ void StructDecl::accept(ASTVisitor& visitor) { visitor.visit(*this); }
 void FunctionDecl::accept(ASTVisitor& visitor) { visitor.visit(*this); }
 void TranslationUnitNode::accept(ASTVisitor& visitor) { visitor.visit(*this); }
 void ArrayInitExpr::accept(ASTVisitor& visitor) { visitor.visit(*this); }
+void CastExpr::accept(ASTVisitor& visitor) { visitor.visit(*this); }
 void TypedefDecl::accept(ASTVisitor& visitor) { visitor.visit(*this); }
 
@@ -13,6 +13,7 @@ void ASTVisitor::visit(LogicalExpr& expr){}
 void ASTVisitor::visit(PostfixExpr& expr){}
 void ASTVisitor::visit(AssignExpr& expr){}
 void ASTVisitor::visit(ArrayInitExpr& expr){}
+void ASTVisitor::visit(CastExpr& expr){}
 
 void ASTVisitor::visit(ExprStmt& stmt){}
 void ASTVisitor::visit(BlockStmt& stmt){}